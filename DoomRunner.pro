@@ -41,38 +41,59 @@ INCLUDEPATH += Sources
 HEADERS += \
 	Sources/Dialogs/AboutDialog.hpp \
 	Sources/Dialogs/CompatOptsDialog.hpp \
+	Sources/Dialogs/DemoBenchmarkDialog.hpp \
+	Sources/Dialogs/DiagnosticsDialog.hpp \
 	Sources/Dialogs/DialogCommon.hpp \
 	Sources/Dialogs/EngineDialog.hpp \
 	Sources/Dialogs/GameOptsDialog.hpp \
+	Sources/Dialogs/GuiStallsDialog.hpp \
 	Sources/Dialogs/NewConfigDialog.hpp \
 	Sources/Dialogs/OptionsStorageDialog.hpp \
 	Sources/Dialogs/OwnFileDialog.hpp \
 	Sources/Dialogs/ProcessOutputWindow.hpp \
 	Sources/Dialogs/SetupDialog.hpp \
+	Sources/Dialogs/StartupProfileDialog.hpp \
 	Sources/DoomFiles.hpp \
+	Sources/Utils/ConsoleOutputDecoder.hpp \
 	Sources/Utils/ContainerUtils.hpp \
 	Sources/Utils/ErrorHandling.hpp \
 	Sources/Utils/EventFilters.hpp \
+	Sources/Utils/ExeProber.hpp \
 	Sources/Utils/ExeReader.hpp \
 	Sources/Utils/FileInfoCache.hpp \
 	Sources/Utils/FileSystemUtils.hpp \
+	Sources/Utils/JsonSchema.hpp \
 	Sources/Utils/JsonUtils.hpp \
 	Sources/Utils/LangUtils.hpp \
+	Sources/Utils/LogFileWriter.hpp \
+	Sources/Utils/Metrics.hpp \
 	Sources/Utils/MiscUtils.hpp \
 	Sources/Utils/OSUtils.hpp \
+	Sources/Utils/PathChecker.hpp \
+	Sources/Utils/ProcessMonitor.hpp \
+	Sources/Utils/SearchIndex.hpp \
+	Sources/Utils/StallWatchdog.hpp \
+	Sources/Utils/StageProfiler.hpp \
 	Sources/Utils/StandardOutput.hpp \
-	Sources/Utils/TimeStats.hpp \
+	Sources/Utils/TaskScheduler.hpp \
+	Sources/Utils/Tracing.hpp \
 	Sources/Utils/WADReader.hpp \
 	Sources/Utils/WidgetUtils.hpp \
 	Sources/Utils/WindowsUtils.hpp \
+	Sources/Widgets/ConsoleView.hpp \
 	Sources/Widgets/EditableListView.hpp \
 	Sources/Widgets/ExtendedTreeView.hpp \
 	Sources/Widgets/ListModel.hpp \
+	Sources/Widgets/StartupWaterfallView.hpp \
 	Sources/CommonTypes.hpp \
+	Sources/DemoBenchmark.hpp \
+	Sources/EngineOutputLog.hpp \
 	Sources/EngineTraits.hpp \
 	Sources/Essential.hpp \
 	Sources/MainWindow.hpp \
 	Sources/OptionsSerializer.hpp \
+	Sources/SingleInstance.hpp \
+	Sources/StartupProfiler.hpp \
 	Sources/Themes.hpp \
 	Sources/UpdateChecker.hpp \
 	Sources/UserData.hpp \
@@ -82,36 +103,57 @@ HEADERS += \
 SOURCES += \
 	Sources/Dialogs/AboutDialog.cpp \
 	Sources/Dialogs/CompatOptsDialog.cpp \
+	Sources/Dialogs/DemoBenchmarkDialog.cpp \
+	Sources/Dialogs/DiagnosticsDialog.cpp \
 	Sources/Dialogs/DialogCommon.cpp \
 	Sources/Dialogs/EngineDialog.cpp \
 	Sources/Dialogs/GameOptsDialog.cpp \
+	Sources/Dialogs/GuiStallsDialog.cpp \
 	Sources/Dialogs/NewConfigDialog.cpp \
 	Sources/Dialogs/OptionsStorageDialog.cpp \
 	Sources/Dialogs/OwnFileDialog.cpp \
 	Sources/Dialogs/ProcessOutputWindow.cpp \
 	Sources/Dialogs/SetupDialog.cpp \
+	Sources/Dialogs/StartupProfileDialog.cpp \
 	Sources/DoomFiles.cpp \
+	Sources/Utils/ConsoleOutputDecoder.cpp \
 	Sources/Utils/ContainerUtils.cpp \
 	Sources/Utils/ErrorHandling.cpp \
 	Sources/Utils/EventFilters.cpp \
+	Sources/Utils/ExeProber.cpp \
 	Sources/Utils/ExeReader.cpp \
 	Sources/Utils/FileInfoCache.cpp \
 	Sources/Utils/FileSystemUtils.cpp \
 	Sources/Utils/LangUtils.cpp \
 	Sources/Utils/JsonUtils.cpp \
+	Sources/Utils/LogFileWriter.cpp \
+	Sources/Utils/Metrics.cpp \
 	Sources/Utils/MiscUtils.cpp \
 	Sources/Utils/OSUtils.cpp \
+	Sources/Utils/PathChecker.cpp \
+	Sources/Utils/ProcessMonitor.cpp \
+	Sources/Utils/SearchIndex.cpp \
+	Sources/Utils/StallWatchdog.cpp \
+	Sources/Utils/StageProfiler.cpp \
 	Sources/Utils/StandardOutput.cpp \
+	Sources/Utils/TaskScheduler.cpp \
+	Sources/Utils/Tracing.cpp \
 	Sources/Utils/WADReader.cpp \
 	Sources/Utils/WidgetUtils.cpp \
 	Sources/Utils/WindowsUtils.cpp \
+	Sources/Widgets/ConsoleView.cpp \
 	Sources/Widgets/EditableListView.cpp \
 	Sources/Widgets/ExtendedTreeView.cpp \
 	Sources/Widgets/ListModel.cpp \
+	Sources/Widgets/StartupWaterfallView.cpp \
 	Sources/CommonTypes.cpp \
+	Sources/DemoBenchmark.cpp \
+	Sources/EngineOutputLog.cpp \
 	Sources/EngineTraits.cpp \
 	Sources/MainWindow.cpp \
 	Sources/OptionsSerializer.cpp \
+	Sources/SingleInstance.cpp \
+	Sources/StartupProfiler.cpp \
 	Sources/Themes.cpp \
 	Sources/UpdateChecker.cpp \
 	Sources/UserData.cpp \
@@ -122,13 +164,17 @@ SOURCES += \
 FORMS += \
 	Forms/AboutDialog.ui \
 	Forms/CompatOptsDialog.ui \
+	Forms/DemoBenchmarkDialog.ui \
+	Forms/DiagnosticsDialog.ui \
 	Forms/EngineDialog.ui \
 	Forms/GameOptsDialog.ui \
+	Forms/GuiStallsDialog.ui \
 	Forms/MainWindow.ui \
 	Forms/NewConfigDialog.ui \
 	Forms/OptionsStorageDialog.ui \
 	Forms/ProcessOutputWindow.ui \
 	Forms/SetupDialog.ui \
+	Forms/StartupProfileDialog.ui \
 
 RESOURCES += \
 	Resources/Resources.qrc
@@ -156,7 +202,7 @@ win32 {
 
 #-- libraries ------------------------------------
 
-win32: LIBS += -lole32 -luuid -ldwmapi -lversion
+win32: LIBS += -lole32 -luuid -ldwmapi -lversion -lpsapi
 
 
 #-- user configuration ---------------------------
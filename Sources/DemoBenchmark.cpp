@@ -0,0 +1,324 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: running demos with -timedemo in several engines in parallel and comparing their performance
+//======================================================================================================================
+
+#include "DemoBenchmark.hpp"
+
+#include "Utils/FileSystemUtils.hpp"  // updateFileSafely, getFileNameFromPath
+
+#include <QRegularExpression>
+#include <QProcessEnvironment>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStringBuilder>
+#include <QTextStream>
+
+
+//======================================================================================================================
+//  output parsing
+
+const char * benchmarkStatusToStr( BenchmarkResult::Status status )
+{
+	switch (status)
+	{
+		case BenchmarkResult::Status::Pending:    return "pending";
+		case BenchmarkResult::Status::Running:    return "running";
+		case BenchmarkResult::Status::Finished:   return "finished";
+		case BenchmarkResult::Status::NoTimings:  return "no timings";
+		case BenchmarkResult::Status::Failed:     return "failed";
+		case BenchmarkResult::Status::Aborted:    return "aborted";
+		default:                                  return "<invalid>";
+	}
+}
+
+bool parseTimedemoOutput( const QString & output, BenchmarkResult & result )
+{
+	// the wording differs between engine families, but all of them report "<N> gametics in <M> realtics"
+	static const QRegularExpression ticsRegex(
+		"(\\d+)\\s+gametics\\s+in\\s+(\\d+)\\s+realtics", QRegularExpression::CaseInsensitiveOption
+	);
+	static const QRegularExpression fpsRegex(
+		"(\\d+(?:\\.\\d+)?)\\s*(?:fps|frames per second)", QRegularExpression::CaseInsensitiveOption
+	);
+
+	// if the engine printed the summary more than once (e.g. -timedemo with multiple demos), the last one counts
+	QRegularExpressionMatch ticsMatch;
+	auto ticsIter = ticsRegex.globalMatch( output );
+	while (ticsIter.hasNext())
+	{
+		ticsMatch = ticsIter.next();
+	}
+	if (!ticsMatch.hasMatch())
+	{
+		return false;
+	}
+
+	result.gametics = ticsMatch.captured(1).toInt();
+	result.realtics = ticsMatch.captured(2).toInt();
+
+	// the fps is on the same line or on the next one
+	QRegularExpressionMatch fpsMatch = fpsRegex.match( output, ticsMatch.capturedEnd() );
+	if (fpsMatch.hasMatch())
+	{
+		result.fps = fpsMatch.captured(1).toDouble();
+	}
+	else if (result.realtics > 0)
+	{
+		// that's how vanilla calculates it
+		result.fps = result.gametics * 35.0 / result.realtics;
+	}
+
+	return true;
+}
+
+
+//======================================================================================================================
+//  DemoBenchmark
+
+static constexpr int maxOutputTailSize = 64 * 1024;
+
+
+DemoBenchmark::DemoBenchmark()
+:
+	LoggingComponent("DemoBenchmark")
+{}
+
+DemoBenchmark::~DemoBenchmark()
+{
+	abort();
+}
+
+void DemoBenchmark::start( QVector< BenchmarkJob > newJobs, int maxParallel )
+{
+	if (isRunning())
+	{
+		logLogicError() << "start() called while the previous benchmark is still running";
+		return;
+	}
+
+	jobs = std::move(newJobs);
+	results = QVector< BenchmarkResult >( jobs.size() );
+	processes = QVector< RunningProcess >( jobs.size() );
+	nextJobIdx = 0;
+	runningCount = 0;
+	maxParallelJobs = std::max( maxParallel, 1 );
+
+	LOG_INFO() << "starting " << jobs.size() << " jobs, " << maxParallelJobs << " at a time";
+
+	startPendingJobs();
+
+	if (jobs.isEmpty())
+	{
+		emit allJobsFinished();
+	}
+}
+
+void DemoBenchmark::abort()
+{
+	// don't start anything else
+	for (int jobIdx = nextJobIdx; jobIdx < jobs.size(); ++jobIdx)
+	{
+		results[ jobIdx ].status = BenchmarkResult::Status::Aborted;
+	}
+	nextJobIdx = jobs.size();
+
+	for (int jobIdx = 0; jobIdx < processes.size(); ++jobIdx)
+	{
+		if (QProcess * process = processes[ jobIdx ].process)
+		{
+			results[ jobIdx ].status = BenchmarkResult::Status::Aborted;
+			process->disconnect( this );  // the result is already decided, don't let the finished() signal overwrite it
+			process->kill();
+			process->waitForFinished( 1000 );
+			finishJob( jobIdx );
+		}
+	}
+}
+
+void DemoBenchmark::startPendingJobs()
+{
+	while (runningCount < maxParallelJobs && nextJobIdx < jobs.size())
+	{
+		startJob( nextJobIdx++ );
+	}
+}
+
+void DemoBenchmark::startJob( int jobIdx )
+{
+	const BenchmarkJob & job = jobs[ jobIdx ];
+	RunningProcess & running = processes[ jobIdx ];
+
+	running.process = new QProcess( this );
+	QProcess * process = running.process;
+
+	process->setProgram( job.executable );
+	process->setArguments( job.arguments.toList() );
+	process->setWorkingDirectory( job.workingDir );
+	process->setProcessChannelMode( QProcess::MergedChannels );  // some engines print the summary to stderr
+
+	QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+	for (const auto & envVar : job.envVars)
+	{
+		env.insert( envVar.name, envVar.value );
+	}
+	process->setProcessEnvironment( env );
+
+	connect( process, &QProcess::readyReadStandardOutput, this, [ this, jobIdx ]()
+	{
+		RunningProcess & runningProc = processes[ jobIdx ];
+		runningProc.outputTail += runningProc.process->readAllStandardOutput();
+		if (runningProc.outputTail.size() > maxOutputTailSize)
+		{
+			runningProc.outputTail.remove( 0, runningProc.outputTail.size() - maxOutputTailSize );
+		}
+	});
+	connect( process, QOverload< int, QProcess::ExitStatus >::of( &QProcess::finished ), this,
+		[ this, jobIdx ]( int exitCode, QProcess::ExitStatus exitStatus ) { onProcessFinished( jobIdx, exitCode, exitStatus ); }
+	);
+	connect( process, &QProcess::errorOccurred, this,
+		[ this, jobIdx ]( QProcess::ProcessError error ) { onProcessError( jobIdx, error ); }
+	);
+
+	LOG_DEBUG() << "starting job " << jobIdx << ": " << job.executable << ' ' << job.arguments;
+
+	results[ jobIdx ].status = BenchmarkResult::Status::Running;
+	runningCount++;
+	running.timer.start();
+	process->start();
+
+	emit jobStarted( jobIdx );
+}
+
+void DemoBenchmark::onProcessFinished( int jobIdx, int exitCode, QProcess::ExitStatus exitStatus )
+{
+	RunningProcess & running = processes[ jobIdx ];
+	BenchmarkResult & result = results[ jobIdx ];
+
+	result.wallTime_ms = running.timer.elapsed();
+	running.outputTail += running.process->readAllStandardOutput();
+
+	bool parsed = parseTimedemoOutput( QString::fromUtf8( running.outputTail ), result );
+	if (parsed)
+	{
+		// some engines return non-zero exit code after -timedemo, the timings are what matters
+		result.status = BenchmarkResult::Status::Finished;
+	}
+	else if (exitStatus == QProcess::CrashExit)
+	{
+		result.status = BenchmarkResult::Status::Failed;
+		result.error = "The engine crashed.";
+	}
+	else
+	{
+		result.status = BenchmarkResult::Status::NoTimings;
+		result.error = "The engine exited with code "%QString::number( exitCode )%" without reporting the timings.";
+	}
+
+	finishJob( jobIdx );
+}
+
+void DemoBenchmark::onProcessError( int jobIdx, QProcess::ProcessError error )
+{
+	// crashes and kills are handled in onProcessFinished()
+	if (error != QProcess::FailedToStart)
+		return;
+
+	BenchmarkResult & result = results[ jobIdx ];
+	result.status = BenchmarkResult::Status::Failed;
+	result.error = "Failed to start the engine ("%processes[ jobIdx ].process->errorString()%")";
+
+	finishJob( jobIdx );
+}
+
+void DemoBenchmark::finishJob( int jobIdx )
+{
+	RunningProcess & running = processes[ jobIdx ];
+	if (!running.process)
+		return;  // already finished
+
+	running.process->deleteLater();
+	running.process = nullptr;
+	running.outputTail.clear();
+	runningCount--;
+
+	LOG_DEBUG() << "job " << jobIdx << " " << benchmarkStatusToStr( results[ jobIdx ].status );
+
+	emit jobFinished( jobIdx );
+
+	startPendingJobs();
+
+	if (runningCount == 0 && nextJobIdx >= jobs.size())
+	{
+		LOG_INFO() << "all jobs finished";
+		emit allJobsFinished();
+	}
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  reports
+
+static QString csvEscaped( const QString & str )
+{
+	if (!str.contains(',') && !str.contains('"') && !str.contains('\n'))
+		return str;
+	return '"' % QString( str ).replace( "\"", "\"\"" ) % '"';
+}
+
+QString DemoBenchmark::writeCsvReport( const QString & filePath ) const
+{
+	QString content;
+	QTextStream stream( &content );
+
+	stream << "engine,demo,status,gametics,realtics,seconds,fps,wall_time_ms,error\n";
+	for (int jobIdx = 0; jobIdx < jobs.size(); ++jobIdx)
+	{
+		const BenchmarkJob & job = jobs[ jobIdx ];
+		const BenchmarkResult & result = results[ jobIdx ];
+
+		stream << csvEscaped( job.engineName ) << ','
+		       << csvEscaped( fs::getFileNameFromPath( job.demoPath ) ) << ','
+		       << benchmarkStatusToStr( result.status ) << ','
+		       << result.gametics << ','
+		       << result.realtics << ','
+		       << QString::number( result.seconds(), 'f', 3 ) << ','
+		       << QString::number( result.fps, 'f', 2 ) << ','
+		       << result.wallTime_ms << ','
+		       << csvEscaped( result.error ) << '\n';
+	}
+	stream.flush();
+
+	return fs::updateFileSafely( filePath, content.toUtf8() );
+}
+
+QString DemoBenchmark::writeJsonReport( const QString & filePath ) const
+{
+	QJsonArray jsResults;
+	for (int jobIdx = 0; jobIdx < jobs.size(); ++jobIdx)
+	{
+		const BenchmarkJob & job = jobs[ jobIdx ];
+		const BenchmarkResult & result = results[ jobIdx ];
+
+		QJsonObject jsResult;
+		jsResult["engine"] = job.engineName;
+		jsResult["demo"] = fs::getFileNameFromPath( job.demoPath );
+		jsResult["status"] = benchmarkStatusToStr( result.status );
+		jsResult["gametics"] = result.gametics;
+		jsResult["realtics"] = result.realtics;
+		jsResult["seconds"] = result.seconds();
+		jsResult["fps"] = result.fps;
+		jsResult["wall_time_ms"] = result.wallTime_ms;
+		if (!result.error.isEmpty())
+			jsResult["error"] = result.error;
+		jsResults.append( jsResult );
+	}
+
+	QJsonObject jsRoot;
+	jsRoot["results"] = jsResults;
+
+	return fs::updateFileSafely( filePath, QJsonDocument( jsRoot ).toJson() );
+}
@@ -0,0 +1,131 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: running demos with -timedemo in several engines in parallel and comparing their performance
+//======================================================================================================================
+
+#ifndef DEMO_BENCHMARK_INCLUDED
+#define DEMO_BENCHMARK_INCLUDED
+
+
+#include "Essential.hpp"
+#include "CommonTypes.hpp"
+#include "Utils/OSUtils.hpp"  // EnvVar
+#include "Utils/ErrorHandling.hpp"  // LoggingComponent
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QProcess>
+#include <QElapsedTimer>
+
+
+//======================================================================================================================
+
+/// One engine process replaying one demo.
+struct BenchmarkJob
+{
+	QString engineName;
+	QString demoPath;
+	QString executable;
+	QStringVec arguments;  ///< must already contain the -timedemo parameter
+	QString workingDir;
+	QVector< os::EnvVar > envVars;
+};
+
+struct BenchmarkResult
+{
+	enum class Status
+	{
+		Pending,
+		Running,
+		Finished,    ///< engine exited and its output contained the timedemo summary
+		NoTimings,   ///< engine exited, but the timedemo summary was not found in its output
+		Failed,      ///< engine could not be started or crashed
+		Aborted,
+	};
+	Status status = Status::Pending;
+	QString error;
+
+	int gametics = -1;      ///< number of game tics in the demo
+	int realtics = -1;      ///< number of real 1/35 s tics it took to replay them
+	double fps = -1.0;      ///< frames per second reported by the engine, or calculated from the tics
+	qint64 wallTime_ms = -1;  ///< time from process start to its exit, including engine initialization
+
+	double seconds() const  { return realtics >= 0 ? realtics / 35.0 : -1.0; }
+};
+const char * benchmarkStatusToStr( BenchmarkResult::Status status );
+
+/// Extracts the timedemo summary from the engine output.
+/** Understands the formats of vanilla-based engines ("timed 1234 gametics in 567 realtics (76.1 fps)"),
+  * PrBoom-based engines ("Timed 1234 gametics in 567 realtics = 76.1 frames per second") and ZDoom-based engines.
+  * Returns false if the summary is not found. */
+bool parseTimedemoOutput( const QString & output, BenchmarkResult & result );
+
+
+//======================================================================================================================
+/// Runs a list of benchmark jobs with a limited number of engine processes running at the same time.
+/** The processes are driven by the event loop of the thread that owns this object, no extra threads are needed. */
+
+class DemoBenchmark : public QObject, protected LoggingComponent {
+
+	Q_OBJECT
+
+	using thisClass = DemoBenchmark;
+
+ public:
+
+	DemoBenchmark();
+	virtual ~DemoBenchmark() override;
+
+	/// Starts running the jobs, at most maxParallelJobs at a time.
+	void start( QVector< BenchmarkJob > jobs, int maxParallelJobs );
+
+	/// Kills all running engine processes and drops the jobs that haven't started yet.
+	void abort();
+
+	bool isRunning() const  { return runningCount > 0; }
+
+	int jobCount() const                                 { return jobs.size(); }
+	const BenchmarkJob & job( int jobIdx ) const         { return jobs[ jobIdx ]; }
+	const BenchmarkResult & result( int jobIdx ) const   { return results[ jobIdx ]; }
+
+	QString writeCsvReport( const QString & filePath ) const;   ///< returns error message or empty string on success
+	QString writeJsonReport( const QString & filePath ) const;  ///< returns error message or empty string on success
+
+ signals:
+
+	void jobStarted( int jobIdx );
+	void jobFinished( int jobIdx );
+	void allJobsFinished();
+
+ private:
+
+	void startPendingJobs();
+	void startJob( int jobIdx );
+	void onProcessFinished( int jobIdx, int exitCode, QProcess::ExitStatus exitStatus );
+	void onProcessError( int jobIdx, QProcess::ProcessError error );
+	void finishJob( int jobIdx );
+
+ private:
+
+	struct RunningProcess
+	{
+		QProcess * process = nullptr;
+		QElapsedTimer timer;
+		QByteArray outputTail;  ///< only the end of the output is kept, the summary is printed when the demo ends
+	};
+
+	QVector< BenchmarkJob > jobs;
+	QVector< BenchmarkResult > results;
+	QVector< RunningProcess > processes;  ///< indexed by job index
+
+	int nextJobIdx = 0;
+	int runningCount = 0;
+	int maxParallelJobs = 1;
+
+};
+
+
+#endif // DEMO_BENCHMARK_INCLUDED
@@ -0,0 +1,254 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: logic of the Demo Benchmark dialog that replays a set of demos in several engines and compares them
+//======================================================================================================================
+
+#include "DemoBenchmarkDialog.hpp"
+#include "ui_DemoBenchmarkDialog.h"
+
+#include "OwnFileDialog.hpp"
+
+#include "Utils/FileSystemUtils.hpp"
+#include "Utils/ErrorHandling.hpp"
+
+#include <QDir>
+#include <QListWidgetItem>
+#include <QTableWidgetItem>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QStringBuilder>
+#include <QThread>
+
+
+//======================================================================================================================
+
+enum ResultColumn
+{
+	EngineColumn,
+	DemoColumn,
+	StatusColumn,
+	GameticsColumn,
+	SecondsColumn,
+	FpsColumn,
+	WallTimeColumn,
+
+	ColumnCount
+};
+
+static const char demoFileFilter [] = "*.lmp";
+
+
+//======================================================================================================================
+
+DemoBenchmarkDialog::DemoBenchmarkDialog(
+	QWidget * parent, const PathConvertor & pathConvertor, const QStringVec & engineNames, const QString & demoDir,
+	JobGenerator generateJob
+) :
+	QDialog( parent ),
+	DialogWithPaths( this, pathConvertor ),
+	generateJob( std::move(generateJob) )
+{
+	ui = new Ui::DemoBenchmarkDialog;
+	ui->setupUi(this);
+
+	ui->demoDirLine->setText( demoDir );
+
+	for (const QString & engineName : engineNames)
+	{
+		auto * item = new QListWidgetItem( engineName, ui->engineListWidget );
+		item->setFlags( item->flags() | Qt::ItemIsUserCheckable );
+		item->setCheckState( Qt::Unchecked );
+	}
+
+	// Leave some CPU to the system and to this launcher, otherwise the timings are distorted by the competing processes.
+	ui->parallelSpinBox->setValue( std::max( QThread::idealThreadCount() / 2, 1 ) );
+
+	ui->resultTable->setColumnCount( ColumnCount );
+	ui->resultTable->setHorizontalHeaderLabels({ "Engine", "Demo", "Status", "Gametics", "Seconds", "FPS", "Wall time [ms]" });
+	ui->resultTable->horizontalHeader()->setStretchLastSection( true );
+
+	ui->exportBtn->setEnabled( false );
+
+	connect( ui->demoDirBtn, &QToolButton::clicked, this, &thisClass::browseDemoDir );
+	connect( ui->startBtn, &QPushButton::clicked, this, &thisClass::startOrAbort );
+	connect( ui->exportBtn, &QPushButton::clicked, this, &thisClass::exportReport );
+
+	connect( &benchmark, &DemoBenchmark::jobStarted, this, &thisClass::onJobStarted );
+	connect( &benchmark, &DemoBenchmark::jobFinished, this, &thisClass::onJobFinished );
+	connect( &benchmark, &DemoBenchmark::allJobsFinished, this, &thisClass::onAllJobsFinished );
+
+	// closeEvent() is not called when the dialog is closed, we have to connect this to the finished() signal
+	connect( this, &QDialog::finished, this, &thisClass::onDialogClosed );
+}
+
+DemoBenchmarkDialog::~DemoBenchmarkDialog()
+{
+	// benchmark is destroyed after ui, it must not call our slots anymore
+	benchmark.disconnect( this );
+
+	delete ui;
+}
+
+void DemoBenchmarkDialog::browseDemoDir()
+{
+	DialogWithPaths::browseDir( this, "with demo files", ui->demoDirLine );
+}
+
+void DemoBenchmarkDialog::startOrAbort()
+{
+	if (benchmark.isRunning())
+	{
+		benchmark.abort();
+		return;
+	}
+
+	QString demoDir = ui->demoDirLine->text();
+	if (!fs::isValidDir( demoDir ))
+	{
+		reportUserError( this, "Invalid demo directory", "The demo directory doesn't exist." );
+		return;
+	}
+
+	const QFileInfoList demoFiles = QDir( demoDir ).entryInfoList( { demoFileFilter }, QDir::Files, QDir::Name );
+	if (demoFiles.isEmpty())
+	{
+		reportUserError( this, "No demos found", "The demo directory doesn't contain any ."%QString( demoFileFilter ).mid(2)%" files." );
+		return;
+	}
+
+	QVector< int > selectedEngines;
+	for (int engineIdx = 0; engineIdx < ui->engineListWidget->count(); ++engineIdx)
+	{
+		if (ui->engineListWidget->item( engineIdx )->checkState() == Qt::Checked)
+			selectedEngines.append( engineIdx );
+	}
+	if (selectedEngines.isEmpty())
+	{
+		reportUserError( this, "No engine selected", "Check at least one engine to compare." );
+		return;
+	}
+
+	// every demo is replayed by every selected engine
+	QVector< BenchmarkJob > jobs;
+	for (int engineIdx : selectedEngines)
+	{
+		for (const QFileInfo & demoFile : demoFiles)
+		{
+			BenchmarkJob job = generateJob( engineIdx, pathConvertor.convertPath( demoFile.filePath() ) );
+			if (job.executable.isEmpty())
+			{
+				return;  // errors are already shown during the generation
+			}
+			jobs.append( std::move(job) );
+		}
+	}
+
+	ui->resultTable->setRowCount( jobs.size() );
+	for (int jobIdx = 0; jobIdx < jobs.size(); ++jobIdx)
+	{
+		for (int column = 0; column < ColumnCount; ++column)
+			ui->resultTable->setItem( jobIdx, column, new QTableWidgetItem() );
+		ui->resultTable->item( jobIdx, EngineColumn )->setText( jobs[ jobIdx ].engineName );
+		ui->resultTable->item( jobIdx, DemoColumn )->setText( fs::getFileNameFromPath( jobs[ jobIdx ].demoPath ) );
+	}
+
+	finishedJobCount = 0;
+
+	ui->startBtn->setText( "Abort" );
+	ui->exportBtn->setEnabled( false );
+	ui->demoDirLine->setEnabled( false );
+	ui->demoDirBtn->setEnabled( false );
+	ui->engineListWidget->setEnabled( false );
+	ui->parallelSpinBox->setEnabled( false );
+
+	benchmark.start( std::move(jobs), ui->parallelSpinBox->value() );
+
+	for (int jobIdx = 0; jobIdx < benchmark.jobCount(); ++jobIdx)
+		updateResultRow( jobIdx );
+	updateStatusLine();
+}
+
+void DemoBenchmarkDialog::onJobStarted( int jobIdx )
+{
+	updateResultRow( jobIdx );
+}
+
+void DemoBenchmarkDialog::onJobFinished( int jobIdx )
+{
+	finishedJobCount++;
+	updateResultRow( jobIdx );
+	updateStatusLine();
+}
+
+void DemoBenchmarkDialog::onAllJobsFinished()
+{
+	ui->startBtn->setText( "Start" );
+	ui->exportBtn->setEnabled( benchmark.jobCount() > 0 );
+	ui->demoDirLine->setEnabled( true );
+	ui->demoDirBtn->setEnabled( true );
+	ui->engineListWidget->setEnabled( true );
+	ui->parallelSpinBox->setEnabled( true );
+
+	// jobs that have never been started don't emit jobFinished
+	for (int jobIdx = 0; jobIdx < benchmark.jobCount(); ++jobIdx)
+		updateResultRow( jobIdx );
+	updateStatusLine();
+}
+
+void DemoBenchmarkDialog::updateResultRow( int jobIdx )
+{
+	if (jobIdx >= ui->resultTable->rowCount())
+		return;
+
+	const BenchmarkResult & result = benchmark.result( jobIdx );
+
+	auto numberOrEmpty = []( double number, int precision ) -> QString
+	{
+		return number >= 0 ? QString::number( number, 'f', precision ) : QString();
+	};
+
+	QTableWidgetItem * statusItem = ui->resultTable->item( jobIdx, StatusColumn );
+	statusItem->setText( benchmarkStatusToStr( result.status ) );
+	statusItem->setToolTip( result.error );
+
+	ui->resultTable->item( jobIdx, GameticsColumn )->setText( result.gametics >= 0 ? QString::number( result.gametics ) : QString() );
+	ui->resultTable->item( jobIdx, SecondsColumn )->setText( numberOrEmpty( result.seconds(), 2 ) );
+	ui->resultTable->item( jobIdx, FpsColumn )->setText( numberOrEmpty( result.fps, 1 ) );
+	ui->resultTable->item( jobIdx, WallTimeColumn )->setText( result.wallTime_ms >= 0 ? QString::number( result.wallTime_ms ) : QString() );
+}
+
+void DemoBenchmarkDialog::updateStatusLine()
+{
+	QString status = QString::number( finishedJobCount ) % " of " % QString::number( benchmark.jobCount() ) % " runs finished";
+	ui->statusLabel->setText( status );
+}
+
+void DemoBenchmarkDialog::exportReport()
+{
+	QString reportPath = OwnFileDialog::getSaveFileName( this, "Export benchmark report", lastUsedDir, "CSV (*.csv);;JSON (*.json)" );
+	if (reportPath.isEmpty())  // user probably clicked cancel
+	{
+		return;
+	}
+
+	lastUsedDir = fs::getDirOfFile( reportPath );
+
+	QString error = reportPath.endsWith( ".json", Qt::CaseInsensitive )
+		? benchmark.writeJsonReport( reportPath )
+		: benchmark.writeCsvReport( reportPath );
+	if (!error.isEmpty())
+	{
+		reportRuntimeError( this, "Error exporting report", error );
+	}
+}
+
+void DemoBenchmarkDialog::onDialogClosed( int /*result*/ )
+{
+	// don't leave engines running in the background when nobody is waiting for their results
+	if (benchmark.isRunning())
+	{
+		benchmark.abort();
+	}
+}
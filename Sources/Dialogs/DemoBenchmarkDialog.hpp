@@ -0,0 +1,76 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: logic of the Demo Benchmark dialog that replays a set of demos in several engines and compares them
+//======================================================================================================================
+
+#ifndef DEMO_BENCHMARK_DIALOG_INCLUDED
+#define DEMO_BENCHMARK_DIALOG_INCLUDED
+
+
+#include "DialogCommon.hpp"
+
+#include "DemoBenchmark.hpp"
+
+#include <QDialog>
+#include <QString>
+
+#include <functional>
+
+namespace Ui {
+	class DemoBenchmarkDialog;
+}
+
+
+//======================================================================================================================
+
+class DemoBenchmarkDialog : public QDialog, private DialogWithPaths {
+
+	Q_OBJECT
+
+	using thisClass = DemoBenchmarkDialog;
+
+ public:
+
+	/// Creates a job that replays a demo in an engine with the rest of the launch options taken from the main window.
+	/** Returns a job with empty executable if the command could not be generated. */
+	using JobGenerator = std::function< BenchmarkJob ( int engineIdx, const QString & demoPath ) >;
+
+	explicit DemoBenchmarkDialog(
+		QWidget * parent, const PathConvertor & pathConvertor, const QStringVec & engineNames, const QString & demoDir,
+		JobGenerator generateJob
+	);
+	virtual ~DemoBenchmarkDialog() override;
+
+ private slots:
+
+	void browseDemoDir();
+	void startOrAbort();
+	void exportReport();
+
+	void onJobStarted( int jobIdx );
+	void onJobFinished( int jobIdx );
+	void onAllJobsFinished();
+
+	void onDialogClosed( int result );
+
+ private:
+
+	void updateResultRow( int jobIdx );
+	void updateStatusLine();
+
+ private:
+
+	Ui::DemoBenchmarkDialog * ui;
+
+	JobGenerator generateJob;
+
+	DemoBenchmark benchmark;
+
+	int finishedJobCount = 0;
+
+};
+
+
+#endif // DEMO_BENCHMARK_DIALOG_INCLUDED
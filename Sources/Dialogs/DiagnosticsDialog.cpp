@@ -0,0 +1,105 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: logic of the Diagnostics dialog that shows internal metrics of the application
+//======================================================================================================================
+
+#include "DiagnosticsDialog.hpp"
+#include "ui_DiagnosticsDialog.h"
+
+#include "Utils/Metrics.hpp"
+
+#include <QTimer>
+#include <QTreeWidgetItem>
+#include <QFont>
+
+
+//======================================================================================================================
+
+static constexpr int refreshPeriod_ms = 1000;
+
+
+//======================================================================================================================
+
+DiagnosticsDialog::DiagnosticsDialog( QWidget * parent )
+:
+	QDialog( parent ),
+	DialogCommon( this )
+{
+	ui = new Ui::DiagnosticsDialog;
+	ui->setupUi(this);
+
+	connect( ui->resetBtn, &QPushButton::clicked, this, &thisClass::resetMetrics );
+
+	// the metrics keep changing while the dialog is open, for example when a scan of directories happens
+	refreshTimer = new QTimer( this );
+	connect( refreshTimer, &QTimer::timeout, this, &thisClass::updateMetrics );
+	refreshTimer->start( refreshPeriod_ms );
+
+	updateMetrics();
+
+	ui->metricsTree->resizeColumnToContents( 0 );
+}
+
+DiagnosticsDialog::~DiagnosticsDialog()
+{
+	delete ui;
+}
+
+void DiagnosticsDialog::updateMetrics()
+{
+	const QVector< metrics::MetricValue > values = metrics::collectAll();
+
+	// The set of metrics only changes when something is constructed or destroyed, which is rare,
+	// so in most cases only the texts are updated and the scroll position and the expansion stay untouched.
+	QTreeWidget * tree = ui->metricsTree;
+	int groupIdx = -1;
+	int metricIdx = 0;
+	QTreeWidgetItem * groupItem = nullptr;
+	for (const metrics::MetricValue & value : values)
+	{
+		if (!groupItem || groupItem->text(0) != value.group)
+		{
+			if (groupItem)
+				while (groupItem->childCount() > metricIdx)
+					delete groupItem->child( metricIdx );
+
+			++groupIdx;
+			metricIdx = 0;
+			if (groupIdx < tree->topLevelItemCount())
+			{
+				groupItem = tree->topLevelItem( groupIdx );
+			}
+			else
+			{
+				groupItem = new QTreeWidgetItem( tree );  // the tree takes the ownership
+				groupItem->setExpanded( true );
+				QFont font = groupItem->font(0);
+				font.setBold( true );
+				groupItem->setFont( 0, font );
+			}
+			groupItem->setText( 0, value.group );
+		}
+
+		QTreeWidgetItem * metricItem = metricIdx < groupItem->childCount()
+			? groupItem->child( metricIdx )
+			: new QTreeWidgetItem( groupItem );  // the parent item takes the ownership
+		metricItem->setText( 0, value.name );
+		metricItem->setText( 1, value.value );
+		++metricIdx;
+	}
+
+	// remove what has been unregistered since the last update
+	if (groupItem)
+		while (groupItem->childCount() > metricIdx)
+			delete groupItem->child( metricIdx );
+	while (tree->topLevelItemCount() > groupIdx + 1)
+		delete tree->topLevelItem( groupIdx + 1 );
+}
+
+void DiagnosticsDialog::resetMetrics()
+{
+	metrics::resetAll();
+	updateMetrics();
+}
@@ -0,0 +1,50 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: logic of the Diagnostics dialog that shows internal metrics of the application
+//======================================================================================================================
+
+#ifndef DIAGNOSTICS_DIALOG_INCLUDED
+#define DIAGNOSTICS_DIALOG_INCLUDED
+
+
+#include "DialogCommon.hpp"
+
+#include <QDialog>
+
+class QTimer;
+
+namespace Ui {
+	class DiagnosticsDialog;
+}
+
+
+//======================================================================================================================
+
+class DiagnosticsDialog : public QDialog, private DialogCommon {
+
+	Q_OBJECT
+
+	using thisClass = DiagnosticsDialog;
+
+ public:
+
+	explicit DiagnosticsDialog( QWidget * parent );
+	virtual ~DiagnosticsDialog() override;
+
+ private slots:
+
+	void updateMetrics();
+	void resetMetrics();
+
+ private:
+
+	Ui::DiagnosticsDialog * ui;
+
+	QTimer * refreshTimer;
+
+};
+
+
+#endif // DIAGNOSTICS_DIALOG_INCLUDED
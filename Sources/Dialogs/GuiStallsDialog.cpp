@@ -0,0 +1,117 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: logic of the GUI Stalls dialog that shows when and why the window stopped responding
+//======================================================================================================================
+
+#include "GuiStallsDialog.hpp"
+#include "ui_GuiStallsDialog.h"
+
+#include "Utils/StallWatchdog.hpp"
+
+#include <QTimer>
+#include <QTableWidgetItem>
+#include <QDateTime>
+
+
+//======================================================================================================================
+
+static constexpr int refreshPeriod_ms = 1000;
+
+static void setCell( QTableWidget * table, int row, int column, const QString & text )
+{
+	QTableWidgetItem * item = table->item( row, column );
+	if (!item)
+	{
+		item = new QTableWidgetItem;
+		table->setItem( row, column, item );  // the table takes the ownership
+	}
+	item->setText( text );
+}
+
+
+//======================================================================================================================
+
+GuiStallsDialog::GuiStallsDialog( QWidget * parent, StallWatchdog & watchdog )
+:
+	QDialog( parent ),
+	DialogCommon( this ),
+	watchdog( watchdog )
+{
+	ui = new Ui::GuiStallsDialog;
+	ui->setupUi(this);
+
+	ui->histogramTable->setHorizontalHeaderLabels({ "Duration", "Count" });
+	ui->histogramTable->setRowCount( StallStats::bucketCount );
+	for (int bucketIdx = 0; bucketIdx < StallStats::bucketCount; ++bucketIdx)
+	{
+		setCell( ui->histogramTable, bucketIdx, 0, StallStats::bucketLabel( bucketIdx, watchdog.threshold_ms() ) );
+	}
+
+	ui->recentStallsTable->setHorizontalHeaderLabels({ "Time", "Duration", "Operation" });
+
+	ui->logStallsChkBox->setChecked( watchdog.isLoggingEnabled() );
+
+	connect( ui->logStallsChkBox, &QCheckBox::toggled, this, &thisClass::toggleLogging );
+	connect( ui->resetBtn, &QPushButton::clicked, this, &thisClass::resetStats );
+
+	// the stalls are recorded by another thread, we just show what has been collected so far
+	refreshTimer = new QTimer( this );
+	connect( refreshTimer, &QTimer::timeout, this, &thisClass::updateStats );
+	refreshTimer->start( refreshPeriod_ms );
+
+	updateStats();
+}
+
+GuiStallsDialog::~GuiStallsDialog()
+{
+	delete ui;
+}
+
+void GuiStallsDialog::updateStats()
+{
+	StallStats stats = watchdog.stats();
+
+	if (!watchdog.isRunning())
+	{
+		ui->summaryLabel->setText( "The watchdog is not running." );
+	}
+	else if (stats.stallCount == 0)
+	{
+		ui->summaryLabel->setText( QStringLiteral("No stall longer than %1 ms has been detected.").arg( watchdog.threshold_ms() ) );
+	}
+	else
+	{
+		ui->summaryLabel->setText(
+			QStringLiteral("The window stopped responding for more than %1 ms %2 times, for %3 ms in total, the longest stall took %4 ms.")
+				.arg( watchdog.threshold_ms() ).arg( stats.stallCount ).arg( stats.totalDuration_ms ).arg( stats.longest_ms )
+		);
+	}
+
+	for (int bucketIdx = 0; bucketIdx < StallStats::bucketCount; ++bucketIdx)
+	{
+		setCell( ui->histogramTable, bucketIdx, 1, QString::number( stats.histogram[ bucketIdx ] ) );
+	}
+
+	// the newest first
+	ui->recentStallsTable->setRowCount( stats.recentStalls.size() );
+	for (int row = 0; row < stats.recentStalls.size(); ++row)
+	{
+		const ThreadStall & stall = stats.recentStalls[ stats.recentStalls.size() - 1 - row ];
+		setCell( ui->recentStallsTable, row, 0, QDateTime::fromMSecsSinceEpoch( stall.endTime_ms ).toString( "HH:mm:ss" ) );
+		setCell( ui->recentStallsTable, row, 1, QStringLiteral("%1 ms").arg( stall.duration_ms ) );
+		setCell( ui->recentStallsTable, row, 2, !stall.activity.isEmpty() ? stall.activity : "unknown" );
+	}
+}
+
+void GuiStallsDialog::resetStats()
+{
+	watchdog.resetStats();
+	updateStats();
+}
+
+void GuiStallsDialog::toggleLogging( bool enabled )
+{
+	watchdog.setLoggingEnabled( enabled );
+}
@@ -0,0 +1,53 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: logic of the GUI Stalls dialog that shows when and why the window stopped responding
+//======================================================================================================================
+
+#ifndef GUI_STALLS_DIALOG_INCLUDED
+#define GUI_STALLS_DIALOG_INCLUDED
+
+
+#include "DialogCommon.hpp"
+
+#include <QDialog>
+
+class StallWatchdog;
+class QTimer;
+
+namespace Ui {
+	class GuiStallsDialog;
+}
+
+
+//======================================================================================================================
+
+class GuiStallsDialog : public QDialog, private DialogCommon {
+
+	Q_OBJECT
+
+	using thisClass = GuiStallsDialog;
+
+ public:
+
+	explicit GuiStallsDialog( QWidget * parent, StallWatchdog & watchdog );
+	virtual ~GuiStallsDialog() override;
+
+ private slots:
+
+	void updateStats();
+	void resetStats();
+	void toggleLogging( bool enabled );
+
+ private:
+
+	Ui::GuiStallsDialog * ui;
+
+	StallWatchdog & watchdog;
+	QTimer * refreshTimer;
+
+};
+
+
+#endif // GUI_STALLS_DIALOG_INCLUDED
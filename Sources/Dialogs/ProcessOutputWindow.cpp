@@ -12,7 +12,6 @@
 #include "Utils/FileSystemUtils.hpp"  // getFileNameFromPath
 #include "Utils/ErrorHandling.hpp"
 
-#include <QTextEdit>
 #include <QFontDatabase>
 #include <QPushButton>
 #include <QStringBuilder>
@@ -58,7 +57,7 @@ ProcessOutputWindow::ProcessOutputWindow( QWidget * parent )
 	QDialog( parent ),
 	DialogCommon( this )
 {
-	logDebug() << "ProcessOutputWindow()";
+	LOG_DEBUG() << "ProcessOutputWindow()";
 
 	ui = new Ui::ProcessOutputWindow;
 	ui->setupUi( this );
@@ -67,13 +66,12 @@ ProcessOutputWindow::ProcessOutputWindow( QWidget * parent )
 
 	QFont font = QFontDatabase::systemFont( QFontDatabase::FixedFont );
 	font.setPointSize( 10 );
-	ui->textEdit->setFont( font );
-	ui->textEdit->clear();
-	ui->textEdit->setOverwriteMode( true );
+	ui->consoleView->setFont( font );
+	ui->consoleView->clear();
 
 	// capture key presses so that we can send them to the process
 	keyPressFilter.toggleKeyPressSupression( true );  // stop Enter/Esc key events, otherwise they would close the window
-	ui->textEdit->installEventFilter( &keyPressFilter );
+	ui->consoleView->installEventFilter( &keyPressFilter );
 	connect( &keyPressFilter, &KeyPressFilter::keyPressed, this, &thisClass::onKeyPressed );
 
 	closeBtn->setText("Close");
@@ -83,17 +81,23 @@ ProcessOutputWindow::ProcessOutputWindow( QWidget * parent )
 	// closeEvent() is not called when the dialog is closed, we have to connect this to the finished() signal
 	connect( this, &QDialog::finished, this, &thisClass::onDialogClosed );
 
+	ui->resourcesLabel->hide();  // until the monitoring is enabled
+	ui->startupLabel->hide();  // until the start-up is profiled
+	connect( &resourceMonitor, &os::ProcessMonitor::sampleTaken, this, &thisClass::onResourceSampleTaken );
+
 	setOwnStatus( ProcessStatus::NotStarted );
 }
 
 ProcessOutputWindow::~ProcessOutputWindow()
 {
-	logDebug() << "~ProcessOutputWindow()";
+	LOG_DEBUG() << "~ProcessOutputWindow()";
+
+	resourceMonitor.stop();
 
 	if (process.state() != QProcess::NotRunning)
 	{
 		// last resort, window is quiting, we cannot let the process continue
-		logInfo() << "    killing process";
+		LOG_INFO() << "    killing process";
 		this->ownStatus = ProcessStatus::Dying;
 		process.kill();
 	}
@@ -104,7 +108,7 @@ ProcessOutputWindow::~ProcessOutputWindow()
 
 void ProcessOutputWindow::setOwnStatus( ProcessStatus status, const QString & detail )
 {
-	logDebug().noquote() << "    setOwnStatus: " << toString( status );
+	LOG_DEBUG().noquote() << "    setOwnStatus: " << toString( status );
 
 	this->ownStatus = status;
 
@@ -188,7 +192,7 @@ void ProcessOutputWindow::setOwnStatus( ProcessStatus status, const QString & de
 ProcessStatus ProcessOutputWindow::runProcess(
 	const QString & executable, const QStringVec & arguments, const QString & workingDir, const EnvVars & envVars
 ){
-	logDebug() << "ProcessOutputWindow::runProcess: " << executable;
+	LOG_DEBUG() << "ProcessOutputWindow::runProcess: " << executable;
 
 	executableName = fs::getFileNameFromPath( executable );
 	this->setWindowTitle( executableName % " output" );
@@ -205,6 +209,8 @@ ProcessStatus ProcessOutputWindow::runProcess(
 	}
 	process.setProcessEnvironment(env);
 
+	outputDecoder.reset();
+
 	connect( &process, &QProcess::started, this, &thisClass::onProcessStarted );
 	connect( &process, &QProcess::readyReadStandardOutput, this, &thisClass::readProcessOutput );
 	connect( &process, QOverload< int, QProcess::ExitStatus >::of( &QProcess::finished ), this, &thisClass::onProcessFinished );
@@ -213,6 +219,7 @@ ProcessStatus ProcessOutputWindow::runProcess(
 	setOwnStatus( ProcessStatus::Starting );
 
 	// start asynchronously and wait for signals
+	processTimer.start();
 	process.start();
 
 	// When the error occurs early and the signal is sent from within process.start(),
@@ -229,39 +236,99 @@ ProcessStatus ProcessOutputWindow::runProcess(
 	return ownStatus;
 }
 
+bool ProcessOutputWindow::startOutputLog( const QString & logName )
+{
+	return outputLog.open( logName );
+}
+
+void ProcessOutputWindow::enableResourceMonitoring( int samplingPeriod_ms )
+{
+	if (os::ProcessMonitor::isSupported())
+	{
+		resourceSamplingPeriod_ms = samplingPeriod_ms;
+		ui->resourcesLabel->show();
+	}
+}
+
+void ProcessOutputWindow::enableStartupProfiling( EngineFamily family )
+{
+	startupProfiler.start( family );
+}
+
+void ProcessOutputWindow::showStartupDuration()
+{
+	const StartupProfile & profile = startupProfiler.profile();
+	if (profile.isEmpty())
+	{
+		return;
+	}
+
+	LOG_INFO() << "engine start-up took " << profile.duration_ms << " ms";
+
+	ui->startupLabel->setText( "start-up " % QString::number( double( profile.duration_ms ) / 1000.0, 'f', 1 ) % " s" );
+	ui->startupLabel->show();
+}
+
 void ProcessOutputWindow::onProcessStarted()
 {
-	logDebug() << "ProcessOutputWindow::processStarted";
+	LOG_DEBUG() << "ProcessOutputWindow::processStarted";
 
 	setOwnStatus( ProcessStatus::Running );
+
+	if (resourceSamplingPeriod_ms > 0)
+	{
+		// the sampling runs in a separate thread, so that reading the /proc files never delays the output
+		resourceMonitor.start( process.processId(), resourceSamplingPeriod_ms );
+	}
+}
+
+void ProcessOutputWindow::onResourceSampleTaken( const os::ProcessResourceSample & sample )
+{
+	auto toMB = []( qint64 bytes ) { return QString::number( bytes / (1024 * 1024) ); };
+
+	ui->resourcesLabel->setText(
+		"CPU " % QString::number( sample.cpuPercent, 'f', 0 ) % "%"
+		% " | RAM " % toMB( sample.rss_bytes ) % " MB"
+		% " | read " % toMB( sample.readBytes ) % " MB"
+		% " | " % QString::number( sample.threadCount ) % " threads"
+	);
 }
 
 void ProcessOutputWindow::readProcessOutput()
 {
-	QByteArray output = process.readAllStandardOutput();
- #if IS_WINDOWS
-	output.replace( "\r\n", "\n" );
- #endif
+	const bool wasProfilingStartup = startupProfiler.isRunning();
+	qint64 arrivalTime_ms = 0;
 
-	// If there are still CRs, the process probably wants to return the cursor to the start of the line to overwrite it.
-	// In that case everytime we encounter CR, we need to move the cursor to the beginning of the current line manually.
-	const QList< QByteArray > parts = output.split('\r');
+	auto appendToConsole = [this, &arrivalTime_ms]( const QChar * text, int length, const ConsoleTextFormat & format )
+	{
+		// The console view keeps only a limited number of last lines and renders them periodically,
+		// so even a process spamming its output cannot make this window slower over time.
+		// It also handles the CRs that return the cursor to the start of the line to overwrite it.
+		ui->consoleView->appendText( text, length, format );
+
+		// the profiler stops looking at the output once the initialization is over
+		if (startupProfiler.isRunning())
+			startupProfiler.addOutput( text, length, arrivalTime_ms );
+	};
+
+	// Read directly into a reusable buffer and decode it in a single pass.
+	// The decoder remembers characters and escape sequences split between two reads.
+	char readBuffer [16 * 1024];
+	qint64 bytesRead;
+	while ((bytesRead = process.read( readBuffer, sizeof(readBuffer) )) > 0)
+	{
+		arrivalTime_ms = processTimer.elapsed();
 
-	QTextCursor cursor = ui->textEdit->textCursor();
+		// the log gets the raw output, it's buffered and doesn't touch the disk on every read
+		outputLog.write( readBuffer, bytesRead );
 
-	const QByteArray & beforeCR = parts[0];
-	cursor.insertText( QString::fromLatin1( beforeCR ) );
+		outputDecoder.decode( readBuffer, bytesRead, appendToConsole );
+	}
 
-	for (int i = 1; i < parts.count(); ++i)
+	if (wasProfilingStartup && !startupProfiler.isRunning())
 	{
-		const QByteArray & afterCR = parts[i];
-		// Of course in fucking Qt the override mode doesn't work so we have to select and delete the old text manually.
-		cursor.movePosition( QTextCursor::StartOfLine, QTextCursor::KeepAnchor );
-		cursor.removeSelectedText();
-		cursor.insertText( QString::fromLatin1( afterCR ) );
+		showStartupDuration();
 	}
-
-	ui->textEdit->setTextCursor( cursor );
 }
 
 void ProcessOutputWindow::onKeyPressed( int key, uint8_t modifiers )
@@ -277,13 +344,24 @@ void ProcessOutputWindow::onKeyPressed( int key, uint8_t modifiers )
 
 void ProcessOutputWindow::onProcessFinished( int exitCode, QProcess::ExitStatus exitStatus )
 {
-	logDebug() << "ProcessOutputWindow::processFinished: " << exitCode << ", " << exitStatus;
+	LOG_DEBUG() << "ProcessOutputWindow::processFinished: " << exitCode << ", " << exitStatus;
 
 	// This callback can be called even from destructor when destroying QProcess.
 	// In that case, don't do anything and abort because our own data are already destroyed.
 	if (ui == nullptr)
 		return;
 
+	// nothing more will be written, start compressing the log while the user reads the output
+	outputLog.close();
+
+	resourceMonitor.stop();  // the summary is complete now
+
+	if (startupProfiler.isRunning())
+	{
+		LOG_INFO() << "engine exited before finishing its start-up, discarding the start-up profile";
+		startupProfiler.stop();
+	}
+
 	if (ownStatus == ProcessStatus::ShuttingDown)  // user requested to terminate the process and now it finally shut down
 	{
 		setOwnStatus( ProcessStatus::Terminated );
@@ -328,7 +406,7 @@ void ProcessOutputWindow::onProcessFinished( int exitCode, QProcess::ExitStatus
 
 void ProcessOutputWindow::onErrorOccurred( QProcess::ProcessError error )
 {
-	logDebug() << "ProcessOutputWindow::errorOccurred: " << error;
+	LOG_DEBUG() << "ProcessOutputWindow::errorOccurred: " << error;
 
 	// This callback can be called even from destructor when destroying QProcess.
 	// In that case, don't do anything and abort because our own data are already destroyed.
@@ -360,19 +438,19 @@ void ProcessOutputWindow::onErrorOccurred( QProcess::ProcessError error )
 		case QProcess::ReadError:
 			setOwnStatus( ProcessStatus::UnknownError );
 			reportRuntimeError( this, "Cannot read process output", "Failed to read output of the process." );
-			logDebug() << "    terminating process";
+			LOG_DEBUG() << "    terminating process";
 			process.terminate();  // wait for the process to quit, then close dialog
 			break;
 		case QProcess::WriteError:
 			setOwnStatus( ProcessStatus::UnknownError );
 			reportRuntimeError( this, "Cannot write to process input", "Failed to write to the process input." );
-			logDebug() << "    terminating process";
+			LOG_DEBUG() << "    terminating process";
 			process.terminate();  // wait for the process to quit, then close dialog
 			break;
 		default:
 			setOwnStatus( ProcessStatus::UnknownError );
 			reportRuntimeError( this, "Unknown error", "Unknown error occured while executing command: "%process.errorString() );
-			logDebug() << "    terminating process";
+			LOG_DEBUG() << "    terminating process";
 			process.terminate();  // wait for the process to quit, then close dialog
 			break;
 	}
@@ -380,7 +458,7 @@ void ProcessOutputWindow::onErrorOccurred( QProcess::ProcessError error )
 
 void ProcessOutputWindow::onAbortClicked( bool )
 {
-	logDebug().noquote() << "ProcessOutputWindow::onAbortClicked: " << abortBtn->text();
+	LOG_DEBUG().noquote() << "ProcessOutputWindow::onAbortClicked: " << abortBtn->text();
 
 	if (process.state() != QProcess::NotRunning)
 	{
@@ -390,14 +468,14 @@ void ProcessOutputWindow::onAbortClicked( bool )
 			// This should lead to processFinished() being called soon. If it doesn't, this button will transform
 			// into a Kill button, which will then kill the process the hard way.
 			setOwnStatus( ProcessStatus::ShuttingDown );
-			logDebug() << "    terminating process";
+			LOG_DEBUG() << "    terminating process";
 			process.terminate();
 		}
 		else
 		{
 			// If the process doesn't listen to terminate signals, we can kill it the hard way.
 			setOwnStatus( ProcessStatus::Dying );
-			logDebug() << "    killing process";
+			LOG_DEBUG() << "    killing process";
 			process.kill();
 		}
 	}
@@ -409,12 +487,12 @@ void ProcessOutputWindow::onAbortClicked( bool )
 
 void ProcessOutputWindow::closeDialog( int resultCode )
 {
-	logDebug() << "    closeDialog: " << resultCode;
+	LOG_DEBUG() << "    closeDialog: " << resultCode;
 
 	this->done( resultCode );
 }
 
 void ProcessOutputWindow::onDialogClosed( int resultCode )
 {
-	logDebug() << "ProcessOutputWindow::onDialogClosed: " << resultCode;
+	LOG_DEBUG() << "ProcessOutputWindow::onDialogClosed: " << resultCode;
 }
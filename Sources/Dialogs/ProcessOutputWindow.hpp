@@ -14,9 +14,14 @@
 #include "CommonTypes.hpp"
 #include "UserData.hpp"  // EnvVars
 #include "Utils/EventFilters.hpp"
+#include "Utils/ConsoleOutputDecoder.hpp"
+#include "EngineOutputLog.hpp"
+#include "Utils/ProcessMonitor.hpp"
+#include "StartupProfiler.hpp"
 
 #include <QDialog>
 #include <QProcess>
+#include <QElapsedTimer>
 
 class QPushButton;
 class QCloseEvent;
@@ -81,12 +86,31 @@ class ProcessOutputWindow : public QDialog, private DialogCommon {
 		const QString & executable, const QStringVec & arguments, const QString & workingDir = {}, const EnvVars & envVars = {}
 	);
 
+	/// Makes the process output to be saved also into a log file. Must be called before runProcess().
+	/** \param logName Base of the log file name, usually the engine name. */
+	bool startOutputLog( const QString & logName );
+
+	/// Makes the window to periodically show CPU and memory usage of the process. Must be called before runProcess().
+	/** Does nothing on systems where the monitoring is not supported. */
+	void enableResourceMonitoring( int samplingPeriod_ms );
+
+	/// Resource usage statistics of the whole run, sampleCount is 0 if the monitoring was not enabled or supported.
+	os::ProcessResourceSummary resourceSummary() const  { return resourceMonitor.summary(); }
+
+	/// Makes the window to measure how long the individual initialization phases of the engine take.
+	/** Must be called before runProcess(). The output is interpreted according to the conventions of the engine family. */
+	void enableStartupProfiling( EngineFamily family );
+
+	/// Timeline of the engine initialization, empty if the profiling was not enabled or the start-up didn't finish.
+	const StartupProfile & startupProfile() const  { return startupProfiler.profile(); }
+
  private slots:
 
 	void onProcessStarted();
 	void readProcessOutput();
 	void onProcessFinished( int exitCode, QProcess::ExitStatus exitStatus );
 	void onErrorOccurred( QProcess::ProcessError error );
+	void onResourceSampleTaken( const os::ProcessResourceSample & sample );
 
 	void onKeyPressed( int key, uint8_t modifiers );
 
@@ -101,6 +125,8 @@ class ProcessOutputWindow : public QDialog, private DialogCommon {
 
 	void setOwnStatus( ProcessStatus status, const QString & detail = QString() );
 
+	void showStartupDuration();
+
  private: // members
 
 	Ui::ProcessOutputWindow * ui;
@@ -108,6 +134,12 @@ class ProcessOutputWindow : public QDialog, private DialogCommon {
 	QPushButton * closeBtn;  ///< shortcut to the Close button in the list of ui->buttonBox
 
 	QProcess process;
+	ConsoleOutputDecoder outputDecoder;
+	EngineOutputLog outputLog;
+	os::ProcessMonitor resourceMonitor;
+	int resourceSamplingPeriod_ms = 0;  ///< 0 means disabled
+	StartupProfiler startupProfiler;
+	QElapsedTimer processTimer;  ///< measures time since the process start, used for timestamping the output
 
 	QString executableName;
 
@@ -73,6 +73,8 @@ SetupDialog::SetupDialog(
 	ui->absolutePathsChkBox->setChecked( settings.pathStyle == PathStyle::Absolute );
 	ui->showEngineOutputChkBox->setChecked( settings.showEngineOutput );
 	ui->closeOnLaunchChkBox->setChecked( settings.closeOnLaunch );
+	ui->logEngineOutputChkBox->setChecked( settings.logEngineOutput );
+	ui->binaryOptionsFileChkBox->setChecked( settings.binaryOptionsFile );
 
 	ui->styleCmbBox->addItem( "System default" );
 	ui->styleCmbBox->addItems( themes::getAvailableAppStyles() );
@@ -118,6 +120,8 @@ SetupDialog::SetupDialog(
 
 	connect( ui->showEngineOutputChkBox, &QCheckBox::toggled, this, &thisClass::onShowEngineOutputToggled );
 	connect( ui->closeOnLaunchChkBox, &QCheckBox::toggled, this, &thisClass::onCloseOnLaunchToggled );
+	connect( ui->logEngineOutputChkBox, &QCheckBox::toggled, this, &thisClass::onLogEngineOutputToggled );
+	connect( ui->binaryOptionsFileChkBox, &QCheckBox::toggled, this, &thisClass::onBinaryOptionsFileToggled );
 
 	connect( ui->doneBtn, &QPushButton::clicked, this, &thisClass::accept );
 
@@ -603,3 +607,13 @@ void SetupDialog::onCloseOnLaunchToggled( bool checked )
 		ui->showEngineOutputChkBox->setChecked( false );
 	}
 }
+
+void SetupDialog::onLogEngineOutputToggled( bool checked )
+{
+	settings.logEngineOutput = checked;
+}
+
+void SetupDialog::onBinaryOptionsFileToggled( bool checked )
+{
+	settings.binaryOptionsFile = checked;
+}
@@ -105,6 +105,8 @@ class SetupDialog : public QDialog, public DialogWithPaths {
 
 	void onShowEngineOutputToggled( bool checked );
 	void onCloseOnLaunchToggled( bool checked );
+	void onLogEngineOutputToggled( bool checked );
+	void onBinaryOptionsFileToggled( bool checked );
 
  private: // methods
 
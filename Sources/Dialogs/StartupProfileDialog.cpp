@@ -0,0 +1,113 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: logic of the Start-up Profiles dialog that compares engine initialization times of a preset
+//======================================================================================================================
+
+#include "StartupProfileDialog.hpp"
+#include "ui_StartupProfileDialog.h"
+
+#include <QDateTime>
+#include <QStringBuilder>
+
+
+//======================================================================================================================
+
+static QString sessionLabel( const PlaySession & session )
+{
+	return QDateTime::fromSecsSinceEpoch( session.startTime ).toString( "yyyy-MM-dd HH:mm:ss" )
+		% " - " % session.engineName
+		% " - " % QString::number( double( session.startup.duration_ms ) / 1000.0, 'f', 2 ) % " s";
+}
+
+
+//======================================================================================================================
+
+StartupProfileDialog::StartupProfileDialog( QWidget * parent, const QString & presetName, const QVector< PlaySession > & history )
+:
+	QDialog( parent ),
+	DialogCommon( this )
+{
+	ui = new Ui::StartupProfileDialog;
+	ui->setupUi(this);
+
+	this->setWindowTitle( "Start-up profiles of " % presetName );
+
+	// the history is ordered from the oldest, but the latest runs are the most interesting
+	for (auto sessionIter = history.rbegin(); sessionIter != history.rend(); ++sessionIter)
+	{
+		if (!sessionIter->startup.isEmpty())
+		{
+			profiledSessions.append( *sessionIter );
+		}
+	}
+
+	ui->baselineCmbBox->addItem( "nothing" );
+	for (const PlaySession & session : profiledSessions)
+	{
+		QString label = sessionLabel( session );
+		ui->runCmbBox->addItem( label );
+		ui->baselineCmbBox->addItem( label );
+	}
+
+	if (profiledSessions.isEmpty())
+	{
+		ui->runCmbBox->setEnabled( false );
+		ui->baselineCmbBox->setEnabled( false );
+		ui->hintLabel->setText( "Launch this preset with the engine output window enabled to record its start-up." );
+	}
+
+	connect( ui->runCmbBox, QOverload<int>::of( &QComboBox::currentIndexChanged ), this, &thisClass::onRunSelected );
+	connect( ui->baselineCmbBox, QOverload<int>::of( &QComboBox::currentIndexChanged ), this, &thisClass::updateWaterfall );
+
+	onRunSelected( ui->runCmbBox->currentIndex() );
+}
+
+StartupProfileDialog::~StartupProfileDialog()
+{
+	delete ui;
+}
+
+void StartupProfileDialog::onRunSelected( int runIdx )
+{
+	if (runIdx < 0 || runIdx >= profiledSessions.size())
+	{
+		ui->waterfallView->setProfiles( {} );
+		return;
+	}
+
+	// By default compare with the previous run of the same engine, different engines print different phases.
+	int baselineIdx = -1;
+	for (int sessionIdx = runIdx + 1; sessionIdx < profiledSessions.size(); ++sessionIdx)
+	{
+		if (profiledSessions[ sessionIdx ].engineName == profiledSessions[ runIdx ].engineName)
+		{
+			baselineIdx = sessionIdx;
+			break;
+		}
+	}
+
+	// the first item is "nothing"
+	if (ui->baselineCmbBox->currentIndex() != baselineIdx + 1)
+		ui->baselineCmbBox->setCurrentIndex( baselineIdx + 1 );  // this will call updateWaterfall()
+	else
+		updateWaterfall();
+}
+
+void StartupProfileDialog::updateWaterfall()
+{
+	int runIdx = ui->runCmbBox->currentIndex();
+	int baselineIdx = ui->baselineCmbBox->currentIndex() - 1;  // the first item is "nothing"
+
+	if (runIdx < 0 || runIdx >= profiledSessions.size())
+	{
+		ui->waterfallView->setProfiles( {} );
+		return;
+	}
+
+	if (baselineIdx >= 0 && baselineIdx < profiledSessions.size())
+		ui->waterfallView->setProfiles( profiledSessions[ runIdx ].startup, profiledSessions[ baselineIdx ].startup );
+	else
+		ui->waterfallView->setProfiles( profiledSessions[ runIdx ].startup );
+}
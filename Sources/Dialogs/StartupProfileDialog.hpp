@@ -0,0 +1,51 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: logic of the Start-up Profiles dialog that compares engine initialization times of a preset
+//======================================================================================================================
+
+#ifndef STARTUP_PROFILE_DIALOG_INCLUDED
+#define STARTUP_PROFILE_DIALOG_INCLUDED
+
+
+#include "DialogCommon.hpp"
+
+#include "UserData.hpp"  // PlaySession
+
+#include <QDialog>
+#include <QVector>
+
+namespace Ui {
+	class StartupProfileDialog;
+}
+
+
+//======================================================================================================================
+
+class StartupProfileDialog : public QDialog, private DialogCommon {
+
+	Q_OBJECT
+
+	using thisClass = StartupProfileDialog;
+
+ public:
+
+	explicit StartupProfileDialog( QWidget * parent, const QString & presetName, const QVector< PlaySession > & history );
+	virtual ~StartupProfileDialog() override;
+
+ private slots:
+
+	void onRunSelected( int runIdx );
+	void updateWaterfall();
+
+ private:
+
+	Ui::StartupProfileDialog * ui;
+
+	QVector< PlaySession > profiledSessions;  ///< sessions that have a start-up profile, the newest first
+
+};
+
+
+#endif // STARTUP_PROFILE_DIALOG_INCLUDED
@@ -0,0 +1,309 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: saving the output of started engines into rotating compressed log files
+//======================================================================================================================
+
+#include "EngineOutputLog.hpp"
+
+#include "Utils/OSUtils.hpp"  // getThisAppDataDir
+#include "Utils/FileSystemUtils.hpp"
+#include "Utils/TaskScheduler.hpp"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringBuilder>
+
+#include <array>
+#include <cstring>
+
+
+//======================================================================================================================
+//  gzip compression
+
+// Qt only offers zlib format via qCompress(), but the raw deflate stream inside it can be re-wrapped
+// into a gzip container, which can be opened by any archiver or viewed directly with zless.
+// https://www.rfc-editor.org/rfc/rfc1952
+
+static quint32 crc32( const QByteArray & data )
+{
+	static const auto crcTable = []()
+	{
+		std::array< quint32, 256 > table;
+		for (quint32 n = 0; n < 256; ++n)
+		{
+			quint32 c = n;
+			for (int k = 0; k < 8; ++k)
+				c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : (c >> 1);
+			table[ n ] = c;
+		}
+		return table;
+	}();
+
+	quint32 crc = 0xFFFFFFFF;
+	for (char byte : data)
+		crc = crcTable[ (crc ^ quint8( byte )) & 0xFF ] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFF;
+}
+
+static void appendLittleEndian32( QByteArray & output, quint32 value )
+{
+	for (int i = 0; i < 4; ++i)
+		output.append( char( (value >> (8 * i)) & 0xFF ) );
+}
+
+/// Returns empty array if the compression fails.
+static QByteArray gzipCompress( const QByteArray & data )
+{
+	// qCompress() output: 4 bytes of uncompressed size, 2 bytes of zlib header, deflate stream, 4 bytes of Adler-32
+	const QByteArray zlibData = qCompress( data, 6 );
+	constexpr int qtHeaderSize = 4, zlibHeaderSize = 2, zlibTrailerSize = 4;
+	if (data.isEmpty() || zlibData.size() <= qtHeaderSize + zlibHeaderSize + zlibTrailerSize)
+	{
+		return {};
+	}
+
+	static const char gzipHeader [10] = {
+		'\x1f', '\x8b',   // magic
+		8,                // deflate
+		0,                // no flags
+		0, 0, 0, 0,       // no modification time
+		0,                // no extra flags
+		'\xff',           // unknown OS
+	};
+
+	QByteArray gzipData;
+	gzipData.reserve( zlibData.size() + int( sizeof(gzipHeader) ) + 8 );
+	gzipData.append( gzipHeader, int( sizeof(gzipHeader) ) );
+	gzipData.append(
+		zlibData.constData() + qtHeaderSize + zlibHeaderSize,
+		zlibData.size() - qtHeaderSize - zlibHeaderSize - zlibTrailerSize
+	);
+	appendLittleEndian32( gzipData, crc32( data ) );
+	appendLittleEndian32( gzipData, quint32( data.size() ) );
+
+	return gzipData;
+}
+
+static const char logSuffix [] = ".log";
+static const char compressedSuffix [] = ".gz";
+
+/// Replaces the file with its gzipped version. Returns false if anything fails, in which case the original is kept.
+static bool compressLogFile( const QString & filePath )
+{
+	QFile file( filePath );
+	if (!file.open( QIODevice::ReadOnly ))
+	{
+		return false;
+	}
+	QByteArray content = file.readAll();
+	file.close();
+
+	if (content.isEmpty())
+	{
+		return QFile::remove( filePath );  // nothing worth keeping
+	}
+
+	QByteArray compressed = gzipCompress( content );
+	if (compressed.isEmpty())
+	{
+		return false;
+	}
+
+	QString compressedPath = filePath % compressedSuffix;
+	if (!fs::updateFileSafely( compressedPath, compressed ).isEmpty())
+	{
+		return false;
+	}
+
+	if (!QFile::remove( filePath ))  // still opened by a running engine (on Windows)
+	{
+		QFile::remove( compressedPath );
+		return false;
+	}
+
+	return true;
+}
+
+
+//======================================================================================================================
+//  background tasks
+
+// The tasks can run concurrently in the shared scheduler and they must not process the same file twice.
+static QMutex g_logDirMutex;
+
+/// Nobody waits for the tasks, but they must not outlive the program. The unstarted ones are dropped at the exit,
+/// the remaining uncompressed logs will be compressed by the next clean-up.
+static tasks::TaskGroup & logTasks()
+{
+	static tasks::TaskGroup group;
+	return group;
+}
+
+// Logs of detached engines are written by the engine directly, we can't know when it exits.
+// Assume it has exited when it hasn't written anything for a long time.
+static constexpr qint64 inactivityBeforeCompression_s = 12 * 60 * 60;
+
+/// Compresses logs that were left uncompressed and deletes the oldest ones above the limit.
+static void cleanUpLogDir( const QString & logDir, const QString & excludedPath )
+{
+	QMutexLocker lock( &g_logDirMutex );
+
+	const QStringList nameFilters = { QString("*") + logSuffix, QString("*") + logSuffix + compressedSuffix };
+	QFileInfoList logFiles = QDir( logDir ).entryInfoList( nameFilters, QDir::Files, QDir::Time );  // newest first
+
+	for (int fileIdx = EngineOutputLog::maxKeptLogFiles; fileIdx < logFiles.size(); ++fileIdx)
+	{
+		QFile::remove( logFiles[ fileIdx ].filePath() );
+	}
+
+	const QDateTime now = QDateTime::currentDateTime();
+	for (int fileIdx = 0; fileIdx < logFiles.size() && fileIdx < EngineOutputLog::maxKeptLogFiles; ++fileIdx)
+	{
+		const QFileInfo & logFile = logFiles[ fileIdx ];
+		if (logFile.fileName().endsWith( logSuffix ) && logFile.filePath() != excludedPath  // the new log about to be written
+		 && logFile.lastModified().secsTo( now ) > inactivityBeforeCompression_s)
+		{
+			compressLogFile( logFile.filePath() );
+		}
+	}
+}
+
+
+//======================================================================================================================
+//  EngineOutputLog
+
+EngineOutputLog::EngineOutputLog() : LoggingComponent("EngineOutputLog") {}
+
+EngineOutputLog::~EngineOutputLog()
+{
+	close();
+}
+
+QString EngineOutputLog::logDir()
+{
+	return os::getThisAppDataDir() % "/engine_logs";
+}
+
+QString EngineOutputLog::newLogFilePath( const QString & engineName )
+{
+	QString dirPath = logDir();
+	if (!fs::createDirIfDoesntExist( dirPath ))
+	{
+		::logRuntimeError("EngineOutputLog") << "Failed to create directory " << dirPath;
+		return {};
+	}
+
+	// the engine name is user-defined, make sure it's safe to use in a file name
+	QString safeEngineName;
+	for (QChar c : engineName)
+		safeEngineName += (c.isLetterOrNumber() || c == '-') ? c : QChar('_');
+
+	QString timestamp = QDateTime::currentDateTime().toString( "yyyy-MM-dd_HH-mm-ss" );
+	QString filePath = dirPath % '/' % safeEngineName % '_' % timestamp % logSuffix;
+
+	tasks::sharedScheduler().submit( tasks::Priority::BackgroundIdle, logTasks(),
+		[ dirPath, filePath ]( const tasks::CancellationToken & ) { cleanUpLogDir( dirPath, filePath ); }
+	);
+
+	return filePath;
+}
+
+bool EngineOutputLog::open( const QString & engineName )
+{
+	close();
+
+	QString filePath = newLogFilePath( engineName );
+	if (filePath.isEmpty())
+	{
+		return false;
+	}
+
+	_firstPartPath = filePath;
+	_partNumber = 1;
+	_buffer.reserve( writeBufferSize );
+
+	return openPart( filePath );
+}
+
+bool EngineOutputLog::openPart( const QString & filePath )
+{
+	_file.setFileName( filePath );
+	if (!_file.open( QIODevice::WriteOnly | QIODevice::Unbuffered ))  // we have our own buffer
+	{
+		logRuntimeError() << "Failed to open " << filePath << " for writing: " << _file.errorString();
+		return false;
+	}
+
+	_partSize = 0;
+	return true;
+}
+
+void EngineOutputLog::write( const char * data, qint64 size )
+{
+	if (!_file.isOpen())
+	{
+		return;
+	}
+
+	_buffer.append( data, int( size ) );
+
+	if (_buffer.size() >= writeBufferSize)
+	{
+		flushBuffer();
+	}
+
+	if (_partSize >= maxPartSize)
+	{
+		// rotate to the next part
+		closePart();
+
+		++_partNumber;
+		QString nextPartPath = _firstPartPath;
+		nextPartPath.insert( nextPartPath.size() - int( strlen(logSuffix) ), '.' % QString::number( _partNumber ) );
+		openPart( nextPartPath );
+	}
+}
+
+void EngineOutputLog::flushBuffer()
+{
+	if (_buffer.isEmpty())
+	{
+		return;
+	}
+
+	if (_file.write( _buffer ) != _buffer.size())
+	{
+		logRuntimeError() << "Failed to write to " << _file.fileName() << ": " << _file.errorString();
+	}
+
+	_partSize += _buffer.size();
+	_buffer.resize( 0 );  // keep the capacity
+}
+
+void EngineOutputLog::closePart()
+{
+	flushBuffer();
+
+	QString partPath = _file.fileName();
+	_file.close();
+
+	// compressing several MB takes a while, don't block the output window with it
+	tasks::sharedScheduler().submit( tasks::Priority::BackgroundIdle, logTasks(), [ partPath ]( const tasks::CancellationToken & )
+	{
+		QMutexLocker lock( &g_logDirMutex );
+		compressLogFile( partPath );
+	});
+}
+
+void EngineOutputLog::close()
+{
+	if (_file.isOpen())
+	{
+		closePart();
+	}
+}
@@ -0,0 +1,80 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: saving the output of started engines into rotating compressed log files
+//======================================================================================================================
+
+#ifndef ENGINE_OUTPUT_LOG_INCLUDED
+#define ENGINE_OUTPUT_LOG_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "Utils/ErrorHandling.hpp"  // LoggingComponent
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+
+
+//======================================================================================================================
+/// Log file of a single engine launch, split into parts of limited size.
+/** The writes are buffered, so that the output window doesn't touch the disk for every line the engine prints.
+  * When a part exceeds the size limit, it is closed and compressed by gzip in a background thread
+  * and the writing continues to the next part. The last part is compressed when the log is closed.
+  * Every time a new log is created, the oldest logs above the limit are deleted in the background. */
+
+class EngineOutputLog : protected LoggingComponent {
+
+ public:
+
+	static constexpr qint64 maxPartSize = 8 * 1024 * 1024;
+	static constexpr int writeBufferSize = 64 * 1024;
+	static constexpr int maxKeptLogFiles = 100;
+
+	EngineOutputLog();
+	~EngineOutputLog();
+
+	/// Directory in the application data where the engine logs are stored.
+	static QString logDir();
+
+	/// Creates a path for a new log file of the engine and starts a background clean-up of the older logs.
+	/** This can also be used to redirect output of a detached process directly into a file. Such file is not rotated,
+	  * but it will be compressed by the background clean-up when the engine hasn't been writing to it for a long time.
+	  * Returns empty string if the log directory cannot be created. */
+	static QString newLogFilePath( const QString & engineName );
+
+	/// Opens a new log for the engine, returns false and logs an error if it can't be created.
+	bool open( const QString & engineName );
+
+	bool isOpen() const  { return _file.isOpen(); }
+
+	/// Appends a piece of engine output to the log.
+	void write( const char * data, qint64 size );
+
+	/// Flushes the remaining data and starts the compression of the last part.
+	void close();
+
+	/// Path of the first part of the log.
+	const QString & filePath() const  { return _firstPartPath; }
+
+ private:
+
+	bool openPart( const QString & filePath );
+	void closePart();
+	void flushBuffer();
+
+ private:
+
+	QString _firstPartPath;
+	int _partNumber = 0;
+	qint64 _partSize = 0;
+
+	QFile _file;
+	QByteArray _buffer;
+
+};
+
+
+#endif // ENGINE_OUTPUT_LOG_INCLUDED
@@ -16,6 +16,11 @@
 #include "Dialogs/GameOptsDialog.hpp"
 #include "Dialogs/CompatOptsDialog.hpp"
 #include "Dialogs/ProcessOutputWindow.hpp"
+#include "EngineOutputLog.hpp"
+#include "Dialogs/DemoBenchmarkDialog.hpp"
+#include "Dialogs/StartupProfileDialog.hpp"
+#include "Dialogs/GuiStallsDialog.hpp"
+#include "Dialogs/DiagnosticsDialog.hpp"
 
 #include "OptionsSerializer.hpp"
 #include "Version.hpp"  // window title
@@ -33,6 +38,10 @@
 #include "Utils/WidgetUtils.hpp"
 #include "Utils/MiscUtils.hpp"  // checkPath, highlightPathIfInvalid
 #include "Utils/ErrorHandling.hpp"
+#include "Utils/JsonUtils.hpp"  // parseJsonFile
+#include "Utils/Tracing.hpp"
+#include "Utils/Metrics.hpp"
+#include "Utils/TaskScheduler.hpp"
 
 #include <QVector>
 #include <QList>
@@ -47,6 +56,7 @@
 #include <QMessageBox>
 #include <QTimer>
 #include <QProcess>
+#include <QDateTime>
 
 #include <QVBoxLayout>
 #include <QPlainTextEdit>
@@ -56,6 +66,7 @@
 //======================================================================================================================
 
 static const char defaultOptionsFileName [] = "options.json";
+static const char binaryOptionsFileName [] = "options.dat";
 static const char defaultCacheFileName [] = "file_info_cache.json";
 
 #if IS_WINDOWS
@@ -68,6 +79,13 @@ static const char defaultCacheFileName [] = "file_info_cache.json";
 static constexpr bool VerifyPaths = true;
 static constexpr bool DontVerifyPaths = false;
 
+static metrics::Distribution g_iwadScanDuration( "Directory scans", "IWADs", "ms" );
+static metrics::Distribution g_configScanDuration( "Directory scans", "config files", "ms" );
+static metrics::Distribution g_saveScanDuration( "Directory scans", "save files", "ms" );
+static metrics::Distribution g_demoScanDuration( "Directory scans", "demo files", "ms" );
+static metrics::Counter g_launchCommandUpdates( "Launch command", "regenerations" );
+static metrics::Distribution g_optionsSnapshotDuration( "Options saving", "snapshot duration", "ms" );
+
 
 //======================================================================================================================
 //  MainWindow-specific utils
@@ -100,6 +118,14 @@ IWAD * MainWindow::getSelectedIWAD() const
 template< typename Functor >
 void MainWindow::forEachSelectedMapPack( const Functor & loopBody ) const
 {
+	// until the map packs of the preset are checked, the view is empty, but the launch command must contain them
+	if (mapPackCheckPending)
+	{
+		for (const QString & mapPackPath : checkedMapPacks)
+			loopBody( mapPackPath );
+		return;
+	}
+
 	// clicking on an item in QTreeView with QFileSystemModel selects all elements (columns) of a row,
 	// but we only care about the first one
 	const auto selectedRows = wdg::getSelectedRows( ui->mapDirView );
@@ -498,7 +524,7 @@ AudioOptions & MainWindow::activeAudioOptions()
 //======================================================================================================================
 //  MainWindow
 
-MainWindow::MainWindow()
+MainWindow::MainWindow( bool profileStartup )
 :
 	QMainWindow( nullptr ),
 	DialogWithPaths(
@@ -530,6 +556,10 @@ MainWindow::MainWindow()
 		/*makeDisplayString*/ []( const Preset & preset ) { return preset.name; }
 	)
 {
+	if (profileStartup)
+		startupProfiler.start();
+	StageProfiler::Stage stage( startupProfiler, "constructing the window" );
+
 	ui = new Ui::MainWindow;
 	ui->setupUi( this );
 
@@ -549,7 +579,13 @@ MainWindow::MainWindow()
 	connect( ui->optionsStorageAction, &QAction::triggered, this, &thisClass::runOptsStorageDialog );
 	connect( ui->exportPresetToScriptAction, &QAction::triggered, this, &thisClass::exportPresetToScript );
 	connect( ui->exportPresetToShortcutAction, &QAction::triggered, this, &thisClass::exportPresetToShortcut );
+	connect( ui->demoBenchmarkAction, &QAction::triggered, this, &thisClass::runDemoBenchmarkDialog );
+	connect( ui->startupProfileAction, &QAction::triggered, this, &thisClass::runStartupProfileDialog );
+	connect( ui->guiStallsAction, &QAction::triggered, this, &thisClass::runGuiStallsDialog );
+	ui->performanceTraceAction->setChecked( tracing::isEnabled() );  // might have been started from the command line
+	connect( ui->performanceTraceAction, &QAction::toggled, this, &thisClass::togglePerformanceTrace );
 	//connect( ui->importPresetAction, &QAction::triggered, this, &thisClass::importPreset );
+	connect( ui->diagnosticsAction, &QAction::triggered, this, &thisClass::runDiagnosticsDialog );
 	connect( ui->aboutAction, &QAction::triggered, this, &thisClass::runAboutDialog );
 	connect( ui->exitAction, &QAction::triggered, this, &thisClass::close );
 
@@ -565,6 +601,8 @@ MainWindow::MainWindow()
 	setupModList();
 	setupEnvVarLists();
 
+	registerDiagnostics();
+
 	// setup combo-boxes
 
 	// we use custom model for engines, because we want to display the same list differently in different window
@@ -668,7 +706,9 @@ void MainWindow::adjustUi()
 void MainWindow::setupPresetList()
 {
 	// connect the view with model
+	presetModel.toggleDisplayStringCache( true );  // before the view connects to the model, so that the cache is updated first
 	ui->presetListView->setModel( &presetModel );
+	ui->presetListView->setUniformItemSizes( true );  // there can be thousands of presets
 
 	// set selection rules
 	ui->presetListView->setSelectionMode( QAbstractItemView::SingleSelection );
@@ -716,7 +756,9 @@ void MainWindow::setupPresetList()
 void MainWindow::setupIWADList()
 {
 	// connect the view with model
+	iwadModel.toggleDisplayStringCache( true );  // before the view connects to the model, so that the cache is updated first
 	ui->iwadListView->setModel( &iwadModel );
+	ui->iwadListView->setUniformItemSizes( true );
 
 	// set selection rules
 	ui->iwadListView->setSelectionMode( QAbstractItemView::SingleSelection );
@@ -769,12 +811,21 @@ void MainWindow::setupMapPackList()
 	// when the model is set to display a certain directory, we cannot select items from the view right away,
 	// but must wait until the list is populated.
 	connect( &mapModel, &QFileSystemModel::directoryLoaded, this, &thisClass::onMapDirUpdated );
+
+ #if !IS_WINDOWS
+	connect( &engineProber, &os::ExeProber::exeProbed, this, &thisClass::onEngineProbed );
+ #endif
+
+	// existence of the map packs and mods selected in a preset is checked in the background
+	connect( &pathChecker, &fs::PathChecker::pathsChecked, this, &thisClass::onPathsChecked );
 }
 
 void MainWindow::setupModList()
 {
 	// connect the view with model
+	modModel.toggleDisplayStringCache( true );  // before the view connects to the model, so that the cache is updated first
 	ui->modListView->setModel( &modModel );
+	ui->modListView->setUniformItemSizes( true );
 
 	// set selection rules
 	ui->modListView->setSelectionMode( QAbstractItemView::ExtendedSelection );
@@ -802,10 +853,12 @@ void MainWindow::setupModList()
 	// setup reaction to key shortcuts and right click
 	ui->modListView->toggleContextMenu( true );
 	addCmdArgAction = ui->modListView->addAction( "Add command line argument", {} );
+	addDirContentAction = ui->modListView->addAction( "Add all mods from a directory", {} );
 	ui->modListView->enableInsertSeparator();
 	ui->modListView->enableOpenFileLocation();
 	connect( ui->modListView->addItemAction, &QAction::triggered, this, &thisClass::modAdd );
 	connect( addCmdArgAction, &QAction::triggered, this, &thisClass::modAddArg );
+	connect( addDirContentAction, &QAction::triggered, this, &thisClass::modAddDirContent );
 	connect( ui->modListView->deleteItemAction, &QAction::triggered, this, &thisClass::modDelete );
 	connect( ui->modListView->moveItemUpAction, &QAction::triggered, this, &thisClass::modMoveUp );
 	connect( ui->modListView->moveItemDownAction, &QAction::triggered, this, &thisClass::modMoveDown );
@@ -823,6 +876,7 @@ void MainWindow::setupModList()
 	ui->modListView->enableTogglingIcons();  // allow the icons to be toggled via context-menu
 	ui->modListView->toggleIcons( true );  // we need to do this instead of modModel.toggleIcons() in order to update the action text
 	connect( ui->modListView->toggleIconsAction, &QAction::triggered, this, &thisClass::modToggleIcons );
+	setModIconsLoadedCallback( [ this ]() { modModel.iconsChanged(); } );
 }
 
 void MainWindow::setupEnvVarLists()
@@ -838,6 +892,39 @@ void MainWindow::setupEnvVarLists()
 	connect( ui->globalEnvVarTable, &QTableWidget::cellChanged, this, &thisClass::onGlobalEnvVarDataChanged );
 }
 
+/// Describes the number of rows and the memory taken by the items themselves,
+/// the strings and other data they point to are not included, so it's only a lower estimate.
+template< typename Model >
+static QString describeModelSize( const Model & model )
+{
+	qint64 itemsSize = qint64( model.size() ) * qint64( sizeof( typename Model::Item ) );
+	return QStringLiteral("%1 rows, ~%2").arg( model.size() ).arg( metrics::formatSize( itemsSize ) );
+}
+
+void MainWindow::registerDiagnostics()
+{
+	// The gauges are evaluated in the GUI thread when the Diagnostics dialog is refreshed, so they can read the models.
+
+	auto addGauge = [ this ]( const char * group, const char * name, std::function< QString () > getValue )
+	{
+		diagnosticGauges.push_back( std::make_unique< metrics::Gauge >( group, name, std::move(getValue) ) );
+	};
+
+	addGauge( "Models", "presets", [ this ]() { return describeModelSize( presetModel ); } );
+	addGauge( "Models", "mods of the selected preset", [ this ]() { return describeModelSize( modModel ); } );
+	addGauge( "Models", "engines", [ this ]() { return describeModelSize( engineModel ); } );
+	addGauge( "Models", "IWADs", [ this ]() { return describeModelSize( iwadModel ); } );
+	addGauge( "Models", "config files", [ this ]() { return describeModelSize( configModel ); } );
+	addGauge( "Models", "save files", [ this ]() { return describeModelSize( saveModel ); } );
+	addGauge( "Models", "demo files", [ this ]() { return describeModelSize( demoModel ); } );
+
+	addGauge( "Memory", "whole process", []() { return metrics::formatSize( os::getOwnMemoryUsage() ); } );
+
+	addGauge( "GUI stalls", "count", [ this ]() { return QString::number( stallWatchdog.stats().stallCount ); } );
+	addGauge( "GUI stalls", "longest", [ this ]() { return QStringLiteral("%1 ms").arg( stallWatchdog.stats().longest_ms ); } );
+	addGauge( "GUI stalls", "total", [ this ]() { return QStringLiteral("%1 ms").arg( stallWatchdog.stats().totalDuration_ms ); } );
+}
+
 void MainWindow::loadMonitorInfo( QComboBox * box )
 {
 	const auto monitors = os::listMonitors();
@@ -873,7 +960,7 @@ static void moveOptionsFromOldDir( QDir oldOptionsDir, QDir newOptionsDir, QStri
 			%optionsFileName%" has been found in the old data directory \""%oldOptionsDir.path()%"\""
 			" and will be automatically moved to the new data directory \""%newOptionsDir.path()%"\""
 		);
-		logInfo() <<
+		LOG_INFO() <<
 			"NOTICE: Found "%optionsFileName%" in the old data directory \""%oldOptionsDir.path()%"\". "
 			"Moving it to the new data directory \""%newOptionsDir.path()%"\"";
 
@@ -881,6 +968,23 @@ static void moveOptionsFromOldDir( QDir oldOptionsDir, QDir newOptionsDir, QStri
 	}
 }
 
+static const char * getOptionsFileName( const LauncherSettings & settings )
+{
+	return settings.binaryOptionsFile ? binaryOptionsFileName : defaultOptionsFileName;
+}
+
+/// Returns the options file that was written the last time, when the user switches the format, the old one stays there.
+static QString getLatestOptionsFilePath( const QDir & optionsDir )
+{
+	QFileInfo jsonFile( optionsDir.filePath( defaultOptionsFileName ) );
+	QFileInfo binaryFile( optionsDir.filePath( binaryOptionsFileName ) );
+
+	if (binaryFile.isFile() && (!jsonFile.isFile() || binaryFile.lastModified() > jsonFile.lastModified()))
+		return binaryFile.filePath();
+	else
+		return jsonFile.filePath();
+}
+
 void MainWindow::updateOptionsGrpBoxTitles( const StorageSettings & storageSettings )
 {
 	static const char * const optsStorageStrings [] =
@@ -915,55 +1019,118 @@ void MainWindow::showEvent( QShowEvent * event )
 // This is called after the window is fully initialized and physically shown (drawn for the first time).
 void MainWindow::onWindowShown()
 {
-	// Potentially expensive file-system operations are done here,
-	// just to make sure the application doesn't hang without even showing anything.
-	// We should probably do this asynchronously, but there has not been any reported problems with this,
-	// so it's probably fine.
+	startupProfiler.logTimePoint( "window shown" );
+
+	// From now on the event loop is running, so a ping that isn't answered means the window is not responding.
+	// The rest of the startup is watched too, it's where the users most often see the launcher freeze.
+	stallWatchdog.start();
+
+	// The startup is split into stages, so that the window doesn't hang without even showing anything:
+	//   1. Here the cache and the options file are read and parsed in background threads, both at the same time.
+	//   2. onStartupFilesPreloaded() deserializes them and populates the UI.
+	//   3. finishStartup() starts everything that isn't needed for the first interactive frame,
+	//      like the periodic directory scans.
+
+	{
+		StageProfiler::Stage stage( startupProfiler, "preparing the data directory" );
+
+		// create a directory for application data, if it doesn't exist already
+		appDataDir.setPath( os::getThisAppDataDir() );
+		if (!appDataDir.exists())
+		{
+			appDataDir.mkpath(".");
+		}
+
+		// backward compatibility
+		moveOptionsFromOldDir( os::getThisAppConfigDir(), appDataDir, defaultOptionsFileName );
+
+		optionsFilePath = getLatestOptionsFilePath( appDataDir );
+		cacheFilePath = appDataDir.filePath( defaultCacheFileName );
+	}
+
+	bool cacheExists = fs::isValidFile( cacheFilePath );
+	bool optionsExist = fs::isValidFile( optionsFilePath );
+
+	if (!cacheExists && !optionsExist)
+	{
+		onStartupFilesPreloaded();
+		return;
+	}
+
+	// the user is waiting for these, so they go before any other background work
+	QVector< tasks::TaskID > preloadTasks;
 
-	// create a directory for application data, if it doesn't exist already
-	appDataDir.setPath( os::getThisAppDataDir() );
-	if (!appDataDir.exists())
+	if (cacheExists)
 	{
-		appDataDir.mkpath(".");
+		preloadTasks.append( tasks::sharedScheduler().submit( tasks::Priority::Interactive, startupTasks,
+			[ this, filePath = cacheFilePath ]( const tasks::CancellationToken & )
+		{
+			preloaded.cacheStart_ms = startupProfiler.elapsed_ms();
+			preloaded.cache = parseJsonFile( filePath, "file-info cache", IgnoreEmpty, preloaded.cacheError );
+			preloaded.cacheEnd_ms = startupProfiler.elapsed_ms();
+		}));
 	}
 
-	// backward compatibility
-	moveOptionsFromOldDir( os::getThisAppConfigDir(), appDataDir, defaultOptionsFileName );
+	if (optionsExist)
+	{
+		preloadTasks.append( tasks::sharedScheduler().submit( tasks::Priority::Interactive, startupTasks,
+			[ this, filePath = optionsFilePath ]( const tasks::CancellationToken & )
+		{
+			preloaded.optionsStart_ms = startupProfiler.elapsed_ms();
+			preloaded.options = preloadOptionsFile( filePath );
+			preloaded.optionsEnd_ms = startupProfiler.elapsed_ms();
+		}));
+	}
+
+	// continue in the GUI thread when both files are read
+	tasks::sharedScheduler().submitWithResult( tasks::Priority::Interactive, startupTasks,
+		/*work*/[]( const tasks::CancellationToken & ) {},
+		/*receiver*/this,
+		/*onDone*/[ this ]() { onStartupFilesPreloaded(); },
+		/*dependencies*/preloadTasks
+	);
+}
 
-	optionsFilePath = appDataDir.filePath( defaultOptionsFileName );
-	cacheFilePath = appDataDir.filePath( defaultCacheFileName );
+void MainWindow::onStartupFilesPreloaded()
+{
+	startupProfiler.logStage( "reading the cache (background)", preloaded.cacheStart_ms, preloaded.cacheEnd_ms );
+	startupProfiler.logStage( "reading the options (background)", preloaded.optionsStart_ms, preloaded.optionsEnd_ms );
 
 	// cache needs to be loaded first, because loadOptions() already needs it
-	if (fs::isValidFile( cacheFilePath ))
+	if (!preloaded.cacheError.isEmpty())
 	{
-		loadCache( cacheFilePath );
+		reportRuntimeError( this, "Error loading file-info cache", preloaded.cacheError );
 	}
+	else if (!preloaded.cache.isNull())
+	{
+		StageProfiler::Stage stage( startupProfiler, "loading the cache" );
+		loadCache( cacheFilePath, preloaded.cache );
+	}
+	preloaded.cache = {};  // free the memory
 
 	// try to load last saved state
-	if (fs::isValidFile( optionsFilePath ))
+	if (!preloaded.options.filePath.isEmpty())
 	{
-		loadOptions( optionsFilePath );
+		StageProfiler::Stage stage( startupProfiler, "loading the options" );
+		if (loadOptions( std::move( preloaded.options ) ))
+			optionsFilePath = appDataDir.filePath( getOptionsFileName( settings ) );  // the next save might convert it
 	}
 	else  // this is a first run, perform an initial setup
 	{
 		runSetupDialog();
 	}
+	preloaded.options = {};
 
-	// This must be called after the options are loaded, because options might change application style,
-	// and that might change widget sizes.
-	adjustUi();
+	{
+		StageProfiler::Stage stage( startupProfiler, "adjusting the UI" );
 
-	// integrate the loaded storage settings into the titles of options group-boxes
-	updateOptionsGrpBoxTitles( settings );
+		// This must be called after the options are loaded, because options might change application style,
+		// and that might change widget sizes.
+		adjustUi();
 
- #if IS_WINDOWS
-	// Qt on Windows does not automatically follow OS preferences, so we have to monitor the OS settings for changes
-	// and manually change our theme when it does.
-	// Rather set this after loading options, because the MainWindow is blocked (is not updating) during the whole
-	// options loading including any potential error messages, which if the theme is switched in the middle
-	// might show in some kind of half-switched state.
-	systemThemeWatcher.start();
- #endif
+		// integrate the loaded storage settings into the titles of options group-boxes
+		updateOptionsGrpBoxTitles( settings );
+	}
 
 	// if the presets are empty, add a default one so that users don't complain that they can't enter anything
 	if (presetModel.isEmpty())
@@ -977,6 +1144,39 @@ void MainWindow::onWindowShown()
 		autoselectItems();
 	}
 
+	startupFinished = true;
+
+	// now that the presets are loaded, we can perform the actions requested from the command line
+	for (const StartupArgs & args : as_const( pendingStartupArgs ))
+	{
+		executeStartupArgs( args );
+	}
+	pendingStartupArgs.clear();
+
+	startupProfiler.logTimePoint( "options restored" );
+
+	// The repaint of the restored UI has already been requested, so it's queued before this call.
+	QTimer::singleShot( 0, this, &thisClass::finishStartup );
+}
+
+void MainWindow::finishStartup()
+{
+	startupProfiler.logTimePoint( "first frame with the options painted" );
+
+	StageProfiler::Stage stage( startupProfiler, "starting background activities" );
+
+	// executables on Linux don't have a version info, we have to ask the engines about their versions
+	probeUnknownEngines();
+
+ #if IS_WINDOWS
+	// Qt on Windows does not automatically follow OS preferences, so we have to monitor the OS settings for changes
+	// and manually change our theme when it does.
+	// Rather set this after loading options, because the MainWindow is blocked (is not updating) during the whole
+	// options loading including any potential error messages, which if the theme is switched in the middle
+	// might show in some kind of half-switched state.
+	systemThemeWatcher.start();
+ #endif
+
 	if (settings.checkForUpdates)
 	{
 		updateChecker.checkForUpdates_async(
@@ -991,10 +1191,81 @@ void MainWindow::onWindowShown()
 		);
 	}
 
-	// setup an update timer
+	// setup an update timer, that periodically scans the directories for new files
 	startTimer( 1000 );
 }
 
+void MainWindow::executeStartupArgs( const StartupArgs & args )
+{
+	if (!startupFinished)
+	{
+		pendingStartupArgs.append( args );
+		return;
+	}
+
+	// When started again from a shortcut or a file association, the user expects to see the window.
+	if (isMinimized())
+		showNormal();
+	raise();
+	activateWindow();
+
+	if (!args.presetName.isEmpty())
+	{
+		// the preset might be hidden by the search filter
+		if (presetModel.isFiltered())
+			presetSearchPanel->collapse();
+
+		int presetIdx = findSuch( presetModel, [&]( const Preset & preset )
+		{
+			return !preset.isSeparator && preset.name == args.presetName;
+		});
+		if (presetIdx < 0)
+		{
+			reportUserError( this, "Preset not found", "Preset \""%args.presetName%"\" requested from the command line doesn't exist." );
+			return;
+		}
+
+		// This invokes the callback, which calls restorePreset(...)
+		wdg::selectAndSetCurrentByIndex( ui->presetListView, presetIdx );
+	}
+
+	if (!args.filesToOpen.isEmpty())
+	{
+		Preset * selectedPreset = getSelectedPreset();
+		if (!selectedPreset)
+		{
+			reportUserError( this, "No preset selected", "Files passed from the command line can only be added to a selected preset." );
+			return;
+		}
+
+		QList< Mod > mods;
+		mods.reserve( args.filesToOpen.size() );
+		for (const QString & filePath : args.filesToOpen)
+		{
+			QFileInfo modInfo( pathConvertor.convertPath( filePath ) );
+
+			Mod mod;
+			mod.path = modInfo.filePath();
+			mod.fileName = modInfo.fileName();
+			// a guess that doesn't touch the file-system, the files are typically passed by a file association
+			mod.iconKey = Mod::makeIconKey( modInfo, /*isDir*/modInfo.suffix().isEmpty() );
+			mod.checked = true;
+			mods.append( std::move(mod) );
+		}
+
+		appendMods( std::move(mods) );
+	}
+
+	if (args.launch)
+	{
+		// the launch command would miss the preset's map packs that haven't been checked yet
+		if (mapPackCheckPending)
+			launchAfterMapPackCheck = true;
+		else
+			launch();
+	}
+}
+
 void MainWindow::timerEvent( QTimerEvent * event )  // called once per second
 {
 	superClass::timerEvent( event );
@@ -1012,6 +1283,9 @@ void MainWindow::timerEvent( QTimerEvent * event )  // called once per second
 		updateListsFromDirs();
 	}
 
+	// the options are written in a background thread, the errors have to be picked up here
+	reportOptionsWriteError();
+
 	if (tickCount % 10 == 0)
 	{
 		if (optionsNeedUpdate   // don't do unnecessary file writes when nothing has changed
@@ -1030,21 +1304,34 @@ void MainWindow::timerEvent( QTimerEvent * event )  // called once per second
 
 void MainWindow::closeEvent( QCloseEvent * event )
 {
-	if (!optionsCorrupted)  // don't overwrite existing file with empty data, when there was just one small syntax error
+	// the files might still be being read, they must not be overwritten with the defaults
+	startupTasks.waitForDone();
+
+	if (!optionsCorrupted  // don't overwrite existing file with empty data, when there was just one small syntax error
+	 && startupFinished)
 		saveOptions( optionsFilePath );
 
+	// the process must not exit before the latest options are written
+	optionsWriter.waitForDone();
+	reportOptionsWriteError();
+
 	if (isCacheDirty())
 		saveCache( cacheFilePath );
 
  #if IS_WINDOWS
 	systemThemeWatcher.stop(500);
+ #else
+	engineProber.stop();
  #endif
+	pathChecker.stop();
+	stallWatchdog.stop();
 
 	superClass::closeEvent( event );
 }
 
 MainWindow::~MainWindow()
 {
+	setModIconsLoadedCallback( nullptr );
 	delete ui;
 }
 
@@ -1111,8 +1398,17 @@ void MainWindow::runSetupDialog()
 		iwadModel.assignList( std::move( dialog.iwadModel.list() ) );
 		mapSettings = std::move( dialog.mapSettings );
 		modSettings = std::move( dialog.modSettings );
+
+		// presets that haven't been decoded yet contain paths in the previous style, togglePathStyle() can't convert them
+		if (dialog.settings.pathStyle != settings.pathStyle)
+			for (Preset & preset : presetModel.fullList())
+				decodePresetContent( preset, settings, optionsFilePath );
+
 		settings = std::move( dialog.settings );
 
+		// the options will be written in the newly selected format, the old file will be ignored from now on
+		optionsFilePath = appDataDir.filePath( getOptionsFileName( settings ) );
+
 		// update all stored paths
 		togglePathStyle( settings.pathStyle );
 		currentEngine = pathConvertor.convertPath( currentEngine );
@@ -1139,6 +1435,9 @@ void MainWindow::runSetupDialog()
 
 		scheduleSavingOptions();
 		updateLaunchCommand();
+
+		// new engines might have been added
+		probeUnknownEngines();
 	}
 }
 
@@ -1154,6 +1453,10 @@ void MainWindow::runOptsStorageDialog()
 	// update the data only if user clicked Ok
 	if (code == QDialog::Accepted)
 	{
+		// presets that haven't been decoded yet must be decoded according to the storage settings they were saved with
+		for (Preset & preset : presetModel.fullList())
+			decodePresetContent( preset, settings, optionsFilePath );
+
 		settings.assign( dialog.storageSettings );
 		scheduleSavingOptions();
 		updateOptionsGrpBoxTitles( settings );
@@ -1196,6 +1499,95 @@ void MainWindow::runCompatOptsDialog()
 	}
 }
 
+void MainWindow::runDemoBenchmarkDialog()
+{
+	QStringVec engineNames;
+	for (const EngineInfo & engine : engineModel)
+	{
+		engineNames.append( engine.name );
+	}
+
+	// The demos are replayed with the files and options of the currently selected preset,
+	// only the engine and the launch mode are replaced.
+	auto generateJob = [ this ]( int engineIdx, const QString & demoPath ) -> BenchmarkJob
+	{
+		const EngineInfo & engine = engineModel[ engineIdx ];
+
+		QString currentWorkingDir = pathConvertor.workingDir().path();
+		QString engineWorkingDir = fs::getAbsoluteDirOfFile( engine.executablePath );
+
+		// same path rules as in launch()
+		auto cmd = generateLaunchCommand(
+			currentWorkingDir, PathStyle::Absolute, engineWorkingDir, pathConvertor.pathStyle(), DontQuotePaths, VerifyPaths,
+			&engine, demoPath
+		);
+
+		BenchmarkJob job;
+		job.engineName = engine.name;
+		job.demoPath = demoPath;
+		job.executable = std::move(cmd.executable);
+		job.arguments = std::move(cmd.arguments);
+		job.workingDir = engineWorkingDir;
+		job.envVars = globalOpts.envVars;
+		if (const Preset * preset = getSelectedPreset())
+			job.envVars += preset->envVars;
+		return job;
+	};
+
+	DemoBenchmarkDialog dialog( this, pathConvertor, engineNames, getDemoDir(), std::move(generateJob) );
+
+	dialog.exec();
+}
+
+void MainWindow::runStartupProfileDialog()
+{
+	const Preset * selectedPreset = getSelectedPreset();
+	if (!selectedPreset)
+	{
+		reportUserError( this, "No preset selected", "Select a preset whose start-up profiles you want to see." );
+		return;
+	}
+
+	StartupProfileDialog dialog( this, selectedPreset->name, selectedPreset->history );
+
+	dialog.exec();
+}
+
+void MainWindow::runGuiStallsDialog()
+{
+	GuiStallsDialog dialog( this, stallWatchdog );
+
+	dialog.exec();
+}
+
+void MainWindow::runDiagnosticsDialog()
+{
+	DiagnosticsDialog dialog( this );
+
+	dialog.exec();
+}
+
+void MainWindow::togglePerformanceTrace( bool enabled )
+{
+	tracing::setEnabled( enabled );
+	if (enabled)
+	{
+		return;  // the trace will be saved when the user stops it
+	}
+
+	QString traceFilePath = OwnFileDialog::getSaveFileName( this, "Save performance trace", lastUsedDir, "Chrome trace (*.json)" );
+	if (traceFilePath.isEmpty())  // user probably clicked cancel
+	{
+		return;
+	}
+
+	QString error = tracing::exportChromeTrace( traceFilePath );
+	if (!error.isEmpty())
+	{
+		reportRuntimeError( this, "Error saving performance trace", error );
+	}
+}
+
 void MainWindow::openEngineDataDir()
 {
 	const EngineInfo * selectedEngine = getSelectedEngine();
@@ -1429,6 +1821,16 @@ void MainWindow::onMapPackToggled( const QItemSelection & /*selected*/, const QI
 	if (disableSelectionCallbacks)
 		return;
 
+	bool launchNow = false;
+	if (mapPackCheckPending)
+	{
+		// The user has changed the selection before the check of the preset's map packs has finished,
+		// the results would overwrite it.
+		mapPackCheckPending = false;
+		mapPackCheckBatchID = 0;  // the results of the batch will be ignored
+		launchNow = std::exchange( launchAfterMapPackCheck, false );
+	}
+
 	QStringVec selectedMapPacks = getSelectedMapPacks();
 
 	/*bool storageModified =*/ STORE_TO_CURRENT_PRESET_IF_SAFE( selectedMapPacks, selectedMapPacks );
@@ -1463,6 +1865,9 @@ void MainWindow::onMapPackToggled( const QItemSelection & /*selected*/, const QI
 
 	//scheduleSavingOptions( storageModified );
 	updateLaunchCommand();
+
+	if (launchNow)  // requested from the command line
+		launch();
 }
 
 void MainWindow::onPresetDataChanged( const QModelIndex & topLeft, const QModelIndex &, const QVector<int> & roles )
@@ -1484,6 +1889,10 @@ void MainWindow::onPresetDataChanged( const QModelIndex & topLeft, const QModelI
 
 void MainWindow::onModDataChanged( const QModelIndex & topLeft, const QModelIndex & bottomRight, const QVector<int> & roles )
 {
+	if (roles == QVector<int>{ Qt::DecorationRole }  // only the icons have been loaded, nothing to save
+	 || roles == QVector<int>{ Qt::ForegroundRole, Qt::DecorationRole })  // only the existence of the mods has been checked
+		return;
+
 	int topModIdx = topLeft.row();
 	int bottomModIdx = bottomRight.row();
 
@@ -1745,10 +2154,8 @@ void MainWindow::searchPresets( const QString & phrase, bool caseSensitive, bool
 			selectedPresetBeforeSearch = wdg::getSelectedItemID( ui->presetListView, presetModel );
 		}
 
-		// filter the model data
-		presetModel.startCompleteUpdate();
-		presetModel.search( phrase, caseSensitive, useRegex );
-		presetModel.finishCompleteUpdate();
+		// filter the model data, the view is notified only about the rows that disappeared or appeared
+		presetModel.search( phrase, caseSensitive, useRegex, /*listener*/ presetModel );
 
 		// try to re-select the same preset as before
 		if (!selectedPresetBeforeSearch.isEmpty())
@@ -1773,9 +2180,7 @@ void MainWindow::searchPresets( const QString & phrase, bool caseSensitive, bool
 		}
 
 		// restore the model data
-		presetModel.startCompleteUpdate();
-		presetModel.restore();
-		presetModel.finishCompleteUpdate();
+		presetModel.restore( /*listener*/ presetModel );
 
 		// try to re-select the same preset as before
 		if (!selectedPresetBeforeSearch.isEmpty())
@@ -1812,23 +2217,14 @@ void MainWindow::modAdd()
 		for (QString & path : paths)
 			path = pathConvertor.getRelativePath( path );
 
-	Preset * selectedPreset = getSelectedPreset();
-
+	QList< Mod > mods;
+	mods.reserve( paths.size() );
 	for (const QString & path : paths)
 	{
-		Mod mod( QFileInfo( path ), true );
-
-		wdg::appendItem( ui->modListView, modModel, mod );
-
-		// add it also to the current preset
-		if (selectedPreset)
-		{
-			selectedPreset->mods.append( mod );
-		}
+		mods.append( Mod( QFileInfo( path ), true ) );
 	}
 
-	scheduleSavingOptions();
-	updateLaunchCommand();
+	appendMods( std::move( mods ) );
 }
 
 void MainWindow::modAddDir()
@@ -1845,6 +2241,7 @@ void MainWindow::modAddDir()
 	Mod mod;
 	mod.path = path;
 	mod.fileName = fs::getFileNameFromPath( path );
+	mod.iconKey = Mod::makeIconKey( QFileInfo( path ) );
 	mod.checked = true;
 
 	wdg::appendItem( ui->modListView, modModel, mod );
@@ -1859,6 +2256,50 @@ void MainWindow::modAddDir()
 	updateLaunchCommand();
 }
 
+void MainWindow::modAddDirContent()
+{
+	QString dirPath = OwnFileDialog::getExistingDirectory( this, "Locate the directory with mods", modSettings.dir );
+
+	if (dirPath.isEmpty())  // user probably clicked cancel
+		return;
+
+	// the path comming out of the file dialog is always absolute
+	if (pathConvertor.usingRelativePaths())
+		dirPath = pathConvertor.getRelativePath( dirPath );
+
+	QList< Mod > mods;
+	fs::traverseDirectory( dirPath, /*recursively*/true, fs::EntryType::FILE, pathConvertor, [&]( const QFileInfo & file )
+	{
+		if (doom::isMapPack( file ))
+		{
+			mods.append( Mod( file, true ) );
+		}
+	});
+
+	if (mods.isEmpty())
+	{
+		reportUserError( this, "No mods found", "The directory doesn't contain any mod files." );
+		return;
+	}
+
+	appendMods( std::move( mods ) );
+}
+
+void MainWindow::appendMods( QList< Mod > && mods )
+{
+	// add them also to the current preset
+	if (Preset * selectedPreset = getSelectedPreset())
+	{
+		selectedPreset->mods.append( mods );
+	}
+
+	// everything at once, there can be thousands of them
+	wdg::appendItems( ui->modListView, modModel, std::move( mods ) );
+
+	scheduleSavingOptions();
+	updateLaunchCommand();
+}
+
 void MainWindow::modAddArg()
 {
 	Mod mod;
@@ -2812,6 +3253,9 @@ void MainWindow::togglePathStyle( PathStyle style )
 
 	for (Preset & preset : presetModel)
 	{
+		if (!preset.isContentDecoded())
+			continue;  // already stored in the current style, see runSetupDialog()
+
 		preset.selectedEnginePath = pathConvertor.convertPath( preset.selectedEnginePath );
 		preset.selectedIWAD = pathConvertor.convertPath( preset.selectedIWAD );
 		for (QString & selectedMapPack : preset.selectedMapPacks)
@@ -2841,6 +3285,57 @@ void MainWindow::fillDerivedEngineInfo( DirectList< EngineInfo > & engines )
 	}
 }
 
+/// Starts background probes of engines whose version info can't be read from the executable and is not cached yet.
+/** The results come asynchronously to onEngineProbed(). */
+void MainWindow::probeUnknownEngines()
+{
+ #if !IS_WINDOWS
+	QStringVec executablesToProbe;
+	for (const EngineInfo & engine : engineModel)
+	{
+		if (fs::isValidFile( engine.executablePath )
+		 && !os::g_cachedExeInfo.containsValidInfo( engine.executablePath )
+		 && !executablesToProbe.contains( engine.executablePath ))
+		{
+			executablesToProbe.append( engine.executablePath );
+		}
+	}
+
+	if (!executablesToProbe.isEmpty())
+	{
+		engineProber.probeAsync( executablesToProbe );
+	}
+ #endif
+}
+
+void MainWindow::onEngineProbed( const QString & executablePath, qint64 lastModified, const os::UncertainExeVersionInfo & exeInfo )
+{
+	if (exeInfo.status != ReadStatus::Success && exeInfo.status != ReadStatus::InfoNotPresent)
+	{
+		return;  // keep the NotSupported entry, so that we try again next time
+	}
+
+	// the cache is not thread-safe, so it can only be updated here in the main thread
+	os::g_cachedExeInfo.storeFileInfo( executablePath, lastModified, exeInfo );
+
+	// reload the traits of all engines using this executable, the new version might change the generated command
+	bool selectedEngineChanged = false;
+	const EngineInfo * selectedEngine = getSelectedEngine();
+	for (EngineInfo & engine : engineModel)
+	{
+		if (engine.executablePath == executablePath)
+		{
+			engine.loadAppInfo( engine.executablePath );
+			selectedEngineChanged |= &engine == selectedEngine;
+		}
+	}
+
+	if (selectedEngineChanged)
+	{
+		updateLaunchCommand();
+	}
+}
+
 
 //----------------------------------------------------------------------------------------------------------------------
 //  automatic list updates according to directory content
@@ -2858,6 +3353,8 @@ void MainWindow::fillDerivedEngineInfo( DirectList< EngineInfo > & engines )
 
 void MainWindow::updateListsFromDirs()
 {
+	TRACE_ZONE("MainWindow::updateListsFromDirs");
+
 	if (iwadSettings.updateFromDir)
 		updateIWADsFromDir();
 	updateConfigFilesFromDir();
@@ -2867,6 +3364,8 @@ void MainWindow::updateListsFromDirs()
 
 void MainWindow::updateIWADsFromDir()
 {
+	metrics::ScopedTimer timer( g_iwadScanDuration );
+
 	// workaround (read the big comment above)
 	int origIwadIdx = wdg::getSelectedItemIndex( ui->iwadListView );
 	disableSelectionCallbacks = true;
@@ -2903,6 +3402,8 @@ void MainWindow::resetMapDirModelAndView()
 
 void MainWindow::updateConfigFilesFromDir( const QString * callersConfigDir )
 {
+	metrics::ScopedTimer timer( g_configScanDuration );
+
 	QString configDir = callersConfigDir ? *callersConfigDir : getConfigDir();
 
 	// workaround (read the big comment above)
@@ -2925,6 +3426,8 @@ void MainWindow::updateConfigFilesFromDir( const QString * callersConfigDir )
 
 void MainWindow::updateSaveFilesFromDir( const QString * callersSaveDir )
 {
+	metrics::ScopedTimer timer( g_saveScanDuration );
+
 	QString saveDir = callersSaveDir ? *callersSaveDir : getSaveDir();
 
 	// workaround (read the big comment above)
@@ -2947,6 +3450,8 @@ void MainWindow::updateSaveFilesFromDir( const QString * callersSaveDir )
 
 void MainWindow::updateDemoFilesFromDir( const QString * callersDemoDir )
 {
+	metrics::ScopedTimer timer( g_demoScanDuration );
+
 	QString demoDir = callersDemoDir ? *callersDemoDir : getDemoDir();
 
 	// workaround (read the big comment above)
@@ -3083,8 +3588,12 @@ void MainWindow::updateMapsFromSelectedWADs( const QStringVec * selectedMapPacks
 //----------------------------------------------------------------------------------------------------------------------
 //  saving and loading user data
 
-bool MainWindow::saveOptions( const QString & filePath )
+// The serialization and the file write run in a background thread, here we only take a snapshot of the current state.
+void MainWindow::saveOptions( const QString & filePath )
 {
+	TRACE_ZONE("MainWindow::saveOptions");
+	metrics::ScopedTimer timer( g_optionsSnapshotDuration );
+
 	OptionsToSave opts =
 	{
 		// files
@@ -3113,11 +3622,24 @@ bool MainWindow::saveOptions( const QString & filePath )
 		this->geometry()
 	};
 
-	return writeOptionsToFile( opts, filePath );
+	optionsWriter.writeInBackground( OptionsSnapshot( opts ), filePath );
 }
 
-bool MainWindow::loadOptions( const QString & filePath )
+void MainWindow::reportOptionsWriteError()
 {
+	QString error = optionsWriter.takeError();
+	if (!error.isEmpty())
+	{
+		reportRuntimeError( this, "Error saving options", error );
+	}
+}
+
+bool MainWindow::loadOptions( PreloadedOptions && preloadedOptions )
+{
+	TRACE_ZONE("MainWindow::loadOptions");
+
+	QString filePath = preloadedOptions.filePath;
+
 	// Some options can be read directly into the class members using references,
 	// but the models can't, because the UI must be prepared for reseting its models first.
 	OptionsToLoad opts
@@ -3148,7 +3670,7 @@ bool MainWindow::loadOptions( const QString & filePath )
 		{}  // window geometry
 	};
 
-	bool optionsRead = readOptionsFromFile( opts, filePath );
+	bool optionsRead = readOptionsFromFile( opts, std::move( preloadedOptions ) );
 	if (!optionsRead)
 	{
 		if (fs::exists( filePath ))
@@ -3178,13 +3700,13 @@ bool MainWindow::saveCache( const QString & filePath )
 	return writeJsonToFile( jsonDoc, filePath, "file-info cache" );
 }
 
-bool MainWindow::loadCache( const QString & filePath )
+bool MainWindow::loadCache( const QString & filePath, const QJsonDocument & preloadedDoc )
 {
-	JsonDocumentCtx jsonDoc = readJsonFromFile( filePath, "file-info cache", IgnoreEmpty );
-	if (!jsonDoc)
+	if (preloadedDoc.isNull())
 	{
 		return false;
 	}
+	JsonDocumentCtx jsonDoc( filePath, preloadedDoc );
 
 	const JsonObjectCtx & jsRoot = jsonDoc.rootObject();
 	if (JsonObjectCtx jsExeCache = jsRoot.getObject("exe_info"))
@@ -3353,6 +3875,8 @@ void MainWindow::restoreLoadedOptions( OptionsToLoad && opts )
 
 void MainWindow::restorePreset( int presetIdx )
 {
+	TRACE_ZONE("MainWindow::restorePreset");
+
 	// Restoring any stored options is tricky.
 	// Every change of a selection, like  cmbBox->setCurrentIndex( stored.idx )  or  selectItemByIdx( stored.idx )
 	// causes the corresponding callbacks to be called which in turn might cause some other stored value to be changed.
@@ -3365,6 +3889,9 @@ void MainWindow::restorePreset( int presetIdx )
 
 	Preset & preset = presetModel[ presetIdx ];
 
+	// presets from the binary options file are decoded only when they are selected for the first time
+	decodePresetContent( preset, settings, optionsFilePath );
+
 	restoreSelectedEngine( preset );
 	restoreSelectedConfig( preset );
 	restoreSelectedIWAD( preset );
@@ -3540,48 +4067,23 @@ void MainWindow::restoreSelectedIWAD( Preset & preset )
 
 void MainWindow::restoreSelectedMapPacks( Preset & preset )
 {
-	auto origSelection = ui->mapDirView->selectionModel()->selection();
-	disableSelectionCallbacks = true;  // prevent unnecessary widget updates, they will be done in the end in a single step
-
-	QDir mapRootDir = mapModel.rootDirectory();
-
+	// Looking up the files in the mapModel or on a network drive would block the GUI, so the map packs are first
+	// checked in the background and selected in selectCheckedMapPacks() when all the results come back.
+	// Until then the preset keeps its list, the view is cleared without notifying the callbacks
+	// and forEachSelectedMapPack() gives the preset's list instead of the view selection.
+	disableSelectionCallbacks = true;
 	wdg::deselectAllAndUnsetCurrent( ui->mapDirView );
-
-	const QStringVec mapPacksCopy = preset.selectedMapPacks;
-	preset.selectedMapPacks.clear();  // clear the list in the preset and let it repopulate only with valid items
-	for (const QString & path : mapPacksCopy)
-	{
-		QModelIndex mapIdx = mapModel.index( path );
-		if (mapIdx.isValid() && fs::isInsideDir( path, mapRootDir ))
-		{
-			if (fs::isValidEntry( path ))
-			{
-				preset.selectedMapPacks.append( path );  // put back only items that are valid
-				wdg::selectAndSetCurrentByIndex( ui->mapDirView, mapIdx );
-				wdg::scrollToItemAtIndex( ui->mapDirView, mapIdx );
-			}
-			else
-			{
-				reportUserError( this, "Map file no longer exists",
-					"Map file selected for this preset ("%path%") no longer exists."
-				);
-			}
-		}
-		else
-		{
-			reportUserError( this, "Map file no longer exists",
-				"Map file selected for this preset ("%path%") couldn't be found in the map directory ("%mapRootDir.path()%")."
-			);
-		}
-	}
-
 	disableSelectionCallbacks = false;
-	auto newSelection = ui->mapDirView->selectionModel()->selection();
 
-	// manually notify our class about the change, so that the preset and dependent widgets get updated
-	if (newSelection != origSelection)
+	checkedMapPacks = preset.selectedMapPacks;
+	mapPackStatuses = QVector< fs::PathStatus >( checkedMapPacks.size() );
+	receivedMapPackStatuses = 0;
+	mapPackCheckPending = true;
+	mapPackCheckBatchID = pathChecker.checkAsync( checkedMapPacks );
+
+	if (checkedMapPacks.isEmpty())  // there will be no results
 	{
-		onMapPackToggled( newSelection, QItemSelection()/*TODO*/ );
+		selectCheckedMapPacks( preset );
 	}
 }
 
@@ -3589,20 +4091,142 @@ void MainWindow::restoreSelectedMods( Preset & preset )
 {
 	wdg::deselectAllAndUnsetCurrent( ui->modListView );  // this actually doesn't call a toggle callback, because the list is checkbox-based
 
+	// Checking hundreds of mods on a network drive one by one would freeze the window for seconds,
+	// so the list is shown immediately and the missing mods are highlighted when the results come back.
+	QStringVec modPaths;
+	modPaths.reserve( preset.mods.size() );
+
 	modModel.startCompleteUpdate();
 	modModel.clear();
 	for (Mod & mod : preset.mods)
 	{
+		bool isFile = !mod.isSeparator && !mod.isCmdArg;
+		if (isFile && mod.iconKey.isEmpty())
+		{
+			// a guess that doesn't touch the file-system, it will be corrected in onModsChecked()
+			QFileInfo modInfo( mod.path );
+			mod.iconKey = Mod::makeIconKey( modInfo, /*isDir*/modInfo.suffix().isEmpty() );
+		}
+
 		modModel.append( mod );
-		if ((!mod.isSeparator && !mod.isCmdArg) && !fs::isValidEntry( mod.path ))
+		modPaths.append( isFile ? mod.path : QString() );
+	}
+	modModel.finishCompleteUpdate();
+
+	checkedModPaths = modPaths;
+	modCheckBatchID = pathChecker.checkAsync( modPaths );
+}
+
+void MainWindow::onPathsChecked( int batchID, int firstIdx, const QVector< fs::PathStatus > & statuses )
+{
+	// results of older batches belong to presets that are no longer displayed
+	if (batchID == modCheckBatchID)
+		onModsChecked( firstIdx, statuses );
+	else if (batchID == mapPackCheckBatchID)
+		onMapPacksChecked( firstIdx, statuses );
+}
+
+void MainWindow::onModsChecked( int firstIdx, const QVector< fs::PathStatus > & statuses )
+{
+	// The user could have modified the list in the meantime, results of the rows that have moved are dropped.
+	int endIdx = std::min( firstIdx + int( statuses.size() ), int( modModel.count() ) );
+	for (int modIdx = firstIdx; modIdx < endIdx; ++modIdx)
+	{
+		Mod & mod = modModel[ modIdx ];
+		if (mod.isSeparator || mod.isCmdArg || mod.path != checkedModPaths[ modIdx ])
+			continue;
+
+		const fs::PathStatus & status = statuses[ modIdx - firstIdx ];
+		mod.iconKey = Mod::makeIconKey( QFileInfo( mod.path ), status.isDir );
+		if (!status.exists)
 		{
 			// Let's just highlight it now, we will show warning when the user tries to launch it.
 			//reportUserError( this, "Mod no longer exists",
 			//	"A mod file \""%mod.path%"\" from this preset no longer exists. Please update it." );
-			highlightInvalidListItem( modModel.last() );
+			highlightInvalidListItem( mod );
 		}
 	}
-	modModel.finishCompleteUpdate();
+
+	modModel.appearanceChanged( firstIdx, endIdx );
+}
+
+void MainWindow::onMapPacksChecked( int firstIdx, const QVector< fs::PathStatus > & statuses )
+{
+	for (int i = 0; i < statuses.size() && firstIdx + i < mapPackStatuses.size(); ++i)
+		mapPackStatuses[ firstIdx + i ] = statuses[i];
+	receivedMapPackStatuses += int( statuses.size() );
+
+	if (receivedMapPackStatuses < mapPackStatuses.size())
+		return;  // wait for the rest, so that the selection is changed in a single step
+
+	if (Preset * selectedPreset = getSelectedPreset())
+		selectCheckedMapPacks( *selectedPreset );
+	else
+		mapPackCheckPending = launchAfterMapPackCheck = false;
+}
+
+void MainWindow::selectCheckedMapPacks( Preset & preset )
+{
+	mapPackCheckPending = false;  // from now on the view selection is valid
+
+	disableSelectionCallbacks = true;  // prevent unnecessary widget updates, they will be done in the end in a single step
+
+	QDir mapRootDir = mapModel.rootDirectory();
+
+	wdg::deselectAllAndUnsetCurrent( ui->mapDirView );
+
+	preset.selectedMapPacks.clear();  // clear the list in the preset and let it repopulate only with valid items
+	for (int i = 0; i < checkedMapPacks.size(); ++i)
+	{
+		const QString & path = checkedMapPacks[i];
+		if (!mapPackStatuses[i].exists)
+		{
+			reportUserError( this, "Map file no longer exists",
+				"Map file selected for this preset ("%path%") no longer exists."
+			);
+			continue;
+		}
+
+		// the file exists, so this is only a look-up in the already populated model
+		QModelIndex mapIdx = fs::isInsideDir( path, mapRootDir ) ? mapModel.index( path ) : QModelIndex();
+		if (mapIdx.isValid())
+		{
+			preset.selectedMapPacks.append( path );
+			wdg::selectAndSetCurrentByIndex( ui->mapDirView, mapIdx );
+			wdg::scrollToItemAtIndex( ui->mapDirView, mapIdx );
+		}
+		else
+		{
+			reportUserError( this, "Map file no longer exists",
+				"Map file selected for this preset ("%path%") couldn't be found in the map directory ("%mapRootDir.path()%")."
+			);
+		}
+	}
+
+	disableSelectionCallbacks = false;
+
+	// Manually notify our class about the change, so that the dependent widgets get updated.
+	// Always, because the view was cleared silently in restoreSelectedMapPacks() and the widgets still show the previous state.
+	// This is still a part of restoring the preset, so the starting map of the map pack must not overwrite
+	// the stored launch options, and the preset's map packs have already been updated above.
+	bool wasRestoringPreset = restoringPresetInProgress;
+	restoringPresetInProgress = true;
+	onMapPackToggled( ui->mapDirView->selectionModel()->selection(), QItemSelection()/*TODO*/ );
+	restoringPresetInProgress = wasRestoringPreset;
+
+	// The maps of the map packs are listed only now, so the stored map names might not have been found before.
+	const LaunchOptions & launchOpts = activeLaunchOptions();
+	disableSelectionCallbacks = true;
+	if (int mapIdx = ui->mapCmbBox->findText( launchOpts.mapName ); mapIdx >= 0)
+		ui->mapCmbBox->setCurrentIndex( mapIdx );
+	if (int mapIdx = ui->mapCmbBox_demo->findText( launchOpts.mapName_demo ); mapIdx >= 0)
+		ui->mapCmbBox_demo->setCurrentIndex( mapIdx );
+	disableSelectionCallbacks = false;
+
+	updateLaunchCommand();
+
+	if (std::exchange( launchAfterMapPackCheck, false ))  // requested from the command line
+		launch();
 }
 
 void MainWindow::restoreLaunchAndMultOptions( LaunchOptions & launchOpts, const MultiplayerOptions & multOpts )
@@ -3870,7 +4494,7 @@ void MainWindow::updateLaunchCommand()
 		return;
 
 	//static uint callCnt = 1;
-	//logDebug() << "updateLaunchCommand() " << callCnt++;
+	//LOG_DEBUG() << "updateLaunchCommand() " << callCnt++;
 
 	const EngineInfo * selectedEngine = getSelectedEngine();
 	if (!selectedEngine)
@@ -3879,6 +4503,8 @@ void MainWindow::updateLaunchCommand()
 		return;  // no sense to generate a command when we don't even know the engine
 	}
 
+	g_launchCommandUpdates.increment();
+
 	QString currentCommand = ui->commandLine->text();
 
 	QString engineDir = fs::getDirOfFile( selectedEngine->executablePath );
@@ -3899,7 +4525,7 @@ void MainWindow::updateLaunchCommand()
 	if (newCommand != currentCommand)
 	{
 		//static int updateCnt = 1;
-		//logDebug() << "    updating " << updateCnt++;
+		//LOG_DEBUG() << "    updating " << updateCnt++;
 		ui->commandLine->setText( newCommand );
 	}
 }
@@ -3916,11 +4542,16 @@ void MainWindow::updateLaunchCommand()
   *                   Required for displaying the command or saving it to a script file.
   * \param verifyPaths Verify that each path in the command is valid and leads to the correct entry type (file or directory).
   *                    If invalid path is found, display a message box with an error description.
+  * \param engineOverride Engine to generate the command for instead of the selected one.
+  *                       The config, compat level and game options are used only if they apply to this engine.
+  * \param timedemoPath If not empty, the selected launch mode and multiplayer are replaced with -timedemo of this demo.
   */
 os::ShellCommand MainWindow::generateLaunchCommand(
 	const QString & parentWorkingDir, PathStyle enginePathStyle, const QString & engineWorkingDir, PathStyle argPathStyle,
-	bool quotePaths, bool verifyPaths
+	bool quotePaths, bool verifyPaths, const EngineInfo * engineOverride, const QString & timedemoPath
 ){
+	TRACE_ZONE("MainWindow::generateLaunchCommand");
+
 	os::ShellCommand cmd;
 
 	// The stored engine path is relative to DoomRunner's directory, but we need it relative to parentWorkingDir.
@@ -3932,7 +4563,7 @@ os::ShellCommand MainWindow::generateLaunchCommand(
 
 	//-- engine --------------------------------------------------------------------
 
-	const EngineInfo * selectedEngine = getSelectedEngine();
+	const EngineInfo * selectedEngine = engineOverride ? engineOverride : getSelectedEngine();
 	if (!selectedEngine)
 	{
 		return {};  // no point in generating a command if we don't even know the engine, it determines everything
@@ -3940,6 +4571,12 @@ os::ShellCommand MainWindow::generateLaunchCommand(
 
 	const EngineInfo & engine = *selectedEngine;  // non-const so that we can change color of invalid paths
 
+	// The config list, compat levels and game options in the UI were set up for the selected engine,
+	// they may mean something else or nothing at all to an overriding engine of a different family.
+	const EngineInfo * uiEngine = getSelectedEngine();
+	bool isOverridden = engineOverride && engineOverride != uiEngine;
+	bool uiOptionsApply = !isOverridden || (uiEngine && uiEngine->family == engine.family);
+
 	{
 		p.checkItemFilePath( engine, "the selected engine", "Please update its path in Menu -> Initial Setup, or select another one." );
 
@@ -3951,11 +4588,21 @@ os::ShellCommand MainWindow::generateLaunchCommand(
 
 	if (const ConfigFile * selectedConfig = getSelectedConfig())
 	{
-		// at this point the configDir cannot be empty, otherwise the configCmbBox would be empty and there would not be any selected config
-		QString configPath = fs::getPathFromFileName( engine.configDir, selectedConfig->fileName );
+		if (!isOverridden)
+		{
+			// at this point the configDir cannot be empty, otherwise the configCmbBox would be empty and there would not be any selected config
+			QString configPath = fs::getPathFromFileName( engine.configDir, selectedConfig->fileName );
 
-		p.checkFilePath( configPath, "the selected config", "Please update the config dir in Menu -> Initial Setup, or select another one." );
-		cmd.arguments << "-config" << engineDirRebaser.rebaseAndQuotePath( configPath );
+			p.checkFilePath( configPath, "the selected config", "Please update the config dir in Menu -> Initial Setup, or select another one." );
+			cmd.arguments << "-config" << engineDirRebaser.rebaseAndQuotePath( configPath );
+		}
+		else if (!engine.configDir.isEmpty())
+		{
+			// use the config of the same name if the overriding engine has one, otherwise let it use its default one
+			QString configPath = fs::getPathFromFileName( engine.configDir, selectedConfig->fileName );
+			if (fs::isValidFile( configPath ))
+				cmd.arguments << "-config" << engineDirRebaser.rebaseAndQuotePath( configPath );
+		}
 	}
 
 	//-- game data files -----------------------------------------------------------
@@ -4057,7 +4704,12 @@ os::ShellCommand MainWindow::generateLaunchCommand(
 	// -loadgame might need to be relative to -savedir, depending on the engine and its version
 
 	LaunchMode launchMode = getLaunchModeFromUI();
-	if (launchMode == LaunchMap)
+	if (!timedemoPath.isEmpty())
+	{
+		p.checkFilePath( timedemoPath, "the benchmarked demo", {} );
+		cmd.arguments << "-timedemo" << engineDirRebaser.rebaseAndQuotePath( timedemoPath );
+	}
+	else if (launchMode == LaunchMap)
 	{
 		cmd.arguments << engine.getMapArgs( ui->mapCmbBox->currentIndex(), ui->mapCmbBox->currentText() );
 	}
@@ -4094,22 +4746,22 @@ os::ShellCommand MainWindow::generateLaunchCommand(
 		cmd.arguments << "-fast";
 	if (ui->monstersRespawnChkBox->isEnabled() && ui->monstersRespawnChkBox->isChecked())
 		cmd.arguments << "-respawn";
-	if (ui->gameOptsBtn->isEnabled() && activeGameOpts.dmflags1 != 0)
+	if (uiOptionsApply && ui->gameOptsBtn->isEnabled() && activeGameOpts.dmflags1 != 0)
 		cmd.arguments << "+dmflags" << QString::number( activeGameOpts.dmflags1 );
-	if (ui->gameOptsBtn->isEnabled() && activeGameOpts.dmflags2 != 0)
+	if (uiOptionsApply && ui->gameOptsBtn->isEnabled() && activeGameOpts.dmflags2 != 0)
 		cmd.arguments << "+dmflags2" << QString::number( activeGameOpts.dmflags2 );
 
 	const CompatibilityOptions & activeCompatOpts = activeCompatOptions();
-	if (ui->compatLevelCmbBox->isEnabled() && activeCompatOpts.compatLevel >= 0)
+	if (uiOptionsApply && ui->compatLevelCmbBox->isEnabled() && activeCompatOpts.compatLevel >= 0)
 		cmd.arguments << engine.getCompatLevelArgs( activeCompatOpts.compatLevel );
-	if (ui->compatOptsBtn->isEnabled() && !compatOptsCmdArgs.isEmpty())
+	if (uiOptionsApply && ui->compatOptsBtn->isEnabled() && !compatOptsCmdArgs.isEmpty())
 		cmd.arguments << compatOptsCmdArgs;
 	if (ui->allowCheatsChkBox->isChecked())
 		cmd.arguments << "+sv_cheats" << "1";
 
 	//-- multiplayer options -------------------------------------------------------
 
-	if (ui->multiplayerGrpBox->isChecked())
+	if (ui->multiplayerGrpBox->isChecked() && timedemoPath.isEmpty())
 	{
 		switch (ui->multRoleCmbBox->currentIndex())
 		{
@@ -4155,8 +4807,9 @@ os::ShellCommand MainWindow::generateLaunchCommand(
 	//-- output options ------------------------------------------------------------
 
 	// On Windows ZDoom doesn't log its output to stdout by default.
-	// Force it to do so, so that our ProcessOutputWindow displays something.
-	if (settings.showEngineOutput && engine.needsStdoutParam())
+	// Force it to do so, so that our ProcessOutputWindow and the output logs contain something.
+	// The demo benchmark reads the timings from the output too.
+	if ((settings.showEngineOutput || settings.logEngineOutput || !timedemoPath.isEmpty()) && engine.needsStdoutParam())
 		cmd.arguments << "-stdout";
 
 	// video options
@@ -4216,7 +4869,8 @@ int MainWindow::askForExtraPermissions( const EngineInfo & selectedEngine, const
 }
 
 bool MainWindow::startDetached(
-	const QString & executable, const QStringVec & arguments, const QString & workingDir, const EnvVars & envVars
+	const QString & executable, const QStringVec & arguments, const QString & workingDir, const EnvVars & envVars,
+	const QString & outputLogPath
 ){
 	QString executableName = fs::getFileNameFromPath( executable );
 
@@ -4233,6 +4887,14 @@ bool MainWindow::startDetached(
 	}
 	process.setProcessEnvironment(env);
 
+	if (!outputLogPath.isEmpty())
+	{
+		// The detached process outlives the launcher, so nobody could read a pipe from it.
+		// Let the OS write the output directly into the file, in append mode so that stdout and stderr don't overwrite each other.
+		process.setStandardOutputFile( outputLogPath, QIODevice::Append );
+		process.setStandardErrorFile( outputLogPath, QIODevice::Append );
+	}
+
 	bool success = process.startDetached();
 	if (!success)
 	{
@@ -4242,6 +4904,31 @@ bool MainWindow::startDetached(
 	return success;
 }
 
+void MainWindow::addSessionToHistory(
+	Preset & preset, const EngineInfo & engine, qint64 startTime,
+	const os::ProcessResourceSummary & summary, const StartupProfile & startupProfile
+){
+	PlaySession session;
+	session.startTime = startTime;
+	session.engineName = engine.name;
+	session.duration_ms = summary.duration_ms;
+	session.peakRss_bytes = summary.peakRss_bytes;
+	session.avgCpuPercent = summary.avgCpuPercent;
+	session.totalReadBytes = summary.totalReadBytes;
+	session.peakThreadCount = summary.peakThreadCount;
+	session.startup = startupProfile;
+
+	LOG_INFO() << "session of preset " << preset.name << ": " << session.duration_ms / 1000 << " s, "
+	          << "peak RSS " << session.peakRss_bytes / (1024 * 1024) << " MB, avg CPU " << session.avgCpuPercent << " %, "
+	          << "start-up " << session.startup.duration_ms << " ms";
+
+	preset.history.append( std::move(session) );
+	while (preset.history.size() > Preset::maxHistoryLength)
+		preset.history.removeFirst();
+
+	scheduleSavingOptions();
+}
+
 void MainWindow::launch()
 {
 	const EngineInfo * selectedEngine = getSelectedEngine();
@@ -4267,7 +4954,7 @@ void MainWindow::launch()
 		return;  // errors are already shown during the generation
 	}
 
-	logDebug().quote() << cmd.executable << ' ' << cmd.arguments;
+	LOG_DEBUG().quote() << cmd.executable << ' ' << cmd.arguments;
 
 	// If extra permissions are needed to run the engine inside its sandbox environment, better ask the user.
 	if (settings.askForSandboxPermissions && !cmd.extraPermissions.isEmpty())
@@ -4301,12 +4988,31 @@ void MainWindow::launch()
 	if (settings.showEngineOutput)
 	{
 		ProcessOutputWindow processWindow( this );
+		if (settings.logEngineOutput)
+			processWindow.startOutputLog( selectedEngine->name );
+		if (settings.monitorEngineResources)
+			processWindow.enableResourceMonitoring( settings.resourceSamplingPeriod_ms );
+		if (settings.profileEngineStartup)
+			processWindow.enableStartupProfiling( selectedEngine->family );
+
+		qint64 startTime = QDateTime::currentSecsSinceEpoch();
 		processWindow.runProcess( cmd.executable, cmd.arguments, processWorkingDir, envVars );
+
+		// remember how demanding this preset is and how long it takes to start, so that users can compare it with others
+		os::ProcessResourceSummary summary = processWindow.resourceSummary();
+		const StartupProfile & startupProfile = processWindow.startupProfile();
+		Preset * selectedPreset = getSelectedPreset();
+		if ((summary.sampleCount > 0 || !startupProfile.isEmpty()) && selectedPreset)
+		{
+			addSessionToHistory( *selectedPreset, *selectedEngine, startTime, summary, startupProfile );
+		}
 		//int resultCode = processWindow.result();
 	}
 	else
 	{
-		bool success = startDetached( cmd.executable, cmd.arguments, processWorkingDir, envVars );
+		QString outputLogPath = settings.logEngineOutput ? EngineOutputLog::newLogFilePath( selectedEngine->name ) : QString();
+
+		bool success = startDetached( cmd.executable, cmd.arguments, processWorkingDir, envVars, outputLogPath );
 
 		if (success && settings.closeOnLaunch)
 		{
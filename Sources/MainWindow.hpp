@@ -15,18 +15,30 @@
 #include "Widgets/SearchPanel.hpp"
 #include "UserData.hpp"
 #include "UpdateChecker.hpp"
+#include "SingleInstance.hpp"  // StartupArgs
 #include "Themes.hpp"  // SystemThemeWatcher
+#include "Utils/ExeProber.hpp"
+#include "Utils/PathChecker.hpp"
+#include "Utils/StageProfiler.hpp"
+#include "Utils/StallWatchdog.hpp"
+#include "Utils/TaskScheduler.hpp"
+#include "Utils/Metrics.hpp"
+#include "Utils/ProcessMonitor.hpp"  // ProcessResourceSummary
+#include "OptionsSerializer.hpp"  // OptionsWriter, PreloadedOptions
 
 #include <QMainWindow>
 #include <QString>
 #include <QFileInfo>
 #include <QFileSystemModel>
+#include <QJsonDocument>
+
+#include <memory>
+#include <vector>
 
 class QTableWidget;
 class QItemSelection;
 class QComboBox;
 class QLineEdit;
-class OptionsToLoad;
 
 namespace Ui {
 	class MainWindow;
@@ -44,9 +56,16 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 
  public:
 
-	explicit MainWindow();
+	/** \param profileStartup Log how long the individual stages of the start-up take. */
+	explicit MainWindow( bool profileStartup = false );
 	virtual ~MainWindow() override;
 
+ public slots:
+
+	/// Performs actions requested via command line of this process or another instance of this application.
+	/** If the options are not loaded yet, the actions are postponed until they are. */
+	void executeStartupArgs( const StartupArgs & args );
+
  private: // overridden methods
 
 	virtual void showEvent( QShowEvent * event ) override;
@@ -56,12 +75,19 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
  private slots:
 
 	void onWindowShown();
+	void onStartupFilesPreloaded();
+	void finishStartup();
 
 	void runAboutDialog();
 	void runSetupDialog();
 	void runOptsStorageDialog();
 	void runGameOptsDialog();
 	void runCompatOptsDialog();
+	void runDemoBenchmarkDialog();
+	void runStartupProfileDialog();
+	void runGuiStallsDialog();
+	void runDiagnosticsDialog();
+	void togglePerformanceTrace( bool enabled );
 
 	void onEngineSelected( int index );
 	void onConfigSelected( int index );
@@ -75,6 +101,9 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 
 	void onMapDirUpdated( const QString & path );
 
+	void onEngineProbed( const QString & executablePath, qint64 lastModified, const os::UncertainExeVersionInfo & exeInfo );
+	void onPathsChecked( int batchID, int firstIdx, const QVector< fs::PathStatus > & statuses );
+
 	void openEngineDataDir();
 	void cloneConfig();
 
@@ -90,6 +119,7 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 
 	void modAdd();
 	void modAddDir();
+	void modAddDirContent();
 	void modAddArg();
 	void modDelete();
 	void modMoveUp();
@@ -171,6 +201,8 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 
 	void setupEnvVarLists();
 
+	void registerDiagnostics();
+
 	void updateOptionsGrpBoxTitles( const StorageSettings & storageSettings );
 
 	void loadMonitorInfo( QComboBox * box );
@@ -178,6 +210,7 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 	void togglePathStyle( PathStyle style );
 
 	void fillDerivedEngineInfo( DirectList< EngineInfo > & engines );
+	void probeUnknownEngines();
 
 	void autoselectItems();
 
@@ -200,12 +233,13 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 	void toggleSkillSubwidgets( bool enabled );
 	void toggleOptionsSubwidgets( bool enabled );
 
-	bool saveOptions( const QString & filePath );
-	bool loadOptions( const QString & filePath );
+	void saveOptions( const QString & filePath );
+	void reportOptionsWriteError();
+	bool loadOptions( PreloadedOptions && preloadedOptions );
 
 	bool isCacheDirty() const;
 	bool saveCache( const QString & filePath );
-	bool loadCache( const QString & filePath );
+	bool loadCache( const QString & filePath, const QJsonDocument & preloadedDoc );
 
 	void restoreLoadedOptions( OptionsToLoad && opts );
 	void restorePreset( int index );
@@ -215,6 +249,10 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 	void restoreSelectedIWAD( Preset & preset );
 	void restoreSelectedMapPacks( Preset & preset );
 	void restoreSelectedMods( Preset & preset );
+	void onModsChecked( int firstIdx, const QVector< fs::PathStatus > & statuses );
+	void onMapPacksChecked( int firstIdx, const QVector< fs::PathStatus > & statuses );
+	void selectCheckedMapPacks( Preset & preset );
+	void appendMods( QList< Mod > && mods );
 
 	void restoreLaunchAndMultOptions( LaunchOptions & launchOpts, const MultiplayerOptions & multOpts );
 	void restoreGameplayOptions( const GameplayOptions & opts );
@@ -229,12 +267,17 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 	void updateLaunchCommand();
 	os::ShellCommand generateLaunchCommand(
 		const QString & parentWorkingDir, PathStyle enginePathStyle, const QString & engineWorkingDir, PathStyle argPathStyle,
-		bool quotePaths, bool verifyPaths
+		bool quotePaths, bool verifyPaths, const EngineInfo * engineOverride = nullptr, const QString & timedemoPath = {}
 	);
 
 	int askForExtraPermissions( const EngineInfo & selectedEngine, const QStringVec & permissions );
+	void addSessionToHistory(
+		Preset & preset, const EngineInfo & engine, qint64 startTime,
+		const os::ProcessResourceSummary & summary, const StartupProfile & startupProfile
+	);
 	bool startDetached(
-		const QString & executable, const QStringVec & arguments, const QString & workingDir = {}, const EnvVars & envVars = {}
+		const QString & executable, const QStringVec & arguments, const QString & workingDir = {}, const EnvVars & envVars = {},
+		const QString & outputLogPath = {}
 	);
 
  private: // MainWindow-specific utils
@@ -280,6 +323,7 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 	SearchPanel * presetSearchPanel = nullptr;
 
 	QAction * addCmdArgAction = nullptr;
+	QAction * addDirContentAction = nullptr;
 
 	uint tickCount = 0;
 
@@ -289,6 +333,28 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 
 	bool optionsNeedUpdate = false;  ///< indicates that the user has made a change and the options file needs to be updated
 	bool optionsCorrupted = false;   ///< true if there was a critical error during parsing of the options file, such content should not be saved
+	OptionsWriter optionsWriter;     ///< writes the options file in a background thread
+
+	bool startupFinished = false;  ///< indicates that the options are loaded and the window is ready for user actions
+	QList< StartupArgs > pendingStartupArgs;  ///< command line actions that arrived before the startup was finished
+	bool launchAfterMapPackCheck = false;  ///< --launch arrived while the map packs of the preset were being checked
+
+	/// User data files read and parsed in background threads during the startup.
+	/** Each task writes only its own members, they are read only after all of the tasks have finished. */
+	struct PreloadedFiles
+	{
+		QJsonDocument cache;
+		QString cacheError;
+		qint64 cacheStart_ms = 0;
+		qint64 cacheEnd_ms = 0;
+
+		PreloadedOptions options;
+		qint64 optionsStart_ms = 0;
+		qint64 optionsEnd_ms = 0;
+	};
+	PreloadedFiles preloaded;
+	tasks::TaskGroup startupTasks;  ///< the files are read in parallel
+	StageProfiler startupProfiler { "Startup" };  ///< enabled by the --profile-startup command line option
 
 	bool disableSelectionCallbacks = false;   ///< flag that temporarily disables callbacks like selectEngine(), selectConfig(), selectIWAD()
 	bool disableEnvVarsCallbacks = false;     ///< flag that temporarily disables environment variable callbacks when the list is manually messed with
@@ -307,8 +373,23 @@ class MainWindow : public QMainWindow, private DialogWithPaths {
 
  #if IS_WINDOWS
 	SystemThemeWatcher systemThemeWatcher;
+ #else
+	os::ExeProber engineProber;  ///< executables on Linux don't have version info, we have to ask them
  #endif
 
+	fs::PathChecker pathChecker;  ///< checking files one by one on a network drive would block the GUI
+	int modCheckBatchID = 0;      ///< results of other batches than the latest one are ignored
+	int mapPackCheckBatchID = 0;
+	QStringVec checkedModPaths;   ///< paths in the order they were given to the checker, to match the results
+	QStringVec checkedMapPacks;
+	QVector< fs::PathStatus > mapPackStatuses;  ///< the map packs are selected only when all of them have been checked
+	int receivedMapPackStatuses = 0;
+	bool mapPackCheckPending = false;  ///< the view selection is not restored yet, checkedMapPacks are used instead of it
+
+	StallWatchdog stallWatchdog;  ///< finds out which synchronous operations make the window unresponsive
+
+	std::vector< std::unique_ptr< metrics::Gauge > > diagnosticGauges;  ///< values of this window shown in the Diagnostics dialog
+
  private: // user data
 
 	// We use model-view design pattern for several widgets, because it allows us to organize the data in a way we need,
@@ -10,10 +10,24 @@
 #include "CommonTypes.hpp"
 #include "Version.hpp"
 #include "Utils/JsonUtils.hpp"
+#include "Utils/JsonSchema.hpp"
 #include "Utils/MiscUtils.hpp"  // checkPath, highlightInvalidListItem
 #include "Utils/ErrorHandling.hpp"
+#include "Utils/FileSystemUtils.hpp"  // updateFileSafely
+#include "Utils/Tracing.hpp"
+#include "Utils/Metrics.hpp"
 
 #include <QFileInfo>
+#include <QFile>
+#include <QDataStream>
+#include <QJsonArray>
+#include <QSet>
+#include <QMap>
+#include <QUuid>
+#include <QMutexLocker>
+
+#include <algorithm>  // all_of
+#include <iterator>  // prev
 
 
 //======================================================================================================================
@@ -165,6 +179,90 @@ static void deserialize( const JsonObjectCtx & jsMod, Mod & mod )
 	}
 }
 
+static QJsonObject serialize( const StartupStep & step )
+{
+	QJsonObject jsStep;
+
+	jsStep["phase"] = step.phase;
+	if (!step.file.isEmpty())
+		jsStep["file"] = step.file;
+	jsStep["start_ms"] = step.start_ms;
+	jsStep["duration_ms"] = step.duration_ms;
+
+	return jsStep;
+}
+
+static void deserialize( const JsonObjectCtx & jsStep, StartupStep & step )
+{
+	step.phase = jsStep.getString( "phase" );
+	step.file = jsStep.getString( "file", {}, DontShowError );
+	step.start_ms = jsStep.getInt64( "start_ms", step.start_ms );
+	step.duration_ms = jsStep.getInt64( "duration_ms", step.duration_ms );
+}
+
+static QJsonObject serialize( const StartupProfile & profile )
+{
+	QJsonObject jsProfile;
+
+	jsProfile["duration_ms"] = profile.duration_ms;
+	jsProfile["steps"] = serializeList( profile.steps );
+
+	return jsProfile;
+}
+
+static void deserialize( const JsonObjectCtx & jsProfile, StartupProfile & profile )
+{
+	profile.duration_ms = jsProfile.getInt64( "duration_ms", profile.duration_ms );
+
+	if (JsonArrayCtx jsSteps = jsProfile.getArray( "steps" ))
+	{
+		// iterate manually, so that we can filter-out invalid items
+		for (int i = 0; i < jsSteps.size(); i++)
+		{
+			JsonObjectCtx jsStep = jsSteps.getObject( i );
+			if (!jsStep)  // wrong type on position i - skip this entry
+				continue;
+
+			StartupStep step;
+			deserialize( jsStep, step );
+			profile.steps.append( std::move( step ) );
+		}
+	}
+}
+
+template<> struct JsonSchema< PlaySession >
+{
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "avg_cpu_percent", &PlaySession::avgCpuPercent ),
+		jsonField( "duration_ms", &PlaySession::duration_ms ),
+		jsonField( "engine", &PlaySession::engineName ),
+		jsonField( "peak_rss_bytes", &PlaySession::peakRss_bytes ),
+		jsonField( "peak_thread_count", &PlaySession::peakThreadCount ),
+		jsonField( "start_time", &PlaySession::startTime ),
+		jsonField( "total_read_bytes", &PlaySession::totalReadBytes )
+	);
+};
+
+static QJsonObject serialize( const PlaySession & session )
+{
+	QJsonObject jsSession = serializeFields( session );
+
+	if (!session.startup.isEmpty())
+		jsSession["startup"] = serialize( session.startup );
+
+	return jsSession;
+}
+
+static void deserialize( const JsonObjectCtx & jsSession, PlaySession & session )
+{
+	deserializeFields( jsSession, session );
+
+	if (JsonObjectCtx jsStartup = jsSession.getObject( "startup", DontShowError ))
+	{
+		deserialize( jsStartup, session.startup );
+	}
+}
+
 static QJsonObject serialize( const EngineSettings & engineSettings )
 {
 	QJsonObject jsEngines;
@@ -229,168 +327,115 @@ static void deserialize( const JsonObjectCtx & jsMods, ModSettings & modSettings
 	modSettings.showIcons = jsMods.getBool( "show_icons", modSettings.showIcons, DontShowError );
 }
 
-static QJsonObject serialize( const LaunchOptions & opts )
-{
-	QJsonObject jsOptions;
-
-	jsOptions["launch_mode"] = int( opts.mode );
-	jsOptions["map_name"] = opts.mapName;
-	jsOptions["save_file"] = opts.saveFile;
-	jsOptions["map_name_demo"] = opts.mapName_demo;
-	jsOptions["demo_file_record"] = opts.demoFile_record;
-	jsOptions["demo_file_replay"] = opts.demoFile_replay;
-
-	return jsOptions;
-}
-
-static void deserialize( const JsonObjectCtx & jsOptions, LaunchOptions & opts )
-{
-	opts.mode = jsOptions.getEnum< LaunchMode >( "launch_mode", opts.mode );
-	opts.mapName = jsOptions.getString( "map_name" );
-	opts.saveFile = jsOptions.getString( "save_file" );
-	opts.mapName_demo = jsOptions.getString( "map_name_demo" );
-	opts.demoFile_record = jsOptions.getString( "demo_file_record" );
-	opts.demoFile_replay = jsOptions.getString( "demo_file_replay" );
-}
-
-static QJsonObject serialize( const MultiplayerOptions & opts )
-{
-	QJsonObject jsOptions;
-
-	jsOptions["is_multiplayer"] = opts.isMultiplayer;
-	jsOptions["mult_role"] = int( opts.multRole );
-	jsOptions["host_name"] = opts.hostName;
-	jsOptions["port"] = int( opts.port );
-	jsOptions["net_mode"] = int( opts.netMode );
-	jsOptions["game_mode"] = int( opts.gameMode );
-	jsOptions["player_count"] = int( opts.playerCount );
-	jsOptions["team_damage"] = opts.teamDamage;
-	jsOptions["time_limit"] = int( opts.timeLimit );
-	jsOptions["frag_limit"] = int( opts.fragLimit );
-
-	return jsOptions;
-}
-
-static void deserialize( const JsonObjectCtx & jsOptions, MultiplayerOptions & opts )
-{
-	opts.isMultiplayer = jsOptions.getBool( "is_multiplayer", opts.isMultiplayer );
-	opts.multRole = jsOptions.getEnum< MultRole >( "mult_role", opts.multRole );
-	opts.hostName = jsOptions.getString( "host_name" );
-	opts.port = jsOptions.getUInt16( "port", opts.port );
-	opts.netMode = jsOptions.getEnum< NetMode >( "net_mode", opts.netMode );
-	opts.gameMode = jsOptions.getEnum< GameMode >( "game_mode", opts.gameMode );
-	opts.playerCount = jsOptions.getUInt( "player_count", opts.playerCount );
-	opts.teamDamage = jsOptions.getDouble( "team_damage", opts.teamDamage );
-	opts.timeLimit = jsOptions.getUInt( "time_limit", opts.timeLimit );
-	opts.fragLimit = jsOptions.getUInt( "frag_limit", opts.fragLimit );
-}
-
-static QJsonObject serialize( const GameplayOptions & opts )
-{
-	QJsonObject jsOptions;
-
-	jsOptions["skill_idx"] = int( opts.skillIdx );
-	jsOptions["skill_num"] = int( opts.skillNum );
-	jsOptions["no_monsters"] = opts.noMonsters;
-	jsOptions["fast_monsters"] = opts.fastMonsters;
-	jsOptions["monsters_respawn"] = opts.monstersRespawn;
-	jsOptions["dmflags1"] = qint64( opts.dmflags1 );
-	jsOptions["dmflags2"] = qint64( opts.dmflags2 );
-	jsOptions["allow_cheats"] = opts.allowCheats;
-
-	return jsOptions;
-}
-
-static void deserialize( const JsonObjectCtx & jsOptions, GameplayOptions & opts )
-{
-	opts.skillIdx = jsOptions.getInt( "skill_idx", opts.skillIdx );
-	opts.skillNum = jsOptions.getInt( "skill_num", opts.skillNum );
-	opts.noMonsters = jsOptions.getBool( "no_monsters", opts.noMonsters );
-	opts.fastMonsters = jsOptions.getBool( "fast_monsters", opts.fastMonsters );
-	opts.monstersRespawn = jsOptions.getBool( "monsters_respawn", opts.monstersRespawn );
-	opts.dmflags1 = jsOptions.getInt( "dmflags1", opts.dmflags1 );
-	opts.dmflags2 = jsOptions.getInt( "dmflags2", opts.dmflags2 );
-	opts.allowCheats = jsOptions.getBool( "allow_cheats", opts.allowCheats );
-}
+// The following structs are serialized by the generic functions from JsonSchema.hpp,
+// only the fields and their keys are listed here. Keep them sorted by the keys.
 
-static QJsonObject serialize( const CompatibilityOptions & opts )
+template<> struct JsonSchema< LaunchOptions >
 {
-	QJsonObject jsOptions;
-
-	jsOptions["compat_level"] = opts.compatLevel;
-	jsOptions["compatflags1"] = qint64( opts.compatflags1 );
-	jsOptions["compatflags2"] = qint64( opts.compatflags2 );
-
-	return jsOptions;
-}
-
-static void deserialize( const JsonObjectCtx & jsOptions, CompatibilityOptions & opts )
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "demo_file_record", &LaunchOptions::demoFile_record ),
+		jsonField( "demo_file_replay", &LaunchOptions::demoFile_replay ),
+		jsonField( "launch_mode", &LaunchOptions::mode ),
+		jsonField( "map_name", &LaunchOptions::mapName ),
+		jsonField( "map_name_demo", &LaunchOptions::mapName_demo ),
+		jsonField( "save_file", &LaunchOptions::saveFile )
+	);
+};
+
+template<> struct JsonSchema< MultiplayerOptions >
 {
-	opts.compatflags1 = jsOptions.getInt( "compatflags1", opts.compatflags1 );
-	opts.compatflags2 = jsOptions.getInt( "compatflags2", opts.compatflags2 );
-	opts.compatLevel = jsOptions.getInt( "compat_level", opts.compatLevel );
-}
-
-static QJsonObject serialize( const AlternativePaths & opts )
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "frag_limit", &MultiplayerOptions::fragLimit ),
+		jsonField( "game_mode", &MultiplayerOptions::gameMode ),
+		jsonField( "host_name", &MultiplayerOptions::hostName ),
+		jsonField( "is_multiplayer", &MultiplayerOptions::isMultiplayer ),
+		jsonField( "mult_role", &MultiplayerOptions::multRole ),
+		jsonField( "net_mode", &MultiplayerOptions::netMode ),
+		jsonField( "player_count", &MultiplayerOptions::playerCount ),
+		jsonField( "port", &MultiplayerOptions::port ),
+		jsonField( "team_damage", &MultiplayerOptions::teamDamage ),
+		jsonField( "time_limit", &MultiplayerOptions::timeLimit )
+	);
+};
+
+template<> struct JsonSchema< GameplayOptions >
 {
-	QJsonObject jsOptions;
-
-	jsOptions["save_dir"] = opts.saveDir;
-	jsOptions["screenshot_dir"] = opts.screenshotDir;
-
-	return jsOptions;
-}
-
-static void deserialize( const JsonObjectCtx & jsOptions, AlternativePaths & opts )
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "allow_cheats", &GameplayOptions::allowCheats ),
+		jsonField( "dmflags1", &GameplayOptions::dmflags1 ),
+		jsonField( "dmflags2", &GameplayOptions::dmflags2 ),
+		jsonField( "fast_monsters", &GameplayOptions::fastMonsters ),
+		jsonField( "monsters_respawn", &GameplayOptions::monstersRespawn ),
+		jsonField( "no_monsters", &GameplayOptions::noMonsters ),
+		jsonField( "skill_idx", &GameplayOptions::skillIdx, Version(1,7) ),
+		jsonField( "skill_num", &GameplayOptions::skillNum )
+	);
+};
+
+template<> struct JsonSchema< CompatibilityOptions >
 {
-	opts.saveDir = jsOptions.getString( "save_dir" );
-	opts.screenshotDir = jsOptions.getString( "screenshot_dir" );
-}
-
-static QJsonObject serialize( const VideoOptions & opts )
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "compat_level", &CompatibilityOptions::compatLevel ),
+		jsonField( "compatflags1", &CompatibilityOptions::compatflags1 ),
+		jsonField( "compatflags2", &CompatibilityOptions::compatflags2 )
+	);
+};
+
+template<> struct JsonSchema< AlternativePaths >
 {
-	QJsonObject jsOptions;
-
-	jsOptions["monitor_idx"] = opts.monitorIdx;
-	jsOptions["resolution_x"] = qint64( opts.resolutionX );
-	jsOptions["resolution_y"] = qint64( opts.resolutionY );
-	jsOptions["show_fps"] = opts.showFPS;
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "save_dir", &AlternativePaths::saveDir ),
+		jsonField( "screenshot_dir", &AlternativePaths::screenshotDir )
+	);
+};
 
-	return jsOptions;
-}
-
-static void deserialize( const JsonObjectCtx & jsOptions, VideoOptions & opts )
+template<> struct JsonSchema< VideoOptions >
 {
-	opts.monitorIdx = jsOptions.getInt( "monitor_idx", opts.monitorIdx );
-	opts.resolutionX = jsOptions.getUInt( "resolution_x", opts.resolutionX );
-	opts.resolutionY = jsOptions.getUInt( "resolution_y", opts.resolutionY );
-	opts.showFPS = jsOptions.getBool( "show_fps", opts.showFPS );
-}
-
-static QJsonObject serialize( const AudioOptions & opts )
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "monitor_idx", &VideoOptions::monitorIdx ),
+		jsonField( "resolution_x", &VideoOptions::resolutionX ),
+		jsonField( "resolution_y", &VideoOptions::resolutionY ),
+		jsonField( "show_fps", &VideoOptions::showFPS )
+	);
+};
+
+template<> struct JsonSchema< AudioOptions >
 {
-	QJsonObject jsOptions;
-
-	jsOptions["no_sound"] = opts.noSound;
-	jsOptions["no_sfx"] = opts.noSFX;
-	jsOptions["no_music"] = opts.noMusic;
-
-	return jsOptions;
-}
-
-static void deserialize( const JsonObjectCtx & jsOptions, AudioOptions & opts )
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "no_music", &AudioOptions::noMusic ),
+		jsonField( "no_sfx", &AudioOptions::noSFX ),
+		jsonField( "no_sound", &AudioOptions::noSound )
+	);
+};
+
+static QJsonObject serialize( const LaunchOptions & opts )         { return serializeFields( opts ); }
+static QJsonObject serialize( const MultiplayerOptions & opts )    { return serializeFields( opts ); }
+static QJsonObject serialize( const GameplayOptions & opts )       { return serializeFields( opts ); }
+static QJsonObject serialize( const CompatibilityOptions & opts )  { return serializeFields( opts ); }
+static QJsonObject serialize( const AlternativePaths & opts )      { return serializeFields( opts ); }
+static QJsonObject serialize( const VideoOptions & opts )          { return serializeFields( opts ); }
+static QJsonObject serialize( const AudioOptions & opts )          { return serializeFields( opts ); }
+
+static void deserialize( const JsonObjectCtx & jsOptions, LaunchOptions & opts )         { deserializeFields( jsOptions, opts ); }
+static void deserialize( const JsonObjectCtx & jsOptions, MultiplayerOptions & opts )    { deserializeFields( jsOptions, opts ); }
+static void deserialize( const JsonObjectCtx & jsOptions, GameplayOptions & opts )       { deserializeFields( jsOptions, opts ); }
+static void deserialize( const JsonObjectCtx & jsOptions, CompatibilityOptions & opts )  { deserializeFields( jsOptions, opts ); }
+static void deserialize( const JsonObjectCtx & jsOptions, AlternativePaths & opts )      { deserializeFields( jsOptions, opts ); }
+static void deserialize( const JsonObjectCtx & jsOptions, VideoOptions & opts )          { deserializeFields( jsOptions, opts ); }
+static void deserialize( const JsonObjectCtx & jsOptions, AudioOptions & opts )          { deserializeFields( jsOptions, opts ); }
+
+template<> struct JsonSchema< GlobalOptions >
 {
-	opts.noSound = jsOptions.getBool( "no_sound", opts.noSound );
-	opts.noSFX = jsOptions.getBool( "no_sfx", opts.noSFX );
-	opts.noMusic = jsOptions.getBool( "no_music", opts.noMusic );
-}
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "additional_args", &GlobalOptions::cmdArgs ),
+		jsonField( "use_preset_name_as_dir", &GlobalOptions::usePresetNameAsDir, Version(1,8) )
+	);
+};
 
 static QJsonObject serialize( const GlobalOptions & opts )
 {
-	QJsonObject jsOptions;
+	QJsonObject jsOptions = serializeFields( opts );
 
-	jsOptions["use_preset_name_as_dir"] = opts.usePresetNameAsDir;
-	jsOptions["additional_args"] = opts.cmdArgs;
 	jsOptions["env_vars"] = serialize( opts.envVars );
 
 	return jsOptions;
@@ -398,29 +443,38 @@ static QJsonObject serialize( const GlobalOptions & opts )
 
 static void deserialize( const JsonObjectCtx & jsOptions, GlobalOptions & opts )
 {
-	opts.usePresetNameAsDir = jsOptions.getBool( "use_preset_name_as_dir", opts.usePresetNameAsDir, DontShowError );
-	opts.cmdArgs = jsOptions.getString( "additional_args" );
+	deserializeFields( jsOptions, opts );
+
 	if (JsonObjectCtx jsEnvVars = jsOptions.getObject( "env_vars" ))
 		deserialize( jsEnvVars, opts.envVars );
 }
 
-static QJsonObject serialize( const Preset & preset, const StorageSettings & settings )
+// only the simple fields, the rest depends on the storage settings
+template<> struct JsonSchema< Preset >
 {
-	QJsonObject jsPreset;
-
-	jsPreset["name"] = preset.name;
+	static constexpr auto fields = std::make_tuple(
+		jsonField( "additional_args", &Preset::cmdArgs ),
+		jsonField( "selected_IWAD", &Preset::selectedIWAD ),
+		jsonField( "selected_config", &Preset::selectedConfig ),
+		jsonField( "selected_engine", &Preset::selectedEnginePath )
+	);
+};
 
+static QJsonObject serialize( const Preset & preset, const StorageSettings & settings )
+{
 	if (preset.isSeparator)
 	{
-		jsPreset["separator"] = true;
-		return jsPreset;
+		QJsonObject jsSeparator;
+		jsSeparator["name"] = preset.name;
+		jsSeparator["separator"] = true;
+		return jsSeparator;
 	}
 
-	// files
+	// files and preset-specific args
+
+	QJsonObject jsPreset = serializeFields( preset );
 
-	jsPreset["selected_engine"] = preset.selectedEnginePath;
-	jsPreset["selected_config"] = preset.selectedConfig;
-	jsPreset["selected_IWAD"] = preset.selectedIWAD;
+	jsPreset["name"] = preset.name;
 
 	jsPreset["selected_mappacks"] = serializeStringVec( preset.selectedMapPacks );
 
@@ -448,11 +502,13 @@ static QJsonObject serialize( const Preset & preset, const StorageSettings & set
 
 	jsPreset["alternative_paths"] = serialize( preset.altPaths );
 
-	// preset-specific args
-
-	jsPreset["additional_args"] = preset.cmdArgs;
 	jsPreset["env_vars"] = serialize( preset.envVars );
 
+	// statistics
+
+	if (!preset.history.isEmpty())
+		jsPreset["history"] = serializeList( preset.history );
+
 	return jsPreset;
 }
 
@@ -466,11 +522,9 @@ static void deserialize( const JsonObjectCtx & jsPreset, Preset & preset, const
 		return;
 	}
 
-	// files
+	// files and preset-specific args
 
-	preset.selectedEnginePath = jsPreset.getString( "selected_engine" );
-	preset.selectedConfig = jsPreset.getString( "selected_config" );
-	preset.selectedIWAD = jsPreset.getString( "selected_IWAD" );
+	deserializeFields( jsPreset, preset );
 
 	if (JsonArrayCtx jsSelectedMapPacks = jsPreset.getArray( "selected_mappacks" ))
 	{
@@ -532,11 +586,24 @@ static void deserialize( const JsonObjectCtx & jsPreset, Preset & preset, const
 	if (JsonObjectCtx jsOptions = jsPreset.getObject( "alternative_paths" ))
 		deserialize( jsOptions, preset.altPaths );
 
-	// preset-specific args
-
-	preset.cmdArgs = jsPreset.getString( "additional_args" );
 	if (JsonObjectCtx jsEnvVars = jsPreset.getObject( "env_vars" ))
 		deserialize( jsEnvVars, preset.envVars );
+
+	// statistics
+
+	if (JsonArrayCtx jsHistory = jsPreset.getArray( "history", DontShowError ))
+	{
+		for (int i = 0; i < jsHistory.size(); i++)
+		{
+			JsonObjectCtx jsSession = jsHistory.getObject( i );
+			if (!jsSession)  // wrong type on position i - skip this entry
+				continue;
+
+			PlaySession session;
+			deserialize( jsSession, session );
+			preset.history.append( std::move( session ) );
+		}
+	}
 }
 
 static QJsonObject serialize( const WindowGeometry & geometry )
@@ -563,6 +630,11 @@ static void serialize( QJsonObject & jsSettings, const LauncherSettings & settin
 	jsSettings["use_absolute_paths"] = settings.pathStyle == PathStyle::Absolute;
 	jsSettings["show_engine_output"] = settings.showEngineOutput;
 	jsSettings["close_on_launch"] = settings.closeOnLaunch;
+	jsSettings["log_engine_output"] = settings.logEngineOutput;
+	jsSettings["monitor_engine_resources"] = settings.monitorEngineResources;
+	jsSettings["resource_sampling_period_ms"] = settings.resourceSamplingPeriod_ms;
+	jsSettings["profile_engine_startup"] = settings.profileEngineStartup;
+	jsSettings["binary_options_file"] = settings.binaryOptionsFile;
 	jsSettings["check_for_updates"] = settings.checkForUpdates;
 	jsSettings["ask_for_sandbox_permissions"] = settings.askForSandboxPermissions;
 
@@ -591,6 +663,11 @@ static void deserialize( const JsonObjectCtx & jsSettings, LauncherSettings & se
 
 	settings.showEngineOutput = jsSettings.getBool( "show_engine_output", settings.showEngineOutput, DontShowError );
 	settings.closeOnLaunch = jsSettings.getBool( "close_on_launch", settings.closeOnLaunch, DontShowError );
+	settings.logEngineOutput = jsSettings.getBool( "log_engine_output", settings.logEngineOutput, DontShowError );
+	settings.monitorEngineResources = jsSettings.getBool( "monitor_engine_resources", settings.monitorEngineResources, DontShowError );
+	settings.resourceSamplingPeriod_ms = jsSettings.getInt( "resource_sampling_period_ms", settings.resourceSamplingPeriod_ms, DontShowError );
+	settings.profileEngineStartup = jsSettings.getBool( "profile_engine_startup", settings.profileEngineStartup, DontShowError );
+	settings.binaryOptionsFile = jsSettings.getBool( "binary_options_file", settings.binaryOptionsFile, DontShowError );
 	settings.checkForUpdates = jsSettings.getBool( "check_for_updates", settings.checkForUpdates, DontShowError );
 	settings.askForSandboxPermissions = jsSettings.getBool( "ask_for_sandbox_permissions", settings.askForSandboxPermissions, DontShowError );
 
@@ -608,7 +685,19 @@ static void deserialize( const JsonObjectCtx & jsSettings, LauncherSettings & se
 //======================================================================================================================
 //  top-level JSON stucture
 
-static void serialize( QJsonObject & jsOpts, const OptionsToSave & opts )
+static QJsonObject serializePresetContent( const Preset & preset, const StorageSettings & settings )
+{
+	// a preset loaded from a binary file that has never been selected is still in its serialized form
+	if (!preset.isContentDecoded())
+		return QJsonDocument::fromJson( preset.encodedContent ).object();
+	else
+		return serialize( preset, settings );
+}
+
+constexpr bool WithPresets = true;
+constexpr bool WithoutPresets = false;
+
+static void serialize( QJsonObject & jsOpts, const OptionsToSave & opts, bool withPresets )
 {
 	// files and related settings
 
@@ -661,10 +750,14 @@ static void serialize( QJsonObject & jsOpts, const OptionsToSave & opts )
 	{
 		QJsonArray jsPresetArray;
 
-		for (const Preset & preset : opts.presets)
+		// the binary file stores the presets separately, but the array must exist to keep the JSON structure valid
+		if (withPresets)
 		{
-			QJsonObject jsPreset = serialize( preset, opts.settings );
-			jsPresetArray.append( jsPreset );
+			for (const Preset & preset : opts.presets)
+			{
+				QJsonObject jsPreset = serializePresetContent( preset, opts.settings );
+				jsPresetArray.append( jsPreset );
+			}
 		}
 
 		jsOpts["presets"] = jsPresetArray;
@@ -827,14 +920,14 @@ static void deserialize( const JsonObjectCtx & jsOpts, OptionsToLoad & opts )
 //======================================================================================================================
 //  JSON document and version handling
 
-static QJsonDocument serializeOptionsToJsonDoc( const OptionsToSave & opts )
+static QJsonDocument serializeOptionsToJsonDoc( const OptionsToSave & opts, bool withPresets = WithPresets )
 {
 	QJsonObject jsRoot;
 
 	// this will be used to detect options created by older versions and supress "missing element" warnings
 	jsRoot["version"] = appVersion;
 
-	serialize( jsRoot, opts );
+	serialize( jsRoot, opts, withPresets );
 
 	return QJsonDocument( jsRoot );
 }
@@ -847,6 +940,7 @@ static void deserializeOptionsFromJsonDoc( const JsonDocumentCtx & jsonDoc, Opti
 
 	QString optsVersionStr = jsRoot.getString( "version", {}, DontShowError );
 	Version optsVersion( optsVersionStr );
+	jsonDoc.setDataVersion( optsVersion );  // elements added after this version are not expected
 
 	if (!optsVersionStr.isEmpty() && optsVersion > appVersion)  // empty version means pre-1.4 version
 	{
@@ -874,6 +968,377 @@ static void deserializeOptionsFromJsonDoc( const JsonDocumentCtx & jsonDoc, Opti
 }
 
 
+//======================================================================================================================
+//  journal - small changes are appended to a separate file instead of rewriting the whole options file
+//
+//  Each line of the journal is one record in compact JSON, containing the top-level options and the presets
+//  that changed since the previous record. The records are tagged by the ID of the full snapshot they follow,
+//  so that records left behind by an interrupted compaction are never applied to a newer snapshot.
+//  An incomplete last line (the application was killed while writing it) ends the replay.
+
+static const char journalIDKey [] = "journal_id";
+
+static QString getJournalFilePath( const QString & optionsFilePath )
+{
+	return optionsFilePath + ".journal";
+}
+
+/// All the changes from the journal records merged together.
+struct OptionsJournal
+{
+	QJsonObject values;                ///< top-level options that changed, the latest value of each
+	QSet< QString > removedKeys;       ///< top-level options that are no longer stored
+	int presetCount = -1;              ///< new number of presets, -1 if there are no records
+	QMap< int, QJsonObject > presets;  ///< presets that changed, the latest version of each, by their index
+	int recordCount = 0;
+};
+
+static OptionsJournal readOptionsJournal( const QString & journalFilePath, const QString & snapshotID )
+{
+	OptionsJournal journal;
+
+	// no ID means the snapshot was written by a version without the journal
+	if (snapshotID.isEmpty() || !fs::isValidFile( journalFilePath ))
+	{
+		return journal;
+	}
+
+	QByteArray bytes;
+	QString readError = fs::readWholeFile( journalFilePath, bytes );
+	if (!readError.isEmpty())
+	{
+		::logRuntimeError("OptionsJournal") << readError;
+		return journal;
+	}
+
+	const QList< QByteArray > lines = bytes.split( '\n' );
+	for (const QByteArray & line : lines)
+	{
+		if (line.isEmpty())
+			continue;
+
+		QJsonDocument jsonDoc = QJsonDocument::fromJson( line );
+		if (!jsonDoc.isObject())
+		{
+			::logRuntimeError("OptionsJournal") << "record " << journal.recordCount << " is damaged, ignoring the rest";
+			break;
+		}
+		const QJsonObject jsRecord = jsonDoc.object();
+
+		if (jsRecord["snapshot"].toString() != snapshotID)
+			continue;  // left behind by a compaction that was interrupted before the journal was deleted
+
+		const QJsonArray jsRemovedKeys = jsRecord["removed"].toArray();
+		for (const QJsonValue & jsKey : jsRemovedKeys)
+		{
+			journal.values.remove( jsKey.toString() );
+			journal.removedKeys.insert( jsKey.toString() );
+		}
+
+		const QJsonObject jsValues = jsRecord["values"].toObject();
+		for (auto it = jsValues.constBegin(); it != jsValues.constEnd(); ++it)
+		{
+			journal.values[ it.key() ] = it.value();
+			journal.removedKeys.remove( it.key() );
+		}
+
+		journal.presetCount = jsRecord["preset_count"].toInt();
+		while (!journal.presets.isEmpty() && journal.presets.lastKey() >= journal.presetCount)
+			journal.presets.erase( std::prev( journal.presets.end() ) );
+
+		const QJsonObject jsPresets = jsRecord["presets"].toObject();
+		for (auto it = jsPresets.constBegin(); it != jsPresets.constEnd(); ++it)
+		{
+			int presetIdx = it.key().toInt();
+			if (presetIdx >= 0 && presetIdx < journal.presetCount)
+				journal.presets[ presetIdx ] = it.value().toObject();
+		}
+
+		journal.recordCount++;
+	}
+
+	return journal;
+}
+
+static void applyJournalValues( const OptionsJournal & journal, QJsonObject & jsRoot )
+{
+	for (const QString & key : journal.removedKeys)
+	{
+		jsRoot.remove( key );
+	}
+	for (auto it = journal.values.constBegin(); it != journal.values.constEnd(); ++it)
+	{
+		jsRoot[ it.key() ] = it.value();
+	}
+}
+
+static void applyJournalPresets( const OptionsJournal & journal, QJsonArray & jsPresetArray )
+{
+	if (journal.presetCount < 0)
+	{
+		return;
+	}
+
+	while (jsPresetArray.size() > journal.presetCount)
+		jsPresetArray.removeLast();
+	while (jsPresetArray.size() < journal.presetCount)
+		jsPresetArray.append( QJsonObject() );
+
+	for (auto it = journal.presets.constBegin(); it != journal.presets.constEnd(); ++it)
+	{
+		jsPresetArray[ it.key() ] = it.value();
+	}
+}
+
+static void applyJournalPresets( const OptionsJournal & journal, QList< Preset > & presets )
+{
+	if (journal.presetCount < 0)
+	{
+		return;
+	}
+
+	while (presets.size() > journal.presetCount)
+		presets.removeLast();
+	while (presets.size() < journal.presetCount)
+		presets.append( Preset() );
+
+	// keep them encoded, they will be decoded when selected, just like the presets from the snapshot
+	for (auto it = journal.presets.constBegin(); it != journal.presets.constEnd(); ++it)
+	{
+		Preset preset( it.value()["name"].toString() );
+		preset.isSeparator = it.value()["separator"].toBool();
+		if (!preset.isSeparator)
+			preset.encodedContent = QJsonDocument( it.value() ).toJson( QJsonDocument::Compact );
+
+		presets[ it.key() ] = std::move( preset );
+	}
+}
+
+
+//======================================================================================================================
+//  binary container - loads faster when there are many presets
+//
+//  The file consists of
+//    1. magic number and format version
+//    2. all the options except the presets, serialized into JSON exactly like in the JSON file
+//    3. table with the name, separator flag, offset and size of every preset
+//    4. contents of all the presets, each serialized into JSON exactly like in the JSON file
+//  Only parts 1-3 are parsed when the file is loaded, the preset contents are parsed when the user selects the preset.
+//  Because the contents use the same JSON schema, the options can be converted back to the JSON file at any time.
+
+static constexpr quint32 binaryOptionsMagic = 0x44524F50;  // "DROP"
+static constexpr quint16 binaryOptionsFormatVersion = 1;
+
+struct BinaryPresetEntry
+{
+	QString name;
+	bool isSeparator = false;
+	quint32 offset = 0;  ///< offset of the preset content from the beginning of the content block
+	quint32 size = 0;
+};
+
+static void initBinaryStream( QDataStream & stream )
+{
+	stream.setVersion( QDataStream::Qt_5_0 );  // older format is readable by all supported Qt versions
+}
+
+/// Serializes each preset into compact JSON separately, presets that have never been selected are already serialized.
+static QVector< QByteArray > serializePresetContents( const OptionsToSave & opts )
+{
+	QVector< QByteArray > presetContents;
+	presetContents.reserve( opts.presets.size() );
+
+	for (const Preset & preset : opts.presets)
+	{
+		if (!preset.isContentDecoded())
+			presetContents.append( preset.encodedContent );
+		else
+			presetContents.append( QJsonDocument( serialize( preset, opts.settings ) ).toJson( QJsonDocument::Compact ) );
+	}
+
+	return presetContents;
+}
+
+/// Builds the binary file from the options serialized without presets and the separately serialized presets.
+static QByteArray serializeOptionsToBinary(
+	const QJsonObject & jsHeader, const QList< Preset > & presets, const QVector< QByteArray > & presetContents
+){
+	QVector< BinaryPresetEntry > presetTable;
+	presetTable.reserve( presets.size() );
+	QByteArray presetBlock;
+
+	for (int i = 0; i < presets.size(); ++i)
+	{
+		BinaryPresetEntry entry;
+		entry.name = presets[i].name;
+		entry.isSeparator = presets[i].isSeparator;
+		entry.offset = quint32( presetBlock.size() );
+		if (!entry.isSeparator)  // everything is already in the table
+			presetBlock += presetContents[i];
+		entry.size = quint32( presetBlock.size() ) - entry.offset;
+
+		presetTable.append( std::move( entry ) );
+	}
+
+	QByteArray bytes;
+	QDataStream stream( &bytes, QIODevice::WriteOnly );
+	initBinaryStream( stream );
+
+	stream << binaryOptionsMagic << binaryOptionsFormatVersion;
+
+	stream << QJsonDocument( jsHeader ).toJson( QJsonDocument::Compact );
+
+	stream << quint32( presetTable.size() );
+	for (const BinaryPresetEntry & entry : presetTable)
+	{
+		stream << entry.name << entry.isSeparator << entry.offset << entry.size;
+	}
+
+	stream << presetBlock;
+
+	return bytes;
+}
+
+/// Builds the JSON file from the options serialized without presets and the separately serialized presets.
+static QByteArray serializeOptionsToJson( QJsonObject jsRoot, const QVector< QByteArray > & presetContents )
+{
+	QJsonArray jsPresetArray;
+	for (const QByteArray & presetContent : presetContents)
+	{
+		jsPresetArray.append( QJsonDocument::fromJson( presetContent ).object() );
+	}
+	jsRoot["presets"] = jsPresetArray;
+
+	return QJsonDocument( jsRoot ).toJson();
+}
+
+static bool isBinaryOptionsFile( const QString & filePath )
+{
+	QFile file( filePath );
+	if (!file.open( QIODevice::ReadOnly ))
+	{
+		return false;  // let the JSON reader report the error
+	}
+
+	QDataStream stream( &file );
+	initBinaryStream( stream );
+
+	quint32 magic = 0;
+	stream >> magic;
+	return stream.status() == QDataStream::Ok && magic == binaryOptionsMagic;
+}
+
+static void preloadBinaryOptionsFile( PreloadedOptions & preloaded )
+{
+	const QString & filePath = preloaded.filePath;
+
+	QByteArray bytes;
+	preloaded.error = fs::readWholeFile( filePath, bytes );
+	if (!preloaded.error.isEmpty())
+	{
+		return;
+	}
+
+	QDataStream stream( bytes );
+	initBinaryStream( stream );
+
+	quint32 magic = 0;
+	quint16 formatVersion = 0;
+	stream >> magic >> formatVersion;
+	if (formatVersion > binaryOptionsFormatVersion)
+	{
+		preloaded.error =
+			"\""%fs::getFileNameFromPath(filePath)%"\" was saved by a newer version of DoomRunner and can't be loaded. "
+			"Please update DoomRunner or delete the file and start from scratch.";
+		return;
+	}
+
+	QByteArray header;
+	stream >> header;
+
+	quint32 presetCount = 0;
+	stream >> presetCount;
+
+	QVector< BinaryPresetEntry > presetTable;
+	for (quint32 i = 0; i < presetCount && stream.status() == QDataStream::Ok; ++i)
+	{
+		BinaryPresetEntry entry;
+		stream >> entry.name >> entry.isSeparator >> entry.offset >> entry.size;
+		presetTable.append( std::move( entry ) );
+	}
+
+	QByteArray presetContents;
+	stream >> presetContents;
+
+	bool tableValid = std::all_of( presetTable.begin(), presetTable.end(), [&]( const BinaryPresetEntry & entry )
+	{
+		return quint64( entry.offset ) + entry.size <= quint64( presetContents.size() );
+	});
+	if (stream.status() != QDataStream::Ok || !tableValid)
+	{
+		preloaded.error =
+			"\""%fs::getFileNameFromPath(filePath)%"\" is corrupted. "
+			"You can either restore it from a backup, or delete it and start from scratch.";
+		return;
+	}
+
+	QJsonParseError parseError;
+	QJsonDocument jsonDoc = QJsonDocument::fromJson( header, &parseError );
+	if (jsonDoc.isNull())
+	{
+		preloaded.error =
+			"Failed to parse \""%fs::getFileNameFromPath(filePath)%"\": "%parseError.errorString()%"\n"
+			"You can either restore it from a backup, or delete it and start from scratch.";
+		return;
+	}
+
+	QJsonObject jsHeader = jsonDoc.object();
+	OptionsJournal journal = readOptionsJournal( getJournalFilePath( filePath ), jsHeader[ journalIDKey ].toString() );
+	applyJournalValues( journal, jsHeader );
+	preloaded.jsonDoc.setObject( jsHeader );
+
+	// the presets are only listed now, their content is decoded in decodePresetContent()
+	for (const BinaryPresetEntry & entry : presetTable)
+	{
+		Preset preset( entry.name );
+		preset.isSeparator = entry.isSeparator;
+		if (!preset.isSeparator)
+			preset.encodedContent = presetContents.mid( int( entry.offset ), int( entry.size ) );
+
+		preloaded.encodedPresets.append( std::move( preset ) );
+	}
+
+	applyJournalPresets( journal, preloaded.encodedPresets );
+}
+
+static void preloadJsonOptionsFile( PreloadedOptions & preloaded )
+{
+	const QString & filePath = preloaded.filePath;
+
+	QJsonDocument jsonDoc = parseJsonFile( filePath, "options", CheckIfEmpty, preloaded.error );
+	if (jsonDoc.isNull())
+	{
+		return;
+	}
+
+	// replay the changes that were made after the file was written
+	QJsonObject jsRoot = jsonDoc.object();
+	OptionsJournal journal = readOptionsJournal( getJournalFilePath( filePath ), jsRoot[ journalIDKey ].toString() );
+	if (journal.recordCount > 0)
+	{
+		applyJournalValues( journal, jsRoot );
+
+		QJsonArray jsPresetArray = jsRoot["presets"].toArray();
+		applyJournalPresets( journal, jsPresetArray );
+		jsRoot["presets"] = jsPresetArray;
+
+		jsonDoc.setObject( jsRoot );
+	}
+
+	preloaded.jsonDoc = std::move( jsonDoc );
+}
+
+
 //======================================================================================================================
 //  top-level API
 
@@ -884,15 +1349,323 @@ bool writeOptionsToFile( const OptionsToSave & opts, const QString & filePath )
 	return writeJsonToFile( jsonDoc, filePath, "options" );
 }
 
-bool readOptionsFromFile( OptionsToLoad & opts, const QString & filePath )
+PreloadedOptions preloadOptionsFile( const QString & filePath )
+{
+	TRACE_ZONE("preloadOptionsFile");
+
+	PreloadedOptions preloaded;
+	preloaded.filePath = filePath;
+
+	if (isBinaryOptionsFile( filePath ))
+		preloadBinaryOptionsFile( preloaded );
+	else
+		preloadJsonOptionsFile( preloaded );
+
+	return preloaded;
+}
+
+bool readOptionsFromFile( OptionsToLoad & opts, PreloadedOptions && preloaded )
 {
-	JsonDocumentCtx jsonDoc = readJsonFromFile( filePath, "options" );
-	if (!jsonDoc)
+	if (!preloaded.error.isEmpty())
 	{
+		reportRuntimeError( nullptr, "Error loading options", preloaded.error );
 		return false;
 	}
 
-	deserializeOptionsFromJsonDoc( jsonDoc, opts );
+	JsonDocumentCtx jsonDocCtx( preloaded.filePath, preloaded.jsonDoc );
+	deserializeOptionsFromJsonDoc( jsonDocCtx, opts );
+
+	// presets from the binary file are listed separately from the rest of the options
+	for (Preset & preset : preloaded.encodedPresets)
+	{
+		opts.presets.append( std::move( preset ) );
+	}
 
 	return true;
 }
+
+bool readOptionsFromFile( OptionsToLoad & opts, const QString & filePath )
+{
+	return readOptionsFromFile( opts, preloadOptionsFile( filePath ) );
+}
+
+void decodePresetContent( Preset & preset, const StorageSettings & settings, const QString & filePath )
+{
+	TRACE_ZONE("decodePresetContent");
+
+	if (preset.isContentDecoded())
+	{
+		return;
+	}
+
+	QByteArray content = std::move( preset.encodedContent );
+	preset.encodedContent.clear();  // mark it as decoded even if the decoding fails, so that the error is shown only once
+
+	QJsonParseError parseError;
+	QJsonDocument jsonDoc = QJsonDocument::fromJson( content, &parseError );
+	if (!jsonDoc.isObject())
+	{
+		reportRuntimeError( nullptr, "Error loading preset",
+			"Failed to parse preset \""%preset.name%"\" from \""%fs::getFileNameFromPath(filePath)%"\": "%parseError.errorString()%"\n"
+			"The preset will be reset to default values."
+		);
+		return;
+	}
+
+	// the preset might have been renamed since it was loaded
+	QString name = std::move( preset.name );
+
+	JsonDocumentCtx jsonDocCtx( filePath, jsonDoc );
+	jsonDocCtx.setDataVersion( appVersion );  // the content is always written by this version
+	deserialize( jsonDocCtx.rootObject(), preset, settings );
+
+	preset.name = std::move( name );
+}
+
+
+//======================================================================================================================
+//  background writing
+
+static metrics::Distribution g_writeDuration( "Options saving", "write duration", "ms" );
+static metrics::Distribution g_journalRecordSize( "Options saving", "journal record size", "B" );
+static metrics::Distribution g_fullFileSize( "Options saving", "full file size", "B" );
+static metrics::Counter g_replacedSnapshots( "Options saving", "snapshots replaced before written" );
+
+OptionsSnapshot::OptionsSnapshot( const OptionsToSave & opts )
+:
+	engines( opts.engines ),
+	iwads( opts.iwads ),
+	launchOpts( opts.launchOpts ),
+	multOpts( opts.multOpts ),
+	gameOpts( opts.gameOpts ),
+	compatOpts( opts.compatOpts ),
+	videoOpts( opts.videoOpts ),
+	audioOpts( opts.audioOpts ),
+	globalOpts( opts.globalOpts ),
+	presets( opts.presets ),
+	selectedPresetIdx( opts.selectedPresetIdx ),
+	engineSettings( opts.engineSettings ),
+	iwadSettings( opts.iwadSettings ),
+	mapSettings( opts.mapSettings ),
+	modSettings( opts.modSettings ),
+	settings( opts.settings ),
+	geometry( opts.geometry )
+{
+	// The preset model keeps pointers to the list items and modifies them directly, bypassing the copy-on-write,
+	// so the snapshot must not share the items with it.
+	presets.detach();
+}
+
+OptionsToSave OptionsSnapshot::toSave() const
+{
+	return OptionsToSave
+	{
+		engines,
+		iwads,
+
+		launchOpts,
+		multOpts,
+		gameOpts,
+		compatOpts,
+		videoOpts,
+		audioOpts,
+		globalOpts,
+
+		presets,
+		selectedPresetIdx,
+
+		engineSettings,
+		iwadSettings,
+		mapSettings,
+		modSettings,
+		settings,
+		geometry
+	};
+}
+
+OptionsWriter::OptionsWriter() : LoggingComponent("OptionsWriter") {}
+
+OptionsWriter::~OptionsWriter()
+{
+	waitForDone();
+}
+
+void OptionsWriter::writeInBackground( OptionsSnapshot snapshot, const QString & filePath )
+{
+	QMutexLocker lock( &_mutex );
+
+	if (_pendingWrite)
+	{
+		LOG_DEBUG() << "previous options snapshot has not been written yet, replacing it";
+		g_replacedSnapshots.increment();
+	}
+	_pendingWrite = PendingWrite{ std::move(snapshot), filePath };
+
+	// The running task will pick up the new snapshot when it's done with the current one.
+	if (!_taskQueued)
+	{
+		_taskQueued = true;
+		// nobody is waiting for the write, except at the exit, where waitForDone() is called
+		tasks::sharedScheduler().submit( tasks::Priority::BackgroundIdle, _writeTasks, [ this ]( const tasks::CancellationToken & )
+		{
+			writePendingSnapshots();
+		});
+	}
+}
+
+void OptionsWriter::waitForDone()
+{
+	_writeTasks.waitForDone();
+}
+
+QString OptionsWriter::takeError()
+{
+	QMutexLocker lock( &_mutex );
+
+	QString error = std::move( _error );
+	_error.clear();
+	return error;
+}
+
+void OptionsWriter::writePendingSnapshots()
+{
+	// This will run in a separate thread.
+
+	while (true)
+	{
+		std::optional< PendingWrite > pendingWrite;
+		{
+			QMutexLocker lock( &_mutex );
+			if (!_pendingWrite)
+			{
+				_taskQueued = false;
+				return;
+			}
+			pendingWrite = std::move( _pendingWrite );
+			_pendingWrite.reset();
+		}
+
+		QString error = writeOptions( pendingWrite->snapshot.toSave(), pendingWrite->filePath );
+		if (!error.isEmpty())
+		{
+			logRuntimeError() << error;
+
+			QMutexLocker lock( &_mutex );
+			_error = std::move( error );
+		}
+	}
+}
+
+QString OptionsWriter::writeOptions( const OptionsToSave & opts, const QString & filePath )
+{
+	TRACE_ZONE("OptionsWriter::writeOptions");
+	metrics::ScopedTimer timer( g_writeDuration );
+
+	QJsonObject jsRoot = serializeOptionsToJsonDoc( opts, WithoutPresets ).object();
+	QVector< QByteArray > presetContents = serializePresetContents( opts );
+
+	// the journal can be appended only to the file the previous write went to, otherwise the state of the file is unknown
+	if (filePath == _fullFilePath)
+	{
+		jsRoot[ journalIDKey ] = _fullFileID;
+
+		QByteArray record = makeJournalRecord( jsRoot, presetContents );
+		if (record.isEmpty())
+		{
+			return {};  // nothing that is stored has changed
+		}
+
+		if (_journalSize + record.size() <= maxJournalSize)
+		{
+			QString error = fs::appendToFile( getJournalFilePath( filePath ), record );
+			if (error.isEmpty())
+			{
+				g_journalRecordSize.record( record.size() );
+				_journalSize += record.size();
+				_writtenRoot = std::move( jsRoot );
+				_writtenPresets = std::move( presetContents );
+				return {};
+			}
+			logRuntimeError() << error << ", writing the whole file instead";
+		}
+		else
+		{
+			LOG_DEBUG() << "journal is full, compacting it into " << filePath;
+		}
+	}
+
+	return writeFullFile( std::move( jsRoot ), std::move( presetContents ), opts, filePath );
+}
+
+QString OptionsWriter::writeFullFile(
+	QJsonObject jsRoot, QVector< QByteArray > presetContents, const OptionsToSave & opts, const QString & filePath
+){
+	// the old journal records will no longer match, even if the journal fails to be deleted
+	QString fileID = QUuid::createUuid().toString();
+	jsRoot[ journalIDKey ] = fileID;
+
+	QByteArray bytes = opts.settings.binaryOptionsFile
+		? serializeOptionsToBinary( jsRoot, opts.presets, presetContents )
+		: serializeOptionsToJson( jsRoot, presetContents );
+
+	QString error = fs::updateFileSafely( filePath, bytes );
+	if (!error.isEmpty())
+	{
+		_fullFilePath.clear();  // try to write the whole file again next time
+		return error;
+	}
+
+	QFile::remove( getJournalFilePath( filePath ) );
+
+	g_fullFileSize.record( bytes.size() );
+	_fullFilePath = filePath;
+	_fullFileID = std::move( fileID );
+	_journalSize = 0;
+	_writtenRoot = std::move( jsRoot );
+	_writtenPresets = std::move( presetContents );
+	return {};
+}
+
+QByteArray OptionsWriter::makeJournalRecord( const QJsonObject & jsRoot, const QVector< QByteArray > & presetContents ) const
+{
+	QJsonObject jsValues;
+	for (auto it = jsRoot.constBegin(); it != jsRoot.constEnd(); ++it)
+	{
+		if (_writtenRoot.value( it.key() ) != it.value())
+			jsValues[ it.key() ] = it.value();
+	}
+
+	// some options are stored only in some configurations
+	QJsonArray jsRemovedKeys;
+	for (auto it = _writtenRoot.constBegin(); it != _writtenRoot.constEnd(); ++it)
+	{
+		if (!jsRoot.contains( it.key() ))
+			jsRemovedKeys.append( it.key() );
+	}
+
+	// the presets are compared in the serialized form, so that the presets that have never been selected
+	// don't need to be decoded
+	QJsonObject jsPresets;
+	for (int i = 0; i < presetContents.size(); ++i)
+	{
+		if (i >= _writtenPresets.size() || presetContents[i] != _writtenPresets[i])
+			jsPresets[ QString::number( i ) ] = QJsonDocument::fromJson( presetContents[i] ).object();
+	}
+
+	if (jsValues.isEmpty() && jsRemovedKeys.isEmpty() && jsPresets.isEmpty() && presetContents.size() == _writtenPresets.size())
+	{
+		return {};
+	}
+
+	QJsonObject jsRecord;
+	jsRecord["snapshot"] = _fullFileID;
+	if (!jsValues.isEmpty())
+		jsRecord["values"] = jsValues;
+	if (!jsRemovedKeys.isEmpty())
+		jsRecord["removed"] = jsRemovedKeys;
+	jsRecord["preset_count"] = presetContents.size();
+	if (!jsPresets.isEmpty())
+		jsRecord["presets"] = jsPresets;
+
+	return QJsonDocument( jsRecord ).toJson( QJsonDocument::Compact ) + '\n';
+}
@@ -12,9 +12,18 @@
 #include "Essential.hpp"
 
 #include "UserData.hpp"
+#include "Utils/ErrorHandling.hpp"  // LoggingComponent
+#include "Utils/TaskScheduler.hpp"
 
 #include <QList>
 #include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QMutex>
+
+#include <optional>
 
 
 //======================================================================================================================
@@ -75,8 +84,132 @@ struct OptionsToLoad
 	WindowGeometry geometry;
 };
 
+/// Copy of all the options to save, which can be serialized in another thread while the GUI keeps modifying the originals.
+/** Taking the snapshot is cheap, because the Qt containers are implicitly shared. Only the presets are copied up front,
+  * because the preset model modifies them in place, the other lists are copied only when the GUI modifies them. */
+struct OptionsSnapshot
+{
+	// files
+	QList< EngineInfo > engines;
+	QList< IWAD > iwads;
+
+	// options
+	LaunchOptions launchOpts;
+	MultiplayerOptions multOpts;
+	GameplayOptions gameOpts;
+	CompatibilityOptions compatOpts;
+	VideoOptions videoOpts;
+	AudioOptions audioOpts;
+	GlobalOptions globalOpts;
+
+	// presets
+	QList< Preset > presets;
+	int selectedPresetIdx;
+
+	// global settings
+	EngineSettings engineSettings;
+	IwadSettings iwadSettings;
+	MapSettings mapSettings;
+	ModSettings modSettings;
+	LauncherSettings settings;
+	WindowGeometry geometry;
+
+	OptionsSnapshot( const OptionsToSave & opts );
+
+	OptionsToSave toSave() const;
+};
+
+/// Writes the options in the JSON format, see OptionsWriter for writing in the format selected in the settings.
 bool writeOptionsToFile( const OptionsToSave & opts, const QString & filePath );
+
+/// Reads the options from either a JSON or a binary file.
+/** When reading from the binary file, the presets contain only names, the rest must be decoded by decodePresetContent(). */
 bool readOptionsFromFile( OptionsToLoad & opts, const QString & filePath );
 
+/// Content of an options file that has been read and parsed, but not yet deserialized into the options.
+/** Reading and parsing is the slow part and doesn't touch the GUI, so it can be done in a background thread
+  * by preloadOptionsFile(). The deserialization may show error dialogs, so it must be done in the GUI thread. */
+struct PreloadedOptions
+{
+	QString filePath;
+	QString error;                   ///< why the file couldn't be loaded, empty when successful
+	QJsonDocument jsonDoc;           ///< options with the changes from the journal already applied
+	QList< Preset > encodedPresets;  ///< presets listed in a binary file, not yet decoded
+};
+
+/// Reads and parses either a JSON or a binary options file. Doesn't report any errors, can be called from any thread.
+PreloadedOptions preloadOptionsFile( const QString & filePath );
+
+/// Same as readOptionsFromFile( opts, filePath ), but takes the file already preloaded by preloadOptionsFile().
+bool readOptionsFromFile( OptionsToLoad & opts, PreloadedOptions && preloaded );
+
+/// Decodes the rest of a preset that has been loaded from a binary file. Does nothing if it's already decoded.
+/** \param filePath Path of the file the preset was loaded from, used for error messages. */
+void decodePresetContent( Preset & preset, const StorageSettings & settings, const QString & filePath );
+
+
+//======================================================================================================================
+/// Serializes the options and writes them to a file in a background thread, so that large options don't block the GUI.
+/** Only one write runs at a time. When more snapshots are scheduled while a write is running, only the latest one
+  * is written after it, because the others are already outdated. The errors can't be reported from the background
+  * thread, they have to be collected by the GUI thread via takeError().
+  *
+  * The first write rewrites the whole file, the following ones only append the options that changed since
+  * the previous write into a journal next to the file, which readOptionsFromFile() replays. When the journal
+  * grows too big, it is compacted into a new full file. */
+
+class OptionsWriter : protected LoggingComponent {
+
+ public:
+
+	OptionsWriter();
+	~OptionsWriter();
+
+	/// Schedules the snapshot to be written into the file, replaces any snapshot that hasn't started being written yet.
+	void writeInBackground( OptionsSnapshot snapshot, const QString & filePath );
+
+	/// Blocks until all the scheduled snapshots are written. Use before the application exits.
+	void waitForDone();
+
+	/// Returns the error of the last failed write and clears it, empty string means no error.
+	QString takeError();
+
+ private:
+
+	/// Writes the scheduled snapshots until there are none left. Runs in the background thread.
+	void writePendingSnapshots();
+
+	/// Appends the changes to the journal, or writes the whole file if the journal can't be used.
+	QString writeOptions( const OptionsToSave & opts, const QString & filePath );
+	QString writeFullFile( QJsonObject jsRoot, QVector< QByteArray > presetContents, const OptionsToSave & opts, const QString & filePath );
+	QByteArray makeJournalRecord( const QJsonObject & jsRoot, const QVector< QByteArray > & presetContents ) const;
+
+ private:
+
+	struct PendingWrite
+	{
+		OptionsSnapshot snapshot;
+		QString filePath;
+	};
+
+	tasks::TaskGroup _writeTasks;  ///< at most one task at a time, so that the writes never overlap, see _taskQueued
+
+	QMutex _mutex;  ///< protects all the members below
+	std::optional< PendingWrite > _pendingWrite;
+	bool _taskQueued = false;
+	QString _error;
+
+	// state of the file on the disk, accessed only by the background thread
+
+	static constexpr qint64 maxJournalSize = 256 * 1024;
+
+	QString _fullFilePath;  ///< where the last full file was written, the journal belongs to it, empty if none
+	QString _fullFileID;    ///< identifies the journal records that belong to the last full file
+	qint64 _journalSize = 0;
+	QJsonObject _writtenRoot;  ///< top-level options as they are on the disk, including the journal
+	QVector< QByteArray > _writtenPresets;  ///< serialized presets as they are on the disk, including the journal
+
+};
+
 
 #endif // OPTIONS_INCLUDED
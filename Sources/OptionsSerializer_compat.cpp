@@ -26,14 +26,8 @@ static void deserialize_pre17( const JsonObjectCtx & jsIWADs, IwadSettings & iwa
 
 static void deserialize_pre17( const JsonObjectCtx & jsOptions, GameplayOptions & opts )
 {
-	opts.skillNum = jsOptions.getInt( "skill_num", opts.skillNum );
+	deserialize( jsOptions, opts );  // skill_idx is not expected in this version
 	opts.skillIdx = opts.skillNum;
-	opts.noMonsters = jsOptions.getBool( "no_monsters", opts.noMonsters );
-	opts.fastMonsters = jsOptions.getBool( "fast_monsters", opts.fastMonsters );
-	opts.monstersRespawn = jsOptions.getBool( "monsters_respawn", opts.monstersRespawn );
-	opts.dmflags1 = jsOptions.getInt( "dmflags1", opts.dmflags1 );
-	opts.dmflags2 = jsOptions.getInt( "dmflags2", opts.dmflags2 );
-	opts.allowCheats = jsOptions.getBool( "allow_cheats", opts.allowCheats );
 }
 
 static void deserialize_pre17( const JsonObjectCtx & jsPreset, Preset & preset, const StorageSettings & settings )
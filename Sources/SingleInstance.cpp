@@ -0,0 +1,222 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: command line arguments and forwarding them to an already running instance of this application
+//======================================================================================================================
+
+#include "SingleInstance.hpp"
+
+#include "Utils/OSUtils.hpp"  // getThisAppDataDir
+#include "Utils/FileSystemUtils.hpp"  // getAbsolutePath
+
+#include <QLocalSocket>
+#include <QDataStream>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QStringBuilder>
+
+
+//======================================================================================================================
+//  command line arguments
+
+StartupArgs parseStartupArgs( const QStringList & cmdLine )
+{
+	QCommandLineParser parser;
+	parser.setApplicationDescription( "Preset-oriented graphical launcher of various ported Doom engines" );
+
+	QCommandLineOption presetOption( "preset", "Select a preset with this name.", "name" );
+	QCommandLineOption launchOption( "launch", "Launch the selected preset right away." );
+	QCommandLineOption newInstanceOption( "new-instance", "Don't pass the arguments to an already running DoomRunner." );
+	QCommandLineOption profileStartupOption( "profile-startup", "Log how long the individual stages of the startup take." );
+	QCommandLineOption traceOption( "trace", "Record a performance trace of the whole run and save it into a file.", "file" );
+	QCommandLineOption logLevelOption( "log-level", "Which messages to log, for example \"info,WADReader=debug\". Errors are always logged.", "levels" );
+	parser.addOption( presetOption );
+	parser.addOption( launchOption );
+	parser.addOption( newInstanceOption );
+	parser.addOption( profileStartupOption );
+	parser.addOption( traceOption );
+	parser.addOption( logLevelOption );
+	parser.addPositionalArgument( "files", "Files to be added to the selected preset as mods.", "[files...]" );
+
+	StartupArgs args;
+
+	// Don't use QCommandLineParser::process(), it would exit the application on the first unknown argument.
+	if (!parser.parse( cmdLine ))
+	{
+		logRuntimeError("StartupArgs") << "invalid command line: " << parser.errorText();
+		return args;
+	}
+
+	args.presetName = parser.value( presetOption );
+	args.launch = parser.isSet( launchOption );
+	args.newInstance = parser.isSet( newInstanceOption );
+	args.profileStartup = parser.isSet( profileStartupOption );
+	if (parser.isSet( traceOption ))
+		args.traceFile = fs::getAbsolutePath( parser.value( traceOption ) );
+	args.logLevels = parser.value( logLevelOption );
+	for (const QString & filePath : parser.positionalArguments())
+	{
+		args.filesToOpen.append( fs::getAbsolutePath( filePath ) );
+	}
+
+	return args;
+}
+
+QDataStream & operator<<( QDataStream & stream, const StartupArgs & args )
+{
+	QStringList filesToOpen;
+	for (const QString & filePath : args.filesToOpen)
+		filesToOpen.append( filePath );
+
+	stream << args.presetName << filesToOpen << args.launch;
+	return stream;
+}
+
+QDataStream & operator>>( QDataStream & stream, StartupArgs & args )
+{
+	QStringList filesToOpen;
+	stream >> args.presetName >> filesToOpen >> args.launch;
+	args.filesToOpen.clear();
+	for (QString & filePath : filesToOpen)
+		args.filesToOpen.append( std::move(filePath) );
+	return stream;
+}
+
+
+//======================================================================================================================
+//  SingleInstanceGuard
+
+static constexpr quint32 messageMagic = 0x44524E31;  // "DRN1"
+static constexpr auto streamVersion = QDataStream::Qt_5_6;  // both sides must use the same one
+
+static constexpr int connectTimeout_ms = 200;
+static constexpr int writeTimeout_ms = 1000;
+
+
+SingleInstanceGuard::SingleInstanceGuard()
+:
+	LoggingComponent("SingleInstanceGuard")
+{
+	// Options file is stored in the application data dir, so that is what needs to be guarded.
+	// Different users or portable installations with different data dirs can still run side by side.
+	QByteArray dirHash = QCryptographicHash::hash( os::getThisAppDataDir().toUtf8(), QCryptographicHash::Sha1 ).toHex();
+	serverName = "DoomRunner-" % QString::fromLatin1( dirHash.left( 16 ) );
+
+	connect( &server, &QLocalServer::newConnection, this, &thisClass::onNewConnection );
+}
+
+SingleInstanceGuard::~SingleInstanceGuard()
+{
+	server.close();
+}
+
+bool SingleInstanceGuard::forwardToRunningInstance( const StartupArgs & args )
+{
+	QLocalSocket socket;
+	socket.connectToServer( serverName );
+	if (!socket.waitForConnected( connectTimeout_ms ))
+	{
+		return false;  // no instance is running, or it's stuck, either way we need to handle the arguments ourselves
+	}
+
+	QByteArray message;
+	QDataStream stream( &message, QIODevice::WriteOnly );
+	stream.setVersion( streamVersion );
+	stream << messageMagic << args;
+
+	socket.write( message );
+	bool written = socket.waitForBytesWritten( writeTimeout_ms );
+	socket.disconnectFromServer();
+	if (socket.state() != QLocalSocket::UnconnectedState)
+	{
+		socket.waitForDisconnected( writeTimeout_ms );
+	}
+
+	if (!written)
+	{
+		logRuntimeError() << "failed to pass the arguments to the running instance: " << socket.errorString();
+		return false;
+	}
+
+	LOG_INFO() << "command line arguments passed to the running instance";
+	return true;
+}
+
+bool SingleInstanceGuard::startListening()
+{
+	// only the current user should be able to control our instance
+	server.setSocketOptions( QLocalServer::UserAccessOption );
+
+	if (server.listen( serverName ))
+	{
+		return true;
+	}
+
+	if (server.serverError() == QAbstractSocket::AddressInUseError)
+	{
+		// Either another instance is listening (started with --new-instance), or a previous instance crashed
+		// and left its socket file behind (Unix only). Removing the socket of a living instance would break it.
+		QLocalSocket probe;
+		probe.connectToServer( serverName );
+		if (probe.waitForConnected( connectTimeout_ms ))
+		{
+			probe.abort();
+			LOG_INFO() << "another instance is already listening, arguments from new instances will go there";
+			return false;
+		}
+
+		QLocalServer::removeServer( serverName );
+		if (server.listen( serverName ))
+		{
+			return true;
+		}
+	}
+
+	logRuntimeError() << "failed to start listening for other instances: " << server.errorString();
+	return false;
+}
+
+void SingleInstanceGuard::onNewConnection()
+{
+	while (QLocalSocket * socket = server.nextPendingConnection())
+	{
+		// the message might arrive in several chunks, wait for all of them
+		connect( socket, &QLocalSocket::readyRead, this, [ this, socket ]() { readMessage( socket ); } );
+		connect( socket, &QLocalSocket::disconnected, socket, &QLocalSocket::deleteLater );
+
+		// some data might have already arrived before we connected the signals
+		if (socket->bytesAvailable() > 0)
+		{
+			readMessage( socket );
+		}
+	}
+}
+
+void SingleInstanceGuard::readMessage( QLocalSocket * socket )
+{
+	QDataStream stream( socket );
+	stream.setVersion( streamVersion );
+
+	stream.startTransaction();
+
+	quint32 magic = 0;
+	StartupArgs args;
+	stream >> magic >> args;
+
+	if (!stream.commitTransaction())
+	{
+		return;  // incomplete message, the rest will come in the next readyRead
+	}
+
+	if (magic != messageMagic)
+	{
+		logRuntimeError() << "received an invalid message from another instance";
+		socket->abort();
+		return;
+	}
+
+	LOG_INFO() << "received command line arguments from another instance";
+
+	emit argsReceived( args );
+}
@@ -0,0 +1,96 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: command line arguments and forwarding them to an already running instance of this application
+//======================================================================================================================
+
+#ifndef SINGLE_INSTANCE_INCLUDED
+#define SINGLE_INSTANCE_INCLUDED
+
+
+#include "Essential.hpp"
+#include "CommonTypes.hpp"
+#include "Utils/ErrorHandling.hpp"  // LoggingComponent
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QLocalServer>
+
+class QLocalSocket;
+class QDataStream;
+
+
+//======================================================================================================================
+//  command line arguments
+
+/// Actions requested by the user via command line of this process or of another instance that forwarded them to us.
+struct StartupArgs
+{
+	QString presetName;       ///< name of a preset to be selected
+	QStringVec filesToOpen;   ///< absolute paths of files to be added to the selected preset as mods
+	bool launch = false;      ///< whether to launch the selected preset right away
+	bool newInstance = false; ///< don't forward the arguments to an already running instance, start a new one instead
+	bool profileStartup = false;  ///< log how long the individual stages of the startup take
+	QString traceFile;        ///< absolute path of a file where to save a performance trace of the whole run
+	QString logLevels;        ///< which messages to log, see setLogLevels() in ErrorHandling.hpp
+
+	bool isEmpty() const { return presetName.isEmpty() && filesToOpen.isEmpty() && !launch; }
+};
+
+/// Parses command line arguments of this application (including the program name at index 0).
+/** Relative file paths are converted to absolute using the current working directory,
+  * so this needs to be called before the working directory is changed. */
+StartupArgs parseStartupArgs( const QStringList & cmdLine );
+
+QDataStream & operator<<( QDataStream & stream, const StartupArgs & args );
+QDataStream & operator>>( QDataStream & stream, StartupArgs & args );
+
+
+//======================================================================================================================
+/// Makes sure only one instance of this application is running for a particular user and data directory.
+/** The first instance listens on a local socket (named pipe on Windows) and any later instance sends its command line
+  * arguments there and exits immediately. This prevents two instances from overwriting each other's options file. */
+
+class SingleInstanceGuard : public QObject, protected LoggingComponent {
+
+	Q_OBJECT
+
+	using thisClass = SingleInstanceGuard;
+
+ public:
+
+	SingleInstanceGuard();
+	virtual ~SingleInstanceGuard() override;
+
+	/// Attempts to pass the arguments to an instance that is already running.
+	/** Returns true if there is such instance and it has received the arguments, in which case this process should exit. */
+	bool forwardToRunningInstance( const StartupArgs & args );
+
+	/// Starts accepting arguments from other instances that will be started later.
+	/** Returns false if another instance is already listening or the local server could not be started. */
+	bool startListening();
+
+ signals:
+
+	/// Emitted in the main thread whenever another instance forwards its command line arguments to us.
+	void argsReceived( const StartupArgs & args );
+
+ private slots:
+
+	void onNewConnection();
+
+ private:
+
+	void readMessage( QLocalSocket * socket );
+
+ private:
+
+	QString serverName;  ///< unique for each user and application data directory
+	QLocalServer server;
+
+};
+
+
+#endif // SINGLE_INSTANCE_INCLUDED
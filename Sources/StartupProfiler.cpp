@@ -0,0 +1,183 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: measuring durations of engine initialization phases from the timestamps of its output
+//======================================================================================================================
+
+#include "StartupProfiler.hpp"
+
+#include <QRegularExpression>
+
+#include <iterator>  // size
+
+
+//======================================================================================================================
+//  output patterns - add support for new engine families here
+
+struct StartupPatterns
+{
+	QRegularExpression phase;  ///< line that starts an initialization phase, the 1st capture group is the phase name
+	QRegularExpression file;   ///< line that announces loading of a file, the 1st capture group is the file path
+	QRegularExpression end;    ///< last line of the initialization
+};
+
+// " adding doom2.wad", "adding /path/to/mod.pk3, 1234 lumps", "Loading DEH file mod.deh"
+#define FILE_PATTERN "^\\s*(?:[Aa]dding|[Ll]oading)\\s+(?:DEH(?:/BEX)?\\s+file\\s+)?(.+\\.\\w{1,4})(?:,\\s*\\d+\\s+lumps)?\\s*$"
+
+// "W_Init: Init WADfiles.", "HU_Init: Setting up heads up display."
+#define VANILLA_PHASE_PATTERN "^\\s*([A-Z]{1,3}_[A-Za-z]+)\\s*:"
+
+static const StartupPatterns startupPatterns [] =
+{
+	/*ZDoom*/ {
+		// ZDoom additionally names some phases after the classes or functions, like "Texman.Init:" or "LoadActors:"
+		QRegularExpression( "^\\s*([A-Z][A-Za-z0-9]*(?:[_.][A-Za-z0-9_.]+|[a-z][A-Z][A-Za-z0-9]*))\\s*:\\s" ),
+		QRegularExpression( FILE_PATTERN ),
+		// ZDoom prints "ST_Init" early to initialize its startup screen, the network check is the last step instead
+		QRegularExpression( "^\\s*D_CheckNetGame\\b" ),
+	},
+	/*PrBoom*/ {
+		QRegularExpression( VANILLA_PHASE_PATTERN ),
+		QRegularExpression( FILE_PATTERN ),
+		QRegularExpression( "^\\s*ST_Init\\b" ),
+	},
+	/*MBF*/ {
+		QRegularExpression( VANILLA_PHASE_PATTERN ),
+		QRegularExpression( FILE_PATTERN ),
+		QRegularExpression( "^\\s*ST_Init\\b" ),
+	},
+	/*Chocolate*/ {
+		QRegularExpression( VANILLA_PHASE_PATTERN ),
+		QRegularExpression( FILE_PATTERN ),
+		QRegularExpression( "^\\s*ST_Init\\b" ),
+	},
+};
+static_assert( std::size(startupPatterns) == size_t(EngineFamily::_EnumEnd), "Please update this table too" );
+
+#undef FILE_PATTERN
+#undef VANILLA_PHASE_PATTERN
+
+// output before the first recognized phase, mostly the time the OS needs to load the executable
+static const char * const processStartPhase = "(process start)";
+
+
+//======================================================================================================================
+//  StartupProfiler
+
+StartupProfiler::StartupProfiler()
+{
+	_line.reserve( maxLineLength );
+}
+
+void StartupProfiler::start( EngineFamily family )
+{
+	_profile = {};
+	_inProgress = {};
+	_line.resize( 0 );
+	_phaseStepIdx = -1;
+	_fileStepIdx = -1;
+
+	if (size_t(family) >= std::size(startupPatterns))
+	{
+		_patterns = nullptr;
+		return;
+	}
+	_patterns = &startupPatterns[ size_t(family) ];
+
+	beginPhase( processStartPhase, 0 );
+}
+
+void StartupProfiler::addOutput( const QChar * text, int length, qint64 time_ms )
+{
+	for (int i = 0; i < length && isRunning(); ++i)
+	{
+		const QChar c = text[i];
+		if (c == '\n' || c == '\r')
+		{
+			if (!_line.isEmpty())
+			{
+				processLine( _lineTime_ms );
+				_line.resize( 0 );  // keep the capacity
+			}
+		}
+		else
+		{
+			if (_line.isEmpty())
+				_lineTime_ms = time_ms;  // the engine usually prints the line before it starts the work it announces
+			if (_line.size() < maxLineLength)
+				_line += c;
+		}
+	}
+}
+
+void StartupProfiler::stop()
+{
+	// The engine exited before finishing the initialization (probably an error in a mod),
+	// such timeline is not comparable with the other runs.
+	_patterns = nullptr;
+	_inProgress = {};
+}
+
+void StartupProfiler::processLine( qint64 time_ms )
+{
+	if (_patterns->end.match( _line ).hasMatch())
+	{
+		endStep( _fileStepIdx, time_ms );
+		endStep( _phaseStepIdx, time_ms );
+		_inProgress.duration_ms = time_ms;
+
+		_profile = std::move( _inProgress );
+		_patterns = nullptr;
+		return;
+	}
+
+	QRegularExpressionMatch match = _patterns->file.match( _line );
+	if (match.hasMatch())
+	{
+		beginFile( match.captured(1).trimmed(), time_ms );
+		return;
+	}
+
+	match = _patterns->phase.match( _line );
+	if (match.hasMatch())
+	{
+		beginPhase( match.captured(1), time_ms );
+		return;
+	}
+}
+
+void StartupProfiler::beginPhase( const QString & phase, qint64 time_ms )
+{
+	// a phase spans all the files loaded within it
+	endStep( _fileStepIdx, time_ms );
+	endStep( _phaseStepIdx, time_ms );
+
+	StartupStep step;
+	step.phase = phase;
+	step.start_ms = time_ms;
+	_phaseStepIdx = int( _inProgress.steps.size() );
+	_fileStepIdx = -1;
+	_inProgress.steps.append( std::move(step) );
+}
+
+void StartupProfiler::beginFile( const QString & filePath, qint64 time_ms )
+{
+	endStep( _fileStepIdx, time_ms );
+
+	StartupStep step;
+	step.phase = _inProgress.steps[ _phaseStepIdx ].phase;
+	step.file = filePath;
+	step.start_ms = time_ms;
+	_fileStepIdx = int( _inProgress.steps.size() );
+	_inProgress.steps.append( std::move(step) );
+}
+
+void StartupProfiler::endStep( int stepIdx, qint64 time_ms )
+{
+	if (stepIdx >= 0)
+	{
+		StartupStep & step = _inProgress.steps[ stepIdx ];
+		step.duration_ms = time_ms - step.start_ms;
+	}
+}
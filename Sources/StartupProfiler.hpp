@@ -0,0 +1,76 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: measuring durations of engine initialization phases from the timestamps of its output
+//======================================================================================================================
+
+#ifndef STARTUP_PROFILER_INCLUDED
+#define STARTUP_PROFILER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "UserData.hpp"       // StartupProfile
+#include "EngineTraits.hpp"   // EngineFamily
+
+#include <QString>
+
+struct StartupPatterns;
+
+
+//======================================================================================================================
+/// Reconstructs the engine start-up timeline from the lines it prints.
+/** Doom engines print a line when they enter an initialization phase (W_Init, R_Init, P_Init, ...)
+  * and a line for every file they load. A phase lasts until the next phase starts and a file until the next file
+  * or phase starts, the time of a step is the time when the first character of its line arrived.
+  * The start-up is considered finished when the engine prints the last line of its initialization,
+  * which differs between engine families. Lines that don't match any pattern are ignored. */
+
+class StartupProfiler {
+
+ public:
+
+	static constexpr int maxLineLength = 1024;  ///< longer lines are cut, the interesting part is at the beginning
+
+	StartupProfiler();
+
+	/// Clears the previous results and starts waiting for the output of a new process.
+	void start( EngineFamily family );
+
+	/// Processes a piece of decoded process output, which can contain any number of (even incomplete) lines.
+	/** \param time_ms Time since the process start when this output arrived. */
+	void addOutput( const QChar * text, int length, qint64 time_ms );
+
+	/// Stops the profiling when the process exits. If the start-up has not finished yet, the result is discarded.
+	void stop();
+
+	/// Whether the output still needs to be passed to this profiler.
+	bool isRunning() const  { return _patterns != nullptr; }
+
+	/// Result of the profiling, empty until the start-up finishes.
+	const StartupProfile & profile() const  { return _profile; }
+
+ private:
+
+	void processLine( qint64 time_ms );
+	void beginPhase( const QString & phase, qint64 time_ms );
+	void beginFile( const QString & filePath, qint64 time_ms );
+	void endStep( int stepIdx, qint64 time_ms );
+
+ private:
+
+	const StartupPatterns * _patterns = nullptr;  ///< nullptr when not running
+
+	QString _line;               ///< line that is currently being received
+	qint64 _lineTime_ms = 0;     ///< when the first character of the current line arrived
+	int _phaseStepIdx = -1;      ///< step of the phase that is currently running
+	int _fileStepIdx = -1;       ///< step of the file that is currently being loaded, -1 if none
+
+	StartupProfile _inProgress;
+	StartupProfile _profile;
+
+};
+
+
+#endif // STARTUP_PROFILER_INCLUDED
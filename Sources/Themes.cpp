@@ -523,7 +523,7 @@ bool WindowsThemeWatcherImpl::openThemeSettingsMonitoring()
 	if (!optThemeSettingsKey)
 	{
 		// This key exists since certain build of Windows 10, older versions don't have it.
-		logInfo().noquote() << "cannot open registry key: \"HKEY_CURRENT_USER/"<<lightThemeSubkeyPath<<"\"";
+		LOG_INFO().noquote() << "cannot open registry key: \"HKEY_CURRENT_USER/"<<lightThemeSubkeyPath<<"\"";
 		return false;
 	}
 
@@ -566,7 +566,7 @@ SystemThemeWatcher::SystemThemeWatcherImpl::QuitReason WindowsThemeWatcherImpl::
 	{
 		if (optUseLightTheme.error() == ERROR_INVALID_HANDLE)
 		{
-			logDebug() << "the theme registry key has been closed, aborting monitoring";
+			LOG_DEBUG() << "the theme registry key has been closed, aborting monitoring";
 			quitReason = QuitReason::MonitoringClosed;
 		}
 		else if (optUseLightTheme.error() != ERROR_SUCCESS)
@@ -594,7 +594,7 @@ SystemThemeWatcher::SystemThemeWatcherImpl::QuitReason WindowsThemeWatcherImpl::
 		{
 			if (optUseLightTheme.error() == ERROR_INVALID_HANDLE)
 			{
-				logDebug() << "the theme registry key has been closed, aborting system theme monitoring";
+				LOG_DEBUG() << "the theme registry key has been closed, aborting system theme monitoring";
 				quitReason = QuitReason::MonitoringClosed;
 			}
 			else
@@ -783,7 +783,7 @@ bool SystemThemeWatcher::start()
 		return false;
 	}
 
-	logDebug() << "starting monitoring thread";
+	LOG_DEBUG() << "starting monitoring thread";
 
 	QThread::start();
 	_started = true;
@@ -797,7 +797,7 @@ bool SystemThemeWatcher::stop( ulong timeout_ms )
 	{
 		if (_started)  // thread might have exited before this call due to some error
 		{
-			logDebug() << "monitoring thread already stopped";
+			LOG_DEBUG() << "monitoring thread already stopped";
 			_started = false;
 			return true;
 		}
@@ -808,7 +808,7 @@ bool SystemThemeWatcher::stop( ulong timeout_ms )
 		}
 	}
 
-	logDebug() << "stopping monitoring thread";
+	LOG_DEBUG() << "stopping monitoring thread";
 
 	// Locking is needed to prevent both threads closing the monitoring at the same time.
 	std::unique_lock< std::mutex > monitoringLock( _monitoringMtx );
@@ -822,7 +822,7 @@ bool SystemThemeWatcher::stop( ulong timeout_ms )
 
 	if (threadFinished)
 	{
-		logDebug() << "monitoring thread has stopped";
+		LOG_DEBUG() << "monitoring thread has stopped";
 		_started = false;
 	}
 	else
@@ -839,7 +839,7 @@ void SystemThemeWatcher::run()
 
 	auto quitReason = _impl->monitorThemeSettingsChanges( [ this ]( SystemTheme newTheme )
 	{
-		logDebug() << "system theme change detected";
+		LOG_DEBUG() << "system theme change detected";
 		emit systemThemeChanged( newTheme );
 	});
 
@@ -8,6 +8,7 @@
 #include "UserData.hpp"
 
 #include <QFileIconProvider>
+#include <QTimer>
 #include <QString>
 #include <QHash>
 
@@ -25,38 +26,79 @@ static QHash< QString, QIcon > g_filesystemIconCache;
 // better construct it only once rather than in every call
 static std::optional< QFileIconProvider > g_iconProvider;
 
-const QIcon & Mod::getIcon() const
-{
-	if (isCmdArg)
-	{
-		return emptyIcon;
-	}
+// Icons requested during painting are loaded only after the painting is finished, so that scrolling doesn't stutter.
+// QFileIconProvider can only be used from the GUI thread, so they are loaded later in the event loop.
+static QHash< QString, QString > g_pendingIcons;  // icon key -> path of an entry with such icon
+static std::function< void () > g_iconsLoadedCallback;
 
-	if (!g_iconProvider)
-	{
-		g_iconProvider.emplace();
-		g_iconProvider->setOptions( QFileIconProvider::DontUseCustomDirectoryIcons );  // custom dir icons might cause freezes
-	}
+QString Mod::makeIconKey( const QFileInfo & entry )
+{
+	return makeIconKey( entry, entry.isDir() );
+}
 
+QString Mod::makeIconKey( const QFileInfo & entry, bool isDir )
+{
 	// File icons are mostly determined by file suffix, so we can cache the icons only for the suffixes to load less
 	// icons in total. The only exception is when a file has no suffix on Linux, then the icon can be determined
 	// by file header, but those files will not be used as mods, so we can ignore that.
 	// Special handling is needed for directories, because they don't have suffixes (usually),
 	// but we want to display them differently than files without suffixes.
+	return isDir ? "<dir>" : entry.suffix().toLower();  // suffix() only parses the path
+}
 
-	QFileInfo entryInfo( this->path );
-	QString entryID = entryInfo.isDir() ? "<dir>" : entryInfo.suffix().toLower();
+static void loadPendingIcons()
+{
+	if (!g_iconProvider)
+	{
+		g_iconProvider.emplace();
+		g_iconProvider->setOptions( QFileIconProvider::DontUseCustomDirectoryIcons );  // custom dir icons might cause freezes
+	}
 
-	auto iter = g_filesystemIconCache.find( entryID );
-	if (iter == g_filesystemIconCache.end())
+	for (auto iter = g_pendingIcons.begin(); iter != g_pendingIcons.end(); ++iter)
 	{
-		QIcon origIcon = g_iconProvider->icon( entryInfo );
+		QIcon origIcon = g_iconProvider->icon( QFileInfo( iter.value() ) );
 
 		// strip the icon from unnecessary high-res variants that slow down the painting process
-		QSize smallestSize = origIcon.availableSizes().at(0);
-		QPixmap pixmap = origIcon.pixmap( smallestSize );
+		QList< QSize > availableSizes = origIcon.availableSizes();
+		QIcon icon = !availableSizes.isEmpty() ? QIcon( origIcon.pixmap( availableSizes.at(0) ) ) : origIcon;
 
-		iter = g_filesystemIconCache.insert( std::move( entryID ), QIcon( pixmap ) );
+		g_filesystemIconCache.insert( iter.key(), std::move( icon ) );
 	}
-	return iter.value();
+	g_pendingIcons.clear();
+
+	if (g_iconsLoadedCallback)
+		g_iconsLoadedCallback();
+}
+
+const QIcon & Mod::getIcon() const
+{
+	if (isCmdArg)
+	{
+		return emptyIcon;
+	}
+
+	// Mods get it when they are created or when their existence is checked, this is only a fallback.
+	const QString iconKey = !this->iconKey.isEmpty() ? this->iconKey : makeIconKey( QFileInfo( this->path ) );
+
+	auto iter = g_filesystemIconCache.find( iconKey );
+	if (iter != g_filesystemIconCache.end())
+	{
+		return iter.value();
+	}
+
+	// first entry of this kind, show no icon until it's loaded
+	if (g_pendingIcons.isEmpty())
+	{
+		QTimer::singleShot( 0, &loadPendingIcons );
+	}
+	if (!g_pendingIcons.contains( iconKey ))
+	{
+		g_pendingIcons.insert( iconKey, this->path );
+	}
+	return emptyIcon;
+}
+
+void setModIconsLoadedCallback( std::function< void () > callback )
+{
+	g_iconsLoadedCallback = std::move( callback );
 }
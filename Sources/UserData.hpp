@@ -19,9 +19,12 @@
 #include "Themes.hpp"                // Theme
 
 #include <QString>
+#include <QByteArray>
 #include <QFileInfo>
 #include <QRect>
 
+#include <functional>
+
 
 //======================================================================================================================
 //  OS-specific defaults
@@ -82,12 +85,19 @@ struct Mod : public EditableListModelItem
 {
 	QString path;           ///< path to the mod file
 	QString fileName;       ///< cached last part of path, beware of inconsistencies
+	QString iconKey;        ///< cached kind of the file-system entry that determines its icon, empty if not known yet
 	bool checked = true;    ///< whether this mod is selected to be loaded
 	bool isCmdArg = false;  ///< indicates that this is a special item used to insert a custom command line argument between the mod files
 
 	Mod() {}
 	Mod( const QFileInfo & file, bool checked = true )
-		: path( file.filePath() ), fileName( file.fileName() ), checked( checked ) {}
+		: path( file.filePath() ), fileName( file.fileName() ), iconKey( makeIconKey( file ) ), checked( checked ) {}
+
+	/// Determines the kind of icon of a file-system entry, so that painting the mod doesn't need to access the file-system.
+	/** Can be called on the same QFileInfo that checks the existence of the entry, then it costs nothing extra. */
+	static QString makeIconKey( const QFileInfo & entry );
+	/// Variant for when the kind of the entry is already known, does not access the file-system.
+	static QString makeIconKey( const QFileInfo & entry, bool isDir );
 
 	// requirements of EditableListModel
 	bool isEditable() const                 { return isCmdArg; }
@@ -100,6 +110,10 @@ struct Mod : public EditableListModelItem
 	const QIcon & getIcon() const;
 };
 
+/// Sets a function that is called when the icons requested by Mod::getIcon() have been loaded.
+/** The views displaying the mods should be repainted then. */
+void setModIconsLoadedCallback( std::function< void () > callback );
+
 //----------------------------------------------------------------------------------------------------------------------
 //  gameplay/compatibility options
 
@@ -244,6 +258,39 @@ struct GlobalOptions
 	EnvVars envVars;
 };
 
+/// Single step of an engine start-up, either an initialization phase or loading of a file within the phase.
+struct StartupStep
+{
+	QString phase;             ///< name of the phase as printed by the engine (W_Init, R_Init, ...)
+	QString file;              ///< file loaded in this step, empty if the step is the phase itself
+	qint64 start_ms = 0;       ///< since the process start
+	qint64 duration_ms = 0;
+};
+
+/// Breakdown of the time the engine spent starting up, reconstructed from its output.
+struct StartupProfile
+{
+	qint64 duration_ms = 0;    ///< from the process start until the engine finished its initialization
+	QVector< StartupStep > steps;
+
+	bool isEmpty() const  { return steps.isEmpty(); }
+};
+
+/// Statistics of a single launch of a preset, measured while the engine was running.
+struct PlaySession
+{
+	qint64 startTime = 0;          ///< seconds since epoch
+	QString engineName;
+	// resource usage, all zero if the resources were not monitored
+	qint64 duration_ms = 0;
+	qint64 peakRss_bytes = 0;
+	double avgCpuPercent = 0.0;    ///< 100% means one fully utilized core
+	qint64 totalReadBytes = 0;
+	int peakThreadCount = 0;
+	// empty if the start-up was not profiled or didn't finish
+	StartupProfile startup;
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 //  preset
 
@@ -269,10 +316,20 @@ struct Preset : public EditableListModelItem
 
 	EnvVars envVars;
 
+	QVector< PlaySession > history;  ///< the most recent sessions, the newest one is the last
+
+	/// Content of a preset loaded from a binary options file that hasn't been decoded yet, empty when it's decoded.
+	/** Only the name and the separator flag are loaded up front, the rest is decoded when the preset is selected. */
+	QByteArray encodedContent;
+
+	static constexpr int maxHistoryLength = 20;
+
 	Preset() {}
 	Preset( const QString & name ) : name( name ) {}
 	Preset( const QFileInfo & ) {}  // dummy, it's required by the EditableListModel template, but isn't actually used
 
+	bool isContentDecoded() const           { return encodedContent.isEmpty(); }
+
 	// requirements of EditableListModel
 	bool isEditable() const                 { return true; }
 	const QString & getEditString() const   { return name; }
@@ -325,6 +382,8 @@ struct StorageSettings
 	OptionsStorage audioOptsStorage = StoreGlobally;
 };
 
+constexpr int defaultResourceSamplingPeriod_ms = 500;  ///< often enough to see the loading phases, rarely enough to not disturb the engine
+
 /// Additional launcher settings
 struct LauncherSettings : public StorageSettings  // inherited instead of included to avoid long identifiers
 {
@@ -333,6 +392,12 @@ struct LauncherSettings : public StorageSettings  // inherited instead of includ
 	PathStyle pathStyle = defaultPathStyle;
 	bool showEngineOutput = showEngineOutputByDefault;
 	bool closeOnLaunch = false;
+	bool logEngineOutput = false;  ///< save the engine output to files in the app data dir
+	// both off by default, because every launch would then add its measurements to the options file
+	bool monitorEngineResources = false;  ///< measure CPU and memory usage of the engine in the output window (Linux only)
+	int resourceSamplingPeriod_ms = defaultResourceSamplingPeriod_ms;
+	bool profileEngineStartup = false;  ///< measure duration of the engine initialization phases in the output window
+	bool binaryOptionsFile = false;  ///< store the options in a binary file that loads faster when there are many presets
 	bool checkForUpdates = true;
 	bool askForSandboxPermissions = true;
 
@@ -0,0 +1,339 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: incremental decoding of a process output stream with UTF-8 text and ANSI escape sequences
+//======================================================================================================================
+
+#include "ConsoleOutputDecoder.hpp"
+
+#include <algorithm>
+
+
+//======================================================================================================================
+//  colors
+
+// https://en.wikipedia.org/wiki/ANSI_escape_code#Colors
+// The "Campbell" scheme of the Windows Terminal, which matches the default colors of the process output window.
+static const QRgb basicColors [16] =
+{
+	qRgb(  12,  12,  12 ),  // black
+	qRgb( 197,  15,  31 ),  // red
+	qRgb(  19, 161,  14 ),  // green
+	qRgb( 193, 156,   0 ),  // yellow
+	qRgb(   0,  55, 218 ),  // blue
+	qRgb( 136,  23, 152 ),  // magenta
+	qRgb(  58, 150, 221 ),  // cyan
+	qRgb( 204, 204, 204 ),  // white
+	qRgb( 118, 118, 118 ),  // bright black
+	qRgb( 231,  72,  86 ),  // bright red
+	qRgb(  22, 198,  12 ),  // bright green
+	qRgb( 249, 241, 165 ),  // bright yellow
+	qRgb(  59, 120, 255 ),  // bright blue
+	qRgb( 180,   0, 158 ),  // bright magenta
+	qRgb(  97, 214, 214 ),  // bright cyan
+	qRgb( 242, 242, 242 ),  // bright white
+};
+
+/// Converts an index of the xterm 256-color palette to RGB.
+static QColor paletteColor( int colorIdx )
+{
+	if (colorIdx < 0 || colorIdx > 255)
+	{
+		return {};
+	}
+	else if (colorIdx < 16)
+	{
+		return QColor( basicColors[ colorIdx ] );
+	}
+	else if (colorIdx < 232)  // 6x6x6 color cube
+	{
+		int cubeIdx = colorIdx - 16;
+		auto level = []( int component ) { return component ? component * 40 + 55 : 0; };
+		return QColor( level( cubeIdx / 36 ), level( (cubeIdx / 6) % 6 ), level( cubeIdx % 6 ) );
+	}
+	else  // grayscale ramp
+	{
+		int gray = 8 + (colorIdx - 232) * 10;
+		return QColor( gray, gray, gray );
+	}
+}
+
+
+//======================================================================================================================
+//  ConsoleOutputDecoder
+
+static constexpr uchar ESC = 0x1B;
+static constexpr uchar BEL = 0x07;
+
+void ConsoleOutputDecoder::reset()
+{
+	_state = State::Text;
+	_utf8Received = 0;
+	_utf8Expected = 0;
+	_codePoint = 0;
+	_paramCount = 0;
+	_format = ConsoleTextFormat();
+	_textLength = 0;
+}
+
+void ConsoleOutputDecoder::decode( const char * data, qint64 size, const TextSink & sink )
+{
+	const uchar * bytes = reinterpret_cast< const uchar * >( data );
+	for (qint64 pos = 0; pos < size; ++pos)
+	{
+		processByte( bytes[ pos ], sink );
+	}
+
+	// Incomplete characters and escape sequences remain in the state and will be finished by the next read.
+	flush( sink );
+}
+
+void ConsoleOutputDecoder::processByte( uchar byte, const TextSink & sink )
+{
+	if (_state != State::Text)
+	{
+		processEscapeByte( byte, sink );
+	}
+	else if (byte == ESC)
+	{
+		if (_utf8Expected > 0)  // the multi-byte character was interrupted
+			emitInvalidBytes( sink );
+		_state = State::Escape;
+	}
+	else
+	{
+		processUtf8Byte( byte, sink );
+	}
+}
+
+void ConsoleOutputDecoder::processUtf8Byte( uchar byte, const TextSink & sink )
+{
+	if (_utf8Expected > 0)
+	{
+		if ((byte & 0xC0) == 0x80)  // continuation byte
+		{
+			_utf8Bytes[ size_t( _utf8Received++ ) ] = byte;
+			_codePoint = (_codePoint << 6) | (byte & 0x3F);
+
+			if (_utf8Received == _utf8Expected)
+			{
+				// reject overlong encodings, surrogates and values out of the Unicode range
+				static const char32_t minCodePoints [5] = { 0, 0, 0x80, 0x800, 0x10000 };
+				if (_codePoint < minCodePoints[ _utf8Expected ] || _codePoint > 0x10FFFF
+				 || (_codePoint >= 0xD800 && _codePoint <= 0xDFFF))
+				{
+					emitInvalidBytes( sink );
+				}
+				else
+				{
+					emitChar( _codePoint, sink );
+					_utf8Received = 0;
+					_utf8Expected = 0;
+				}
+			}
+			return;
+		}
+
+		// the multi-byte character was interrupted, this byte starts something new
+		emitInvalidBytes( sink );
+	}
+
+	auto startSequence = [&]( int length, char32_t initialBits )
+	{
+		_utf8Bytes[0] = byte;
+		_utf8Received = 1;
+		_utf8Expected = length;
+		_codePoint = initialBits;
+	};
+
+	if (byte < 0x80)
+	{
+		// drop control characters that the view can't display, like BEL
+		if (byte >= 0x20 || byte == '\n' || byte == '\r' || byte == '\t')
+			if (byte != 0x7F)
+				emitChar( byte, sink );
+	}
+	else if ((byte & 0xE0) == 0xC0)
+	{
+		startSequence( 2, byte & 0x1F );
+	}
+	else if ((byte & 0xF0) == 0xE0)
+	{
+		startSequence( 3, byte & 0x0F );
+	}
+	else if ((byte & 0xF8) == 0xF0)
+	{
+		startSequence( 4, byte & 0x07 );
+	}
+	else  // stray continuation byte or invalid lead byte
+	{
+		emitChar( byte, sink );  // Latin-1
+	}
+}
+
+void ConsoleOutputDecoder::emitInvalidBytes( const TextSink & sink )
+{
+	// Not UTF-8 after all, most likely some 8-bit encoding. Latin-1 is the best guess we have.
+	for (int i = 0; i < _utf8Received; ++i)
+		emitChar( _utf8Bytes[ size_t(i) ], sink );
+
+	_utf8Received = 0;
+	_utf8Expected = 0;
+}
+
+void ConsoleOutputDecoder::processEscapeByte( uchar byte, const TextSink & sink )
+{
+	switch (_state)
+	{
+		case State::Escape:
+			if (byte == '[')  // Control Sequence Introducer
+			{
+				_state = State::Csi;
+				_params[0] = 0;
+				_paramCount = 1;
+			}
+			else if (byte == ']' || byte == 'P' || byte == 'X' || byte == '^' || byte == '_')  // OSC, DCS, SOS, PM, APC
+			{
+				_state = State::String;
+			}
+			else if (byte >= 0x20 && byte <= 0x2F)
+			{
+				// intermediate byte (character set selection, ...), the sequence continues until the final byte
+			}
+			else
+			{
+				_state = State::Text;  // a two-byte sequence we don't support, drop it
+			}
+			break;
+
+		case State::Csi:
+			if (byte >= '0' && byte <= '9')
+			{
+				if (_paramCount <= maxParams)
+				{
+					int & param = _params[ size_t( _paramCount - 1 ) ];
+					param = std::min( param * 10 + (byte - '0'), 0xFFFF );
+				}
+			}
+			else if (byte == ';' || byte == ':')
+			{
+				++_paramCount;
+				if (_paramCount <= maxParams)
+					_params[ size_t( _paramCount - 1 ) ] = 0;  // missing parameter means 0
+			}
+			else if (byte >= 0x20 && byte <= 0x3F)
+			{
+				// private parameters like '?', not used in SGR
+			}
+			else if (byte >= 0x40 && byte <= 0x7E)  // final byte
+			{
+				if (byte == 'm')  // Select Graphic Rendition
+					applySgrParams( sink );
+				// other sequences move the cursor or erase the screen, which makes no sense in a scrolling log
+				_state = State::Text;
+			}
+			else
+			{
+				_state = State::Text;  // malformed sequence
+			}
+			break;
+
+		case State::String:
+			if (byte == BEL)
+				_state = State::Text;
+			else if (byte == ESC)
+				_state = State::StringEsc;
+			break;
+
+		case State::StringEsc:
+			_state = byte == '\\' ? State::Text : State::String;  // ESC \ is the String Terminator
+			break;
+
+		default:
+			_state = State::Text;
+			break;
+	}
+}
+
+void ConsoleOutputDecoder::parseExtendedColor( int & paramIdx, int paramCount, QColor & color ) const
+{
+	// 38;5;<idx> or 38;2;<r>;<g>;<b>
+	if (paramIdx + 1 >= paramCount)
+		return;
+
+	int mode = _params[ size_t( paramIdx + 1 ) ];
+	if (mode == 5 && paramIdx + 2 < paramCount)
+	{
+		color = paletteColor( _params[ size_t( paramIdx + 2 ) ] );
+		paramIdx += 2;
+	}
+	else if (mode == 2 && paramIdx + 4 < paramCount)
+	{
+		auto component = [&]( int offset ) { return std::min( _params[ size_t( paramIdx + offset ) ], 255 ); };
+		color = QColor( component(2), component(3), component(4) );
+		paramIdx += 4;
+	}
+	else
+	{
+		paramIdx += 1;
+	}
+}
+
+void ConsoleOutputDecoder::applySgrParams( const TextSink & sink )
+{
+	ConsoleTextFormat newFormat = _format;
+
+	const int paramCount = std::min( _paramCount, maxParams );
+	for (int paramIdx = 0; paramIdx < paramCount; ++paramIdx)
+	{
+		const int param = _params[ size_t( paramIdx ) ];
+		if (param == 0)                       newFormat = ConsoleTextFormat();
+		else if (param == 1)                  newFormat.bold = true;
+		else if (param == 3)                  newFormat.italic = true;
+		else if (param == 4)                  newFormat.underline = true;
+		else if (param == 22)                 newFormat.bold = false;
+		else if (param == 23)                 newFormat.italic = false;
+		else if (param == 24)                 newFormat.underline = false;
+		else if (param >= 30 && param <= 37)  newFormat.foreground = paletteColor( param - 30 );
+		else if (param == 38)                 parseExtendedColor( paramIdx, paramCount, newFormat.foreground );
+		else if (param == 39)                 newFormat.foreground = QColor();
+		else if (param >= 40 && param <= 47)  newFormat.background = paletteColor( param - 40 );
+		else if (param == 48)                 parseExtendedColor( paramIdx, paramCount, newFormat.background );
+		else if (param == 49)                 newFormat.background = QColor();
+		else if (param >= 90 && param <= 97)  newFormat.foreground = paletteColor( param - 90 + 8 );
+		else if (param >= 100 && param <= 107) newFormat.background = paletteColor( param - 100 + 8 );
+		// the rest (blinking, strike-through, fonts, ...) is ignored
+	}
+
+	if (newFormat != _format)
+	{
+		flush( sink );  // the text decoded so far belongs to the old format
+		_format = newFormat;
+	}
+}
+
+void ConsoleOutputDecoder::emitChar( char32_t codePoint, const TextSink & sink )
+{
+	if (_textLength + 2 > textBufferSize)
+		flush( sink );
+
+	if (QChar::requiresSurrogates( uint( codePoint ) ))
+	{
+		_text[ size_t( _textLength++ ) ] = QChar( QChar::highSurrogate( uint( codePoint ) ) );
+		_text[ size_t( _textLength++ ) ] = QChar( QChar::lowSurrogate( uint( codePoint ) ) );
+	}
+	else
+	{
+		_text[ size_t( _textLength++ ) ] = QChar( ushort( codePoint ) );
+	}
+}
+
+void ConsoleOutputDecoder::flush( const TextSink & sink )
+{
+	if (_textLength > 0)
+	{
+		sink( _text.data(), _textLength, _format );
+		_textLength = 0;
+	}
+}
@@ -0,0 +1,115 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: incremental decoding of a process output stream with UTF-8 text and ANSI escape sequences
+//======================================================================================================================
+
+#ifndef CONSOLE_OUTPUT_DECODER_INCLUDED
+#define CONSOLE_OUTPUT_DECODER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <QChar>
+#include <QColor>
+
+#include <array>
+#include <functional>
+
+
+//======================================================================================================================
+
+/// Visual attributes of a piece of console text, set by ANSI SGR escape sequences.
+struct ConsoleTextFormat
+{
+	QColor foreground;  ///< invalid color means the default color of the view
+	QColor background;  ///< invalid color means the default color of the view
+	bool bold = false;
+	bool italic = false;
+	bool underline = false;
+
+	bool isDefault() const
+	{
+		return !foreground.isValid() && !background.isValid() && !bold && !italic && !underline;
+	}
+
+	friend bool operator==( const ConsoleTextFormat & f1, const ConsoleTextFormat & f2 )
+	{
+		return f1.foreground == f2.foreground && f1.background == f2.background
+		    && f1.bold == f2.bold && f1.italic == f2.italic && f1.underline == f2.underline;
+	}
+	friend bool operator!=( const ConsoleTextFormat & f1, const ConsoleTextFormat & f2 )  { return !(f1 == f2); }
+};
+
+
+//======================================================================================================================
+/// Converts raw bytes read from a process pipe to formatted text, one read at a time.
+/** The state is kept between the calls, so multi-byte characters and escape sequences split between two reads
+  * are decoded correctly. Each byte is processed exactly once and the text is passed to the sink directly
+  * from an internal fixed-size buffer, without allocating any intermediate strings.
+  * Bytes that are not valid UTF-8 are interpreted as Latin-1, because older engines print in local 8-bit encodings.
+  * Escape sequences other than SGR (cursor movement, window title, ...) are recognized and dropped. */
+
+class ConsoleOutputDecoder {
+
+ public:
+
+	/// Receives a decoded piece of text, in which all characters have the same format.
+	using TextSink = std::function< void ( const QChar * text, int length, const ConsoleTextFormat & format ) >;
+
+	/// Decodes the next piece of the stream and passes the text to the sink in one or more calls.
+	void decode( const char * data, qint64 size, const TextSink & sink );
+
+	/// Forgets all the state, call when a new stream starts.
+	void reset();
+
+	const ConsoleTextFormat & currentFormat() const  { return _format; }
+
+ private:
+
+	void processByte( uchar byte, const TextSink & sink );
+	void processUtf8Byte( uchar byte, const TextSink & sink );
+	void processEscapeByte( uchar byte, const TextSink & sink );
+	void applySgrParams( const TextSink & sink );
+	void parseExtendedColor( int & paramIdx, int paramCount, QColor & color ) const;
+
+	void emitChar( char32_t codePoint, const TextSink & sink );
+	void emitInvalidBytes( const TextSink & sink );
+	void flush( const TextSink & sink );
+
+ private:
+
+	enum class State
+	{
+		Text,
+		Escape,     ///< ESC received
+		Csi,        ///< ESC [ received, reading parameters
+		String,     ///< ESC ] or similar received, reading until ST or BEL
+		StringEsc,  ///< ESC received inside a string, possibly the start of ST
+	};
+
+	State _state = State::Text;
+
+	// UTF-8 decoding
+	std::array< uchar, 4 > _utf8Bytes;
+	int _utf8Received = 0;
+	int _utf8Expected = 0;
+	char32_t _codePoint = 0;
+
+	// escape sequence parameters
+	static constexpr int maxParams = 16;
+	std::array< int, maxParams > _params;
+	int _paramCount = 0;  ///< can be higher than maxParams, the extra ones are dropped
+
+	ConsoleTextFormat _format;
+
+	// decoded text waiting to be passed to the sink
+	static constexpr int textBufferSize = 2048;
+	std::array< QChar, textBufferSize > _text;
+	int _textLength = 0;
+
+};
+
+
+#endif // CONSOLE_OUTPUT_DECODER_INCLUDED
@@ -12,11 +12,18 @@
 //#include "StandardOutput.hpp"
 #include "OSUtils.hpp"          // getThisAppDataDir
 #include "FileSystemUtils.hpp"  // getPathFromFileName
+#include "LogFileWriter.hpp"
 
 #include <QStringBuilder>
 #include <QMessageBox>
 #include <QDebug>
 #include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <optional>
+#include <cstring>  // strlen
 
 
 //======================================================================================================================
@@ -75,6 +82,31 @@ const char * logLevelToStr( LogLevel level )
 		return "INVALID";
 }
 
+std::atomic< int > g_minLogLevel { fut::to_underlying( LogLevel::Debug ) };
+std::atomic< bool > g_componentLogLevelsSet { false };
+
+static QMutex & componentLogLevelsMutex()
+{
+	static QMutex mutex;
+	return mutex;
+}
+static QHash< QByteArray, int > & componentLogLevels()
+{
+	static QHash< QByteArray, int > levels;
+	return levels;
+}
+
+bool isLogEnabledForComponent( LogLevel level, const char * componentName )
+{
+	int minLevel = g_minLogLevel.load( std::memory_order_relaxed );
+	{
+		QMutexLocker locker( &componentLogLevelsMutex() );
+		// the component names are string literals, no need to copy them for the lookup
+		minLevel = componentLogLevels().value( QByteArray::fromRawData( componentName, int( strlen( componentName ) ) ), minLevel );
+	}
+	return fut::to_underlying( level ) >= minLevel;
+}
+
 static const char * const logFileName = "errors.txt";
 
 const QString & getCachedErrorFilePath()
@@ -84,18 +116,37 @@ const QString & getCachedErrorFilePath()
 	return logFilePath;
 }
 
+static std::atomic< LogFileWriter * > g_logFileWriter { nullptr };  ///< set when the writer is started
+static std::atomic< bool > g_logFileClosed { false };
+
+static void writeToLogFile( qint64 time_ms, QString line )
+{
+	if (g_logFileClosed.load( std::memory_order_relaxed ))
+		return;
+
+	// Started on the first error and stopped by closeLogFile(). It's never destroyed, so that errors logged
+	// during the destruction of other static objects don't use a destroyed object.
+	static LogFileWriter * const logFileWriter = g_logFileWriter = new LogFileWriter( getCachedErrorFilePath() );
+	logFileWriter->write( time_ms, std::move(line) );
+}
+
+void closeLogFile()
+{
+	g_logFileClosed.store( true, std::memory_order_relaxed );
+	if (LogFileWriter * logFileWriter = g_logFileWriter.load())
+		logFileWriter->stop();
+}
+
 LogStream::LogStream( LogLevel level, const char * component )
 :
 	_debugStream( debugStreamFromLogLevel( level ) ),
-	_logFile( getCachedErrorFilePath() ),
 	_logLevel( level )
 {
 	_debugStream.noquote().nospace();
 
 	if (shouldWriteToFileStream())
 	{
-		if (_logFile.open( QIODevice::Append ))
-			_fileStream.setDevice( &_logFile );
+		_fileStream.setString( &_fileLine, QIODevice::WriteOnly );
 	}
 
 	writeLineOpening( level, component );
@@ -105,9 +156,10 @@ LogStream::~LogStream()
 {
 	if (shouldAndCanWriteToFileStream())
 	{
-		_fileStream << Qt::endl;
+		// the time is taken now, but formatted in the background thread together with the rest of the file I/O
+		_fileStream.flush();
+		writeToLogFile( QDateTime::currentMSecsSinceEpoch(), std::move(_fileLine) );
 	}
-	// log file is closed automatically
 }
 
 QDebug LogStream::debugStreamFromLogLevel( LogLevel level )
@@ -134,10 +186,56 @@ void LogStream::writeLineOpening( LogLevel level, const char * component )
 
 	if (shouldAndCanWriteToFileStream())
 	{
-		auto currentTime = QDateTime::currentDateTime().toString( Qt::DateFormat::ISODate );
-
-		_fileStream << QStringLiteral("[%1] [%2] %3").arg( currentTime ).arg( logLevelStr, -7 ).arg( componentStr );
+		_fileStream << QStringLiteral("[%1] %2").arg( logLevelStr, -7 ).arg( componentStr );
 	}
 }
 
 } // namespace impl
+
+
+//======================================================================================================================
+//  log filtering
+
+static std::optional< impl::LogLevel > parseLogLevel( const QString & levelStr )
+{
+	for (size_t i = 0; i < std::size( impl::LogLevelStrings ); ++i)
+		if (levelStr.compare( impl::LogLevelStrings[i], Qt::CaseInsensitive ) == 0)
+			return impl::LogLevel( i );
+	return std::nullopt;
+}
+
+QString setLogLevels( const QString & spec )
+{
+	std::optional< impl::LogLevel > minLevel;
+	QHash< QByteArray, int > componentLevels;
+
+	const QStringList items = spec.split( ',' );
+	for (const QString & item : items)
+	{
+		if (item.trimmed().isEmpty())
+			continue;
+
+		int separatorPos = item.indexOf( '=' );
+		QString componentName = separatorPos >= 0 ? item.left( separatorPos ).trimmed() : QString();
+		QString levelStr = separatorPos >= 0 ? item.mid( separatorPos + 1 ).trimmed() : item.trimmed();
+
+		auto level = parseLogLevel( levelStr );
+		if (!level)
+			return "invalid log level: " + levelStr;
+
+		if (componentName.isEmpty())
+			minLevel = level;
+		else
+			componentLevels[ componentName.toUtf8() ] = fut::to_underlying( *level );
+	}
+
+	if (minLevel)
+		impl::g_minLogLevel.store( fut::to_underlying( *minLevel ), std::memory_order_relaxed );
+	{
+		QMutexLocker locker( &impl::componentLogLevelsMutex() );
+		impl::componentLogLevels() = std::move( componentLevels );
+		impl::g_componentLogLevelsSet.store( !impl::componentLogLevels().isEmpty(), std::memory_order_relaxed );
+	}
+
+	return {};
+}
@@ -16,7 +16,8 @@
 #include <QString>
 #include <QtCore/qdebug.h>
 #include <QTextStream>
-#include <QFile>
+
+#include <atomic>
 
 class QWidget;
 
@@ -51,11 +52,44 @@ enum class LogLevel
 };
 const char * logLevelToStr( LogLevel level );
 
+// Log statements below this level are removed by the compiler including the evaluation of their arguments.
+// Can be overriden by adding for example "DEFINES += LOG_MIN_LEVEL=Info" to the qmake project.
+#ifndef LOG_MIN_LEVEL
+	#if IS_DEBUG_BUILD
+		#define LOG_MIN_LEVEL Debug
+	#else
+		#define LOG_MIN_LEVEL Info
+	#endif
+#endif
+constexpr LogLevel compiledMinLogLevel = LogLevel::LOG_MIN_LEVEL;
+
+extern std::atomic< int > g_minLogLevel;  ///< level set at runtime for all components without their own level
+extern std::atomic< bool > g_componentLogLevelsSet;  ///< whether there is any component with its own level
+
+bool isLogEnabledForComponent( LogLevel level, const char * componentName );
+
+inline bool isLogEnabled( LogLevel level, const char * componentName )
+{
+	if (fut::to_underlying( level ) < fut::to_underlying( compiledMinLogLevel ))
+		return false;
+	if (fut::to_underlying( level ) >= fut::to_underlying( LogLevel::Failure ))
+		return true;  // errors are never filtered out
+	if (componentName && g_componentLogLevelsSet.load( std::memory_order_relaxed ))
+		return isLogEnabledForComponent( level, componentName );  // slow path only when asked for on the command line
+	return fut::to_underlying( level ) >= g_minLogLevel.load( std::memory_order_relaxed );
+}
+
+/// Allows the LOG_ macros to be used without a component name.
+constexpr const char * logComponentArg( const char * componentName = nullptr )
+{
+	return componentName;
+}
+
 /// Stream wrapper that logs to multiple streams depending on log level and build type
 class LogStream
 {
 	QDebug _debugStream;
-	QFile _logFile;
+	QString _fileLine;  ///< the line is composed here and then handed over to the background thread that writes the file
 	QTextStream _fileStream;
 
 	LogLevel _logLevel;
@@ -132,7 +166,7 @@ class LogStream
 
 	inline bool shouldAndCanWriteToFileStream() const
 	{
-		return _logFile.isOpen(); //&& shouldWriteToFileStream()  redundant, log file is always open when should write
+		return _fileStream.string() != nullptr; //&& shouldWriteToFileStream()  redundant, string is set only when needed
 	}
 };
 
@@ -188,6 +222,42 @@ inline auto logLogicError( const char * componentName = nullptr )
 }
 
 
+/// Whether a message of this level from this component passes the filters, the LOG_ macros skip it otherwise.
+inline bool isLogEnabled( impl::LogLevel level, const char * componentName = nullptr )
+{
+	return impl::isLogEnabled( level, componentName );
+}
+
+/// Changes which messages are logged, the spec is a comma-separated list of "<level>" or "<component>=<level>",
+/// for example "info,WADReader=debug". Errors are always logged. Returns an error message or empty string.
+QString setLogLevels( const QString & spec );
+
+/// Writes the remaining records into the log file and closes it, should be called at the end of main().
+/** Messages logged after this are written only to the standard error output. */
+void closeLogFile();
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  level-gated logging macros
+
+// Usage:
+//
+//   LOG_DEBUG() << "reading file " << filePath;          // in a method of a LoggingComponent or in a free function
+//   LOG_INFO("ExeReader") << "found " << count << " resources";   // in a free function with a component name
+//
+// Unlike calling logDebug() directly, neither the log stream is constructed nor the arguments are evaluated
+// when the message is filtered out, and only these macros respect the levels set by setLogLevels().
+// In builds where the level is below LOG_MIN_LEVEL the whole statement is removed by the compiler.
+// Inside a LoggingComponent, the unqualified names resolve to its own methods.
+// The if-else form keeps the macro safe to use as the body of another if-else.
+
+#define LOG_AT_LEVEL( level, logFunc, ... ) \
+	if (!isLogEnabled( level, impl::logComponentArg( __VA_ARGS__ ) )) {} else logFunc( __VA_ARGS__ )
+
+#define LOG_DEBUG( ... ) LOG_AT_LEVEL( impl::LogLevel::Debug, logDebug, __VA_ARGS__ )
+#define LOG_INFO( ... ) LOG_AT_LEVEL( impl::LogLevel::Info, logInfo, __VA_ARGS__ )
+
+
 //----------------------------------------------------------------------------------------------------------------------
 //  logging helpers for simplifying logging even further
 
@@ -204,6 +274,12 @@ class LoggingComponent {
 	auto logInfo() const           { return ::logInfo( _componentName ); }
 	auto logDebug() const          { return ::logDebug( _componentName ); }
 
+	/// Used by the LOG_ macros, the second parameter only allows them to be the same as outside of the component.
+	bool isLogEnabled( impl::LogLevel level, const char * = nullptr ) const
+	{
+		return impl::isLogEnabled( level, _componentName );
+	}
+
  private:
 
 	const char * _componentName;
@@ -0,0 +1,198 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: extracting executable information by running it with informational command line parameters
+//======================================================================================================================
+
+#include "ExeProber.hpp"
+
+#include "FileSystemUtils.hpp"  // getAbsolutePath
+
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSet>
+
+
+namespace os {
+
+
+//======================================================================================================================
+//  probing
+
+static constexpr int maxInspectedLines = 20;  ///< the name and version is always at the beginning of the output
+
+static constexpr int defaultProbeTimeout_ms = 3000;
+
+/// Runs the executable and returns its merged stdout and stderr, or null string if it couldn't be started.
+static QString runAndCaptureOutput( const QString & filePath, const QStringList & arguments, int timeout_ms )
+{
+	QProcess process;
+
+	process.setProgram( fs::getAbsolutePath( filePath ) );
+	process.setArguments( arguments );
+	process.setProcessChannelMode( QProcess::MergedChannels );
+	process.setStandardInputFile( QProcess::nullDevice() );
+
+	// Some engines don't know the parameter and start the game instead. Don't let them open a window or play sounds.
+	QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+	env.insert( "SDL_VIDEODRIVER", "dummy" );
+	env.insert( "SDL_AUDIODRIVER", "dummy" );
+	process.setProcessEnvironment( env );
+
+	process.start();
+	if (!process.waitForStarted( timeout_ms ))
+	{
+		return {};
+	}
+
+	if (!process.waitForFinished( timeout_ms ))
+	{
+		// whatever it printed so far is still useful
+		process.kill();
+		process.waitForFinished( 1000 );
+	}
+
+	QString output = QString::fromUtf8( process.readAll() );
+	if (output.isNull())
+		output = "";  // distinguish empty output from a failure to start
+	return output;
+}
+
+/// Finds a line like "GZDoom g4.11.3 - 2023-09-25" or "Chocolate Doom 3.0.1" and extracts the name and version from it.
+static bool parseNameAndVersion( const QString & output, ExeVersionInfo & exeInfo )
+{
+	static const QRegularExpression nameVersionRegex(
+		"^\\s*([A-Za-z][A-Za-z0-9+_ -]*?)\\s+(?:version\\s+)?[vgr]?(\\d+\\.\\d+(?:\\.\\d+){0,2})\\b",
+		QRegularExpression::CaseInsensitiveOption
+	);
+
+	const QStringList lines = output.split( '\n' );
+	for (int lineIdx = 0; lineIdx < lines.size() && lineIdx < maxInspectedLines; ++lineIdx)
+	{
+		QString line = lines[ lineIdx ].trimmed();
+		auto match = nameVersionRegex.match( line );
+		if (match.hasMatch())
+		{
+			exeInfo.appName = match.captured(1).trimmed();
+			exeInfo.version = Version( match.captured(2) );
+			exeInfo.description = line;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/// Collects all the lines that start with a command line parameter, like "-file <files>" or "+map <mapname>".
+static QStringVec parseSupportedParams( const QString & output )
+{
+	static const QRegularExpression paramRegex( "^\\s*([-+][A-Za-z][A-Za-z0-9_-]*)" );
+
+	QStringVec params;
+	QSet< QString > alreadyAdded;
+
+	const QStringList lines = output.split( '\n' );
+	for (const QString & line : lines)
+	{
+		auto match = paramRegex.match( line );
+		if (match.hasMatch())
+		{
+			QString param = match.captured(1);
+			if (!alreadyAdded.contains( param ))
+			{
+				alreadyAdded.insert( param );
+				params.append( std::move(param) );
+			}
+		}
+	}
+
+	return params;
+}
+
+UncertainExeVersionInfo probeExeVersionInfo( const QString & filePath, int timeout_ms )
+{
+	UncertainExeVersionInfo exeInfo;
+
+	QString versionOutput = runAndCaptureOutput( filePath, { "--version" }, timeout_ms );
+	if (versionOutput.isNull())
+	{
+		exeInfo.status = ReadStatus::CantOpen;
+		return exeInfo;
+	}
+
+	bool versionFound = parseNameAndVersion( versionOutput, exeInfo );
+
+	// The help output is the only way to find the parameters, and some engines print their version only there.
+	QString helpOutput = runAndCaptureOutput( filePath, { "-help" }, timeout_ms );
+	if (!versionFound && !helpOutput.isNull())
+	{
+		versionFound = parseNameAndVersion( helpOutput, exeInfo );
+	}
+	exeInfo.supportedParams = parseSupportedParams( helpOutput );
+
+	exeInfo.status = versionFound ? ReadStatus::Success : ReadStatus::InfoNotPresent;
+	return exeInfo;
+}
+
+
+//======================================================================================================================
+//  ExeProber
+
+struct ProbeResult
+{
+	qint64 lastModified = 0;  ///< modification time of the file at the moment it was probed
+	UncertainExeVersionInfo exeInfo;
+};
+
+ExeProber::ExeProber()
+:
+	LoggingComponent("ExeProber")
+{
+	qRegisterMetaType< os::UncertainExeVersionInfo >();
+}
+
+ExeProber::~ExeProber()
+{
+	stop();
+}
+
+void ExeProber::probeAsync( const QStringVec & executablePaths )
+{
+	for (const QString & filePath : executablePaths)
+	{
+		LOG_DEBUG() << "probing " << filePath;
+		tasks::sharedScheduler().submitWithResult( tasks::Priority::BackgroundIdle, probeTasks,
+			/*work*/[ filePath ]( const tasks::CancellationToken & token )
+			{
+				// This will run in a worker thread of the scheduler.
+
+				ProbeResult result;
+				if (token.isCancelled())
+					return result;  // won't be delivered anyway
+
+				result.lastModified = QFileInfo( filePath ).lastModified().toSecsSinceEpoch();
+				result.exeInfo = probeExeVersionInfo( filePath, defaultProbeTimeout_ms );
+				return result;
+			},
+			/*receiver*/this,
+			/*onDone*/[ this, filePath ]( ProbeResult result )
+			{
+				// This will run in the thread of the prober, unless the probes have been stopped in the meantime.
+				emit exeProbed( filePath, result.lastModified, result.exeInfo );
+			}
+		);
+	}
+}
+
+void ExeProber::stop()
+{
+	probeTasks.cancel();  // the tasks that haven't started yet will be dropped
+	probeTasks.waitForDone();  // every probe has a timeout, so this can't take forever
+}
+
+
+} // namespace os
@@ -0,0 +1,74 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: extracting executable information by running it with informational command line parameters
+//======================================================================================================================
+
+#ifndef EXE_PROBER_INCLUDED
+#define EXE_PROBER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "CommonTypes.hpp"
+#include "ExeReader.hpp"  // UncertainExeVersionInfo
+#include "ErrorHandling.hpp"  // LoggingComponent
+#include "TaskScheduler.hpp"
+
+#include <QObject>
+#include <QString>
+
+
+namespace os {
+
+
+//======================================================================================================================
+
+/// Runs the executable with --version and -help and extracts its name, version and supported parameters from the output.
+/** This is an alternative to readExeVersionInfo() for systems where executables don't have a version resource.
+  * It's a blocking call that can take up to 2 * timeout_ms, so it should never be run in the main thread.
+  * The application is started with dummy video and audio drivers, in case it ignores the parameters and starts anyway. */
+UncertainExeVersionInfo probeExeVersionInfo( const QString & filePath, int timeout_ms );
+
+
+//======================================================================================================================
+/// Probes several executables in parallel in the background threads of the shared task scheduler.
+/** Results are delivered via signal in the thread that constructed this object, after stop() no more are delivered.
+  * The FileInfoCache is not thread-safe, so it's up to the receiver to store the results. */
+
+class ExeProber : public QObject, protected LoggingComponent {
+
+	Q_OBJECT
+
+ public:
+
+	ExeProber();
+	virtual ~ExeProber() override;
+
+	/// Starts probing the executables in background threads, results are reported one by one via exeProbed().
+	void probeAsync( const QStringVec & executablePaths );
+
+	/// Waits for the running probes to finish and drops the ones that haven't started yet.
+	void stop();
+
+ signals:
+
+	/// Emitted for every executable that has been probed.
+	/** \param lastModified Modification time of the file at the moment it was probed, to be stored in the cache. */
+	void exeProbed( const QString & filePath, qint64 lastModified, const os::UncertainExeVersionInfo & exeInfo );
+
+ private:
+
+	tasks::TaskGroup probeTasks;  ///< the probes run in the background lane, so they don't block the more important tasks
+
+};
+
+
+} // namespace os
+
+// without this we cannot use our own types as parameters of signals and in QVariant
+Q_DECLARE_METATYPE( os::UncertainExeVersionInfo )
+
+
+#endif // EXE_PROBER_INCLUDED
@@ -11,6 +11,7 @@
 #include "ContainerUtils.hpp"  // span
 #include "JsonUtils.hpp"
 #include "ErrorHandling.hpp"
+#include "Tracing.hpp"
 
 #include <QFile>
 #include <QFileInfo>
@@ -20,6 +21,13 @@
 #if IS_WINDOWS
 	#include <windows.h>
 	#include <strsafe.h>
+#else
+	#include <QVector>
+	#include <QRegularExpression>
+	#include <QtEndian>
+	#include <algorithm>
+	#include <cstring>
+	#include <cctype>
 #endif
 
 
@@ -93,7 +101,7 @@ bool Resource::load( const QString & filePath, HMODULE hExeModule, LPWSTR lpType
 	{
 		// this resource is optional, some exe files don't have it
 		auto lastError = GetLastError();
-		logDebug("ExeReader") << "Cannot find resource "<<lpType<<" in "<<filePath<<", FindResource() failed with error "<<lastError;
+		LOG_DEBUG("ExeReader") << "Cannot find resource "<<lpType<<" in "<<filePath<<", FindResource() failed with error "<<lastError;
 		return false;
 	}
 
@@ -246,7 +254,7 @@ QString LoggingExeReader::getVerInfoValue( const Resource & res, const LangInfo
 	}
 	else if (cchLen == 0)
 	{
-		logInfo() << "Cannot read file info value "<<QStr(valueName)<<" of "<<_filePath<<", VerQueryValue("<<QStr(subBlock)<<") returned empty string";
+		LOG_INFO() << "Cannot read file info value "<<QStr(valueName)<<" of "<<_filePath<<", VerQueryValue("<<QStr(subBlock)<<") returned empty string";
 		return {};
 	}
 
@@ -304,20 +312,327 @@ UncertainExeVersionInfo LoggingExeReader::readVersionInfo()
 #endif // IS_WINDOWS
 
 
+//======================================================================================================================
+//  Linux
+
+#if !IS_WINDOWS
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  ELF file access
+
+// https://refspecs.linuxfoundation.org/elf/gabi4+/ch4.eheader.html
+// https://refspecs.linuxfoundation.org/elf/gabi4+/ch4.sheader.html
+
+static const uchar elfMagic [4] = { 0x7F, 'E', 'L', 'F' };
+
+enum ElfClass : uchar
+{
+	Elf32 = 1,
+	Elf64 = 2,
+};
+
+enum ElfDataEncoding : uchar
+{
+	ElfLittleEndian = 1,
+	ElfBigEndian = 2,
+};
+
+static constexpr quint32 SHT_NOBITS = 8;  ///< section occupies no space in the file (.bss)
+
+static constexpr int maxVersionStringLength = 128;
+
+/// Section of the ELF file, offsets are relative to the beginning of the file and already bounds-checked.
+struct ElfSection
+{
+	QByteArray name;
+	quint64 offset;
+	quint64 size;
+};
+
+/// Bounds-checked reading of values from the mapped file in the byte order and word size of the ELF file.
+class ElfView {
+
+ public:
+
+	ElfView( const uchar * data, qint64 size, bool is64bit, bool isBigEndian )
+		: _data( data ), _size( quint64( size ) ), _is64bit( is64bit ), _isBigEndian( isBigEndian ) {}
+
+	const uchar * data() const  { return _data; }
+	bool is64bit() const        { return _is64bit; }
+
+	bool contains( quint64 offset, quint64 length ) const
+	{
+		return offset <= _size && length <= _size - offset;
+	}
+
+	template< typename Int >
+	Int read( quint64 offset ) const  // the caller is responsible for checking the bounds
+	{
+		return _isBigEndian ? qFromBigEndian< Int >( _data + offset ) : qFromLittleEndian< Int >( _data + offset );
+	}
+
+	/// Reads a field that is 32-bit in 32-bit ELF and 64-bit in 64-bit ELF.
+	quint64 readWord( quint64 offset ) const
+	{
+		return _is64bit ? read< quint64 >( offset ) : read< quint32 >( offset );
+	}
+
+ private:
+
+	const uchar * _data;
+	quint64 _size;
+	bool _is64bit;
+	bool _isBigEndian;
+
+};
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  logging helper
+
+class LoggingElfReader : protected LoggingComponent {
+
+ public:
+
+	LoggingElfReader( QString filePath ) : LoggingComponent("ExeReader"), _filePath( std::move(filePath) ) {}
+
+	UncertainExeVersionInfo readVersionInfo();
+
+ private:
+
+	QVector< ElfSection > readSections( const ElfView & elf );
+	bool findVersionString( const ElfView & elf, const ElfSection & section, const QString & exeName, ExeVersionInfo & verInfo );
+
+ private:
+
+	QString _filePath;
+
+};
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  version info extraction
+
+/// Converts the name to a form in which "Chocolate Doom" matches "chocolate-doom".
+static QString normalizeAppName( const QString & name )
+{
+	QString normalized;
+	normalized.reserve( name.size() );
+	for (QChar c : name)
+		if (c.isLetterOrNumber())
+			normalized += c.toLower();
+	return normalized;
+}
+
+QVector< ElfSection > LoggingElfReader::readSections( const ElfView & elf )
+{
+	QVector< ElfSection > sections;
+
+	// positions of the section header table fields in the ELF header differ between 32-bit and 64-bit files
+	const quint64 headerSize    = elf.is64bit() ? 0x40 : 0x34;
+	const quint64 shoffPos      = elf.is64bit() ? 0x28 : 0x20;
+	const quint64 shentsizePos  = elf.is64bit() ? 0x3A : 0x2E;
+	const quint64 shnumPos      = elf.is64bit() ? 0x3C : 0x30;
+	const quint64 shstrndxPos   = elf.is64bit() ? 0x3E : 0x32;
+
+	if (!elf.contains( 0, headerSize ))
+	{
+		logRuntimeError() << "Cannot read sections of "<<_filePath<<", the ELF header is truncated";
+		return {};
+	}
+
+	const quint64 sectionTableOffset = elf.readWord( shoffPos );
+	const quint16 sectionHeaderSize  = elf.read< quint16 >( shentsizePos );
+	const quint16 sectionCount       = elf.read< quint16 >( shnumPos );
+	const quint16 namesSectionIdx    = elf.read< quint16 >( shstrndxPos );
+
+	// positions of the fields in the section header
+	const quint64 minSectionHeaderSize = elf.is64bit() ? 0x40 : 0x28;
+	const quint64 typePos   = 0x04;
+	const quint64 offsetPos = elf.is64bit() ? 0x18 : 0x10;
+	const quint64 sizePos   = elf.is64bit() ? 0x20 : 0x14;
+
+	if (sectionCount == 0 || sectionHeaderSize < minSectionHeaderSize || namesSectionIdx >= sectionCount
+	 || !elf.contains( sectionTableOffset, quint64( sectionCount ) * sectionHeaderSize ))
+	{
+		logRuntimeError() << "Cannot read sections of "<<_filePath<<", invalid section header table";
+		return {};
+	}
+
+	auto sectionHeaderPos = [&]( quint16 sectionIdx ) { return sectionTableOffset + quint64( sectionIdx ) * sectionHeaderSize; };
+
+	// section names are stored in a special string section
+	const quint64 namesOffset = elf.readWord( sectionHeaderPos( namesSectionIdx ) + offsetPos );
+	const quint64 namesSize   = elf.readWord( sectionHeaderPos( namesSectionIdx ) + sizePos );
+	if (!elf.contains( namesOffset, namesSize ))
+	{
+		logRuntimeError() << "Cannot read sections of "<<_filePath<<", invalid section name table";
+		return {};
+	}
+	const char * names = reinterpret_cast< const char * >( elf.data() + namesOffset );
+
+	sections.reserve( sectionCount );
+	for (quint16 sectionIdx = 0; sectionIdx < sectionCount; ++sectionIdx)
+	{
+		const quint64 headerPos = sectionHeaderPos( sectionIdx );
+
+		const quint32 nameOffset = elf.read< quint32 >( headerPos );
+		const quint32 type       = elf.read< quint32 >( headerPos + typePos );
+		const quint64 offset     = elf.readWord( headerPos + offsetPos );
+		const quint64 size       = elf.readWord( headerPos + sizePos );
+
+		if (type == SHT_NOBITS || nameOffset >= namesSize || !elf.contains( offset, size ))
+			continue;
+
+		// the name is null-terminated, but don't trust the file and don't go beyond the name table
+		const char * name = names + nameOffset;
+		const size_t nameLength = qstrnlen( name, uint( namesSize - nameOffset ) );
+
+		sections.append({ QByteArray( name, int( nameLength ) ), offset, size });
+	}
+
+	return sections;
+}
+
+bool LoggingElfReader::findVersionString(
+	const ElfView & elf, const ElfSection & section, const QString & exeName, ExeVersionInfo & verInfo
+){
+	// matches strings like "GZDoom g4.11.3" or "Chocolate Doom 3.0.1"
+	static const QRegularExpression nameVersionRegex(
+		"^([A-Za-z][A-Za-z0-9+_ -]*?)\\s+(?:version\\s+)?[vgr]?(\\d+\\.\\d+(?:\\.\\d+){0,2})\\b",
+		QRegularExpression::CaseInsensitiveOption
+	);
+
+	const char * const sectionBegin = reinterpret_cast< const char * >( elf.data() + section.offset );
+	const char * const sectionEnd = sectionBegin + section.size;
+	const int firstChar = exeName[0].toLatin1();  // already lower-case
+
+	// The sections contain tens of thousands of strings, so run the regex only on those that can possibly match.
+	const char * strBegin = sectionBegin;
+	while (strBegin < sectionEnd)
+	{
+		const char * strEnd = static_cast< const char * >( memchr( strBegin, '\0', size_t( sectionEnd - strBegin ) ) );
+		if (!strEnd)
+			strEnd = sectionEnd;
+
+		const auto strLength = strEnd - strBegin;
+		if (strLength >= exeName.size() && strLength < maxVersionStringLength && std::tolower( uchar( *strBegin ) ) == firstChar)
+		{
+			QString str = QString::fromLatin1( strBegin, int( strLength ) );
+			auto match = nameVersionRegex.match( str );
+			if (match.hasMatch() && normalizeAppName( match.captured(1) ) == exeName)
+			{
+				verInfo.appName = match.captured(1).trimmed();
+				verInfo.version = Version( match.captured(2) );
+				verInfo.description = str.trimmed();
+				return true;
+			}
+		}
+
+		strBegin = strEnd + 1;
+	}
+
+	return false;
+}
+
+UncertainExeVersionInfo LoggingElfReader::readVersionInfo()
+{
+	UncertainExeVersionInfo verInfo;
+
+	// Returning NotSupported when the version cannot be determined from the file itself,
+	// so that the caller knows it has to use a different method (ExeProber).
+	verInfo.status = ReadStatus::NotSupported;
+
+	// the file name is the only hint we have about which of the strings is the version of the application
+	QString exeName = normalizeAppName( QFileInfo( _filePath ).baseName() );
+	if (exeName.isEmpty() || exeName[0].unicode() > 0x7F)
+	{
+		return verInfo;
+	}
+
+	QFile file( _filePath );
+	if (!file.open( QIODevice::ReadOnly ))
+	{
+		logRuntimeError() << "Cannot open "<<_filePath<<": "<<file.errorString();
+		verInfo.status = ReadStatus::CantOpen;
+		return verInfo;
+	}
+
+	// Engine binaries can have tens of MB, let the OS load only the pages we actually touch.
+	// The mapping is released when the file is closed.
+	const qint64 fileSize = file.size();
+	const uchar * fileData = fileSize > 0 ? file.map( 0, fileSize ) : nullptr;
+	if (!fileData)
+	{
+		logRuntimeError() << "Cannot map "<<_filePath<<" into memory: "<<file.errorString();
+		verInfo.status = ReadStatus::FailedToRead;
+		return verInfo;
+	}
+
+	// shell scripts and other wrappers can't be read statically
+	if (fileSize < 16 || memcmp( fileData, elfMagic, sizeof(elfMagic) ) != 0)
+	{
+		LOG_DEBUG() << _filePath << " is not an ELF file";
+		return verInfo;
+	}
+
+	const uchar elfClass = fileData[4];
+	const uchar elfEncoding = fileData[5];
+	if ((elfClass != Elf32 && elfClass != Elf64) || (elfEncoding != ElfLittleEndian && elfEncoding != ElfBigEndian))
+	{
+		logRuntimeError() << "Cannot read "<<_filePath<<", unknown ELF class "<<int( elfClass )<<" or encoding "<<int( elfEncoding );
+		verInfo.status = ReadStatus::InvalidFormat;
+		return verInfo;
+	}
+
+	ElfView elf( fileData, fileSize, elfClass == Elf64, elfEncoding == ElfBigEndian );
+
+	// the small sections first, .rodata is the last resort
+	QVector< ElfSection > sections = readSections( elf );
+	std::stable_sort( sections.begin(), sections.end(), []( const ElfSection & s1, const ElfSection & s2 )
+	{
+		auto priority = []( const ElfSection & s ) { return s.name.startsWith(".note") ? 0 : s.name == ".comment" ? 1 : 2; };
+		return priority( s1 ) < priority( s2 );
+	});
+
+	for (const ElfSection & section : sections)
+	{
+		if (!section.name.startsWith(".note") && section.name != ".comment" && section.name != ".rodata")
+			continue;
+
+		if (findVersionString( elf, section, exeName, verInfo ))
+		{
+			LOG_DEBUG() << "found version string " << verInfo.description << " in section " << section.name << " of " << _filePath;
+			verInfo.status = ReadStatus::Success;
+			return verInfo;
+		}
+	}
+
+	LOG_DEBUG() << "no version string found in " << _filePath;
+	return verInfo;
+}
+
+#endif // !IS_WINDOWS
+
+
 //======================================================================================================================
 //  public API
 
 UncertainExeVersionInfo readExeVersionInfo( [[maybe_unused]] const QString & filePath )
 {
+	TRACE_ZONE_DETAIL( "readExeVersionInfo", filePath );
+
  #if IS_WINDOWS
 	LoggingExeReader exeReader( filePath );
 	return exeReader.readVersionInfo();
  #else
-	return { {}, ReadStatus::NotSupported };
+	LoggingElfReader elfReader( filePath );
+	return elfReader.readVersionInfo();
  #endif
 }
 
-FileInfoCache< ExeVersionInfo > g_cachedExeInfo( readExeVersionInfo );
+FileInfoCache< ExeVersionInfo > g_cachedExeInfo( "EXE info cache", readExeVersionInfo );
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -328,6 +643,8 @@ void ExeVersionInfo::serialize( QJsonObject & jsExeInfo ) const
 	jsExeInfo["app_name"] = appName;
 	jsExeInfo["description"] = description;
 	jsExeInfo["version"] = version.toString();
+	if (!supportedParams.isEmpty())
+		jsExeInfo["supported_params"] = serializeStringVec( supportedParams );
 }
 
 void ExeVersionInfo::deserialize( const JsonObjectCtx & jsExeInfo )
@@ -335,6 +652,8 @@ void ExeVersionInfo::deserialize( const JsonObjectCtx & jsExeInfo )
 	appName = jsExeInfo.getString("app_name");
 	description = jsExeInfo.getString("description");
 	version = Version( jsExeInfo.getString("version") );
+	if (JsonArrayCtx jsParams = jsExeInfo.getArray( "supported_params", DontShowError ))
+		supportedParams = deserializeStringVec( jsParams );
 }
 
 
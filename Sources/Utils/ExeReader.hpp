@@ -11,6 +11,7 @@
 
 #include "Essential.hpp"
 
+#include "CommonTypes.hpp"
 #include "Version.hpp"
 #include "FileInfoCache.hpp"
 
@@ -29,6 +30,7 @@ struct ExeVersionInfo
 	QString appName;
 	QString description;
 	Version version;
+	QStringVec supportedParams;  ///< command line parameters listed in the help output, empty if unknown
 
 	void serialize( QJsonObject & jsExeInfo ) const;
 	void deserialize( const JsonObjectCtx & jsExeInfo );
@@ -39,6 +41,8 @@ using UncertainExeVersionInfo = UncertainFileInfo< ExeVersionInfo >;
 /// Reads executable version info from the file's built-in resource.
 /** Even if status == Success, not all the fields have to be filled. If the version info resource was found,
   * but some of the expected entries is not present, the corresponding ExeVersionInfo field will remain empty/invalid.
+  * ELF executables have no such resource, so their read-only data are searched for a string like "GZDoom g4.11.3"
+  * that starts with the name of the file. If none is found, status NotSupported is returned.
   * BEWARE that on some systems opening the executable file can take incredibly long, so caching is strongly adviced. */
 UncertainExeVersionInfo readExeVersionInfo( const QString & filePath );
 
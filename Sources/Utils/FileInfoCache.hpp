@@ -14,6 +14,8 @@
 #include "JsonUtils.hpp"
 #include "FileSystemUtils.hpp"  // isValidFile
 #include "ErrorHandling.hpp"
+#include "Tracing.hpp"
+#include "Metrics.hpp"
 
 #include <QString>
 #include <QHash>
@@ -59,47 +61,96 @@ class FileInfoCache : protected LoggingComponent {
 	ReadFileInfoFunc _readFileInfo;
 	mutable bool _dirty = false;
 
+	metrics::Counter _hits;
+	metrics::Counter _misses;    ///< the file has not been read before
+	metrics::Counter _rereads;   ///< the file has changed or reading it failed last time
+	metrics::Gauge _entryCount;
+
  public:
 
-	FileInfoCache( ReadFileInfoFunc readFileInfo )
-		: LoggingComponent("FileInfoCache"), _readFileInfo( readFileInfo ) {}
+	/// \param name Name of the cache in the diagnostics, must be a string literal.
+	FileInfoCache( const char * name, ReadFileInfoFunc readFileInfo )
+	:
+		LoggingComponent("FileInfoCache"),
+		_readFileInfo( readFileInfo ),
+		_hits( name, "hits" ),
+		_misses( name, "misses" ),
+		_rereads( name, "re-reads" ),
+		_entryCount( name, "entries", [this]() { return QString::number( _cache.size() ); } )
+	{}
 
 	/// Reads selected information from a file and stores it into a cache.
 	/** If the file was already read earlier and was not modified since, it returns the cached info. */
 	const UncertainFileInfo< FileInfo > & getFileInfo( const QString & filePath )
 	{
+		TRACE_ZONE("FileInfoCache::getFileInfo");
+
 		auto fileLastModified = QFileInfo( filePath ).lastModified().toSecsSinceEpoch();
 
 		auto cacheIter = _cache.find( filePath );
 		if (cacheIter == _cache.end())
 		{
-			logDebug() << "entry not found, reading info from file: " << filePath;
+			LOG_DEBUG() << "entry not found, reading info from file: " << filePath;
+			_misses.increment();
 			cacheIter = readFileInfoToCache( filePath, fileLastModified );
 		}
 		else if (cacheIter->lastModified != fileLastModified)
 		{
-			logDebug() << "entry is outdated, reading info from file: " << filePath;
+			LOG_DEBUG() << "entry is outdated, reading info from file: " << filePath;
+			_rereads.increment();
 			cacheIter = readFileInfoToCache( filePath, fileLastModified );
 		}
 		else if (cacheIter->fileInfo.status == ReadStatus::CantOpen
 			  || cacheIter->fileInfo.status == ReadStatus::FailedToRead)
 		{
-			logDebug() << "reading file failed last time, trying again: " << filePath;
+			LOG_DEBUG() << "reading file failed last time, trying again: " << filePath;
+			_rereads.increment();
 			cacheIter = readFileInfoToCache( filePath, fileLastModified );
 		}
 		else if (cacheIter->fileInfo.status == ReadStatus::Uninitialized)
 		{
 			logRuntimeError() << "entry is corrupted, reading info from file: " << filePath;
+			_rereads.increment();
 			cacheIter = readFileInfoToCache( filePath, fileLastModified );
 		}
 		else
 		{
-			//logDebug() << "using cached info: " << filePath;
+			//LOG_DEBUG() << "using cached info: " << filePath;
+			_hits.increment();
 		}
 
 		return cacheIter->fileInfo;
 	}
 
+	/// Returns whether the cache contains a usable info about this file and the file has not been modified since.
+	/** Entries of unsupported files or files that failed to be read are not considered usable. */
+	bool containsValidInfo( const QString & filePath ) const
+	{
+		auto cacheIter = _cache.find( filePath );
+		if (cacheIter == _cache.end())
+			return false;
+
+		ReadStatus status = cacheIter->fileInfo.status;
+		if (status == ReadStatus::Uninitialized || status == ReadStatus::NotSupported
+		 || status == ReadStatus::CantOpen || status == ReadStatus::FailedToRead)
+			return false;
+
+		return cacheIter->lastModified == QFileInfo( filePath ).lastModified().toSecsSinceEpoch();
+	}
+
+	/// Stores an info about a file that was obtained in a different way than by the read function of this cache.
+	/** \param fileModifiedTimestamp Modification time of the file at the moment the info was obtained. */
+	void storeFileInfo( const QString & filePath, qint64 fileModifiedTimestamp, UncertainFileInfo< FileInfo > fileInfo )
+	{
+		Entry newEntry;
+
+		newEntry.fileInfo = std::move(fileInfo);
+		newEntry.lastModified = fileModifiedTimestamp;
+
+		_dirty = true;
+		_cache.insert( filePath, std::move(newEntry) );
+	}
+
 	/// Indicates whether the cache has been modified since the last time it was loaded from file or dumped to file.
 	bool isDirty() const  { return _dirty; }
 
@@ -132,7 +183,7 @@ class FileInfoCache : protected LoggingComponent {
 		{
 			if (!fs::isValidFile( filePath ))
 			{
-				logDebug() << "removing entry, file no longer exists: " << filePath;
+				LOG_DEBUG() << "removing entry, file no longer exists: " << filePath;
 				_dirty = true;
 				continue;
 			}
@@ -162,6 +213,8 @@ class FileInfoCache : protected LoggingComponent {
 
 	auto readFileInfoToCache( const QString & filePath, qint64 fileModifiedTimestamp )
 	{
+		tracing::instant("FileInfoCache miss");
+
 		Entry newEntry;
 
 		newEntry.fileInfo = _readFileInfo( filePath );
@@ -169,15 +222,15 @@ class FileInfoCache : protected LoggingComponent {
 
 		if (newEntry.fileInfo.status == ReadStatus::CantOpen)
 		{
-			logDebug() << "couldn't open file: " << filePath;
+			LOG_DEBUG() << "couldn't open file: " << filePath;
 		}
 		else if (newEntry.fileInfo.status == ReadStatus::FailedToRead)
 		{
-			logDebug() << "failed to read file: " << filePath;
+			LOG_DEBUG() << "failed to read file: " << filePath;
 		}
 		else if (newEntry.fileInfo.status == ReadStatus::NotSupported)
 		{
-			//logDebug() << "file info not implemented: " << filePath;
+			//LOG_DEBUG() << "file info not implemented: " << filePath;
 		}
 
 		_dirty = true;
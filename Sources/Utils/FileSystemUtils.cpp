@@ -7,6 +7,8 @@
 
 #include "FileSystemUtils.hpp"
 
+#include "Tracing.hpp"
+
 #include <QDirIterator>
 #include <QFile>
 #include <QSaveFile>
@@ -14,6 +16,13 @@
 #include <QRegularExpression>
 #include <QThread>  // sleep
 
+#if IS_WINDOWS
+	#include <windows.h>
+	#include <io.h>  // _get_osfhandle
+#else
+	#include <unistd.h>  // fsync
+#endif
+
 
 //======================================================================================================================
 
@@ -90,11 +99,50 @@ QString updateFileSafely( const QString & filePath, const QByteArray & newConten
 	return {};
 }
 
+static bool syncToDisk( QFile & file )
+{
+	int fd = file.handle();
+	if (fd < 0)
+	{
+		return true;  // the file engine doesn't provide the handle, rely on the OS writing it back soon
+	}
+
+ #if IS_WINDOWS
+	return FlushFileBuffers( reinterpret_cast< HANDLE >( _get_osfhandle( fd ) ) ) != 0;
+ #else
+	return fsync( fd ) == 0;
+ #endif
+}
+
+QString appendToFile( const QString & filePath, const QByteArray & data )
+{
+	QFile file( filePath );
+	if (!file.open( QIODevice::WriteOnly | QIODevice::Append ))
+	{
+		return "Could not open file "%filePath%" for writing ("%file.errorString()%")";
+	}
+
+	file.write( data );
+	if (file.error() != QFile::NoError || !file.flush())
+	{
+		return "Could not write to file "%filePath%" ("%file.errorString()%")";
+	}
+
+	if (!syncToDisk( file ))
+	{
+		return "Could not flush file "%filePath%" to the disk";
+	}
+
+	return {};
+}
+
 void traverseDirectory(
 	const QString & dir, bool recursively, EntryTypes typesToVisit,
 	const PathConvertor & pathConvertor, const std::function< void ( const QFileInfo & entry ) > & visitEntry
 )
 {
+	TRACE_ZONE_DETAIL( "traverseDirectory", dir );
+
 	if (dir.isEmpty())
 		return;
 
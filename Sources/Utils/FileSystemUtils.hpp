@@ -174,6 +174,11 @@ QString readWholeFile( const QString & filePath, QByteArray & dest );
   * Returns description of an error that might potentially happen, or empty string on success. */
 QString updateFileSafely( const QString & filePath, const QByteArray & newContent );
 
+/// Appends data to the end of a file and makes sure they are physically written to the disk before returning.
+/** Much cheaper than updateFileSafely() when the data are small compared to the file.
+  * Returns description of an error that might potentially happen, or empty string on success. */
+QString appendToFile( const QString & filePath, const QByteArray & data );
+
 } // namespace fs
 
 
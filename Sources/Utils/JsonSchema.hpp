@@ -0,0 +1,265 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: serialization of structs into JSON generated from a table of their fields
+//======================================================================================================================
+
+#ifndef JSON_SCHEMA_INCLUDED
+#define JSON_SCHEMA_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "JsonUtils.hpp"  // JsonObjectCtx, enumName, enumSize
+#include "Version.hpp"
+
+#include <QString>
+#include <QLatin1String>
+#include <QJsonValue>
+#include <QJsonObject>
+
+#include <tuple>
+#include <utility>  // index_sequence
+#include <type_traits>
+#include <limits>
+
+
+//======================================================================================================================
+// Instead of writing a serialize() and deserialize() function for every struct, which have to be kept in sync manually,
+// the struct specializes JsonSchema with a table of its fields, and serializeFields() and deserializeFields()
+// are generated from it:
+//
+//   template<> struct JsonSchema< VideoOptions >
+//   {
+//       static constexpr auto fields = std::make_tuple(
+//           jsonField( "monitor_idx", &VideoOptions::monitorIdx ),
+//           jsonField( "show_fps", &VideoOptions::showFPS, Version(1,7) ),
+//       );
+//   };
+//
+// The fields must be sorted by their keys (this is checked at compile time). QJsonObject keeps its elements sorted
+// by keys too, so the deserialization can walk the table and the JSON object together in a single pass,
+// instead of looking up every key.
+
+
+//======================================================================================================================
+//  conversion of individual values - add support for new member types here
+
+template< typename Type, typename = void >
+struct JsonValueTraits;  // a member of this type is not supported
+
+template<>
+struct JsonValueTraits< bool >
+{
+	static QString typeName()                   { return "bool"; }
+	static QJsonValue toJson( bool val )        { return val; }
+	static bool fromJson( const QJsonValue & jsVal, bool & val )
+	{
+		if (!jsVal.isBool())
+			return false;
+		val = jsVal.toBool();
+		return true;
+	}
+};
+
+template< typename Int >
+struct JsonValueTraits< Int, std::enable_if_t< std::is_integral_v< Int > && !std::is_same_v< Int, bool > > >
+{
+	// JSON numbers are doubles, the 64-bit integers have to be limited to what the double can represent exactly
+	static constexpr bool is64bit = sizeof( Int ) >= 8;
+	static constexpr double minVal = double( is64bit ? std::numeric_limits< Int >::min() >> 10 : std::numeric_limits< Int >::min() );
+	static constexpr double maxVal = double( is64bit ? std::numeric_limits< Int >::max() >> 10 : std::numeric_limits< Int >::max() );
+
+	static QString typeName()                   { return std::is_signed_v< Int > ? "int" : "uint"; }
+	static QJsonValue toJson( Int val )         { return qint64( val ); }
+	static bool fromJson( const QJsonValue & jsVal, Int & val )
+	{
+		if (!jsVal.isDouble())
+			return false;
+		double d = jsVal.toDouble();
+		if (d < minVal || d > maxVal)
+			return false;
+		val = Int( d );
+		return true;
+	}
+};
+
+template<>
+struct JsonValueTraits< double >
+{
+	static QString typeName()                   { return "double"; }
+	static QJsonValue toJson( double val )      { return val; }
+	static bool fromJson( const QJsonValue & jsVal, double & val )
+	{
+		if (!jsVal.isDouble())
+			return false;
+		val = jsVal.toDouble();
+		return true;
+	}
+};
+
+template<>
+struct JsonValueTraits< QString >
+{
+	static QString typeName()                   { return "string"; }
+	static QJsonValue toJson( const QString & val )  { return val; }
+	static bool fromJson( const QJsonValue & jsVal, QString & val )
+	{
+		if (!jsVal.isString())
+			return false;
+		val = jsVal.toString();
+		return true;
+	}
+};
+
+/// enums are stored as numbers, see enumName() and enumSize() in JsonUtils.hpp
+template< typename Enum >
+struct JsonValueTraits< Enum, std::enable_if_t< std::is_enum_v< Enum > > >
+{
+	static QString typeName()                   { return enumName< Enum >(); }
+	static QJsonValue toJson( Enum val )        { return int( val ); }
+	static bool fromJson( const QJsonValue & jsVal, Enum & val )
+	{
+		uint intVal = 0;
+		if (!JsonValueTraits< uint >::fromJson( jsVal, intVal ) || intVal > enumSize< Enum >())
+			return false;
+		val = Enum( intVal );
+		return true;
+	}
+};
+
+
+//======================================================================================================================
+//  field table
+
+/// Describes how a member of a struct is stored in JSON.
+template< typename Struct, typename Member >
+struct JsonField
+{
+	const char * key;
+	Member Struct::* member;
+	Version since;   ///< first version that stores this field, it's not an error when older files don't contain it
+	Version until;   ///< first version that no longer stores this field, invalid if it's still stored
+};
+
+/// Describes a member that is stored since the version \p since and optionally was stored only until the version \p until.
+/** Fields with the \p until version are only read from older files. Together with a new field that takes over
+  * the member, they can be used to migrate a value to a different key or type. */
+template< typename Struct, typename Member >
+constexpr JsonField< Struct, Member > jsonField( const char * key, Member Struct::* member, Version since = {}, Version until = {} )
+{
+	return { key, member, since, until };
+}
+
+/// Specialize this for every struct that should be serialized by serializeFields() and deserializeFields().
+/** The specialization must contain  static constexpr auto fields = std::make_tuple( jsonField(...), ... );
+  * with the fields sorted by their keys. */
+template< typename Struct >
+struct JsonSchema;
+
+namespace impl {
+
+constexpr int compareKeys( const char * a, const char * b )
+{
+	while (*a != '\0' && *a == *b)
+	{
+		++a;
+		++b;
+	}
+	return int( static_cast< unsigned char >( *a ) ) - int( static_cast< unsigned char >( *b ) );
+}
+
+template< typename Fields, size_t ... Idxs >
+constexpr bool areKeysSorted( const Fields & fields, std::index_sequence< Idxs ... > )
+{
+	return ((compareKeys( std::get< Idxs >( fields ).key, std::get< Idxs + 1 >( fields ).key ) < 0) && ...);
+}
+
+template< typename Struct >
+constexpr bool isSchemaSorted()
+{
+	constexpr size_t fieldCount = std::tuple_size_v< std::decay_t< decltype( JsonSchema< Struct >::fields ) > >;
+	if constexpr (fieldCount < 2)
+		return true;
+	else
+		return areKeysSorted( JsonSchema< Struct >::fields, std::make_index_sequence< fieldCount - 1 >() );
+}
+
+template< typename Struct, typename FieldStruct, typename Member >
+void serializeField( QJsonObject & jsObject, const Struct & obj, const JsonField< FieldStruct, Member > & field )
+{
+	if (field.until.isValid())
+		return;  // no longer stored, only read from older files
+
+	// the fields are sorted, so each one is inserted at the end of QJsonObject, which is cheap
+	jsObject[ field.key ] = JsonValueTraits< Member >::toJson( obj.*field.member );
+}
+
+template< typename Struct, typename FieldStruct, typename Member >
+void deserializeField(
+	const JsonObjectCtx & jsObject, QJsonObject::const_iterator & nextElem, Struct & obj, const JsonField< FieldStruct, Member > & field
+){
+	const Version & dataVersion = jsObject.dataVersion();
+	if (field.until.isValid() && dataVersion >= field.until)
+		return;  // the file is too new to contain this field
+
+	const QJsonObject & wrappedObject = jsObject.wrappedObject();
+	const QLatin1String key( field.key );
+
+	// Both are sorted, so the element is either the next one, or there are some unknown elements before it.
+	while (nextElem != wrappedObject.constEnd() && nextElem.key() < key)
+		++nextElem;
+
+	QJsonObject::const_iterator elem = nextElem;
+	if (elem == wrappedObject.constEnd() || elem.key() != key)
+		elem = wrappedObject.constFind( key );  // missing, or the object is not sorted the way we expect
+
+	if (elem == wrappedObject.constEnd())
+	{
+		jsObject.missingKey( key, dataVersion >= field.since );  // the member keeps its current value
+		return;
+	}
+
+	if (!JsonValueTraits< Member >::fromJson( elem.value(), obj.*field.member ))
+	{
+		jsObject.invalidTypeAtKey( key, JsonValueTraits< Member >::typeName() );
+	}
+}
+
+} // namespace impl
+
+
+//======================================================================================================================
+//  generated serialization
+
+/// Stores all the fields from the JsonSchema of the struct into a new JSON object.
+template< typename Struct >
+QJsonObject serializeFields( const Struct & obj )
+{
+	static_assert( impl::isSchemaSorted< Struct >(), "The fields of JsonSchema must be sorted by their keys" );
+
+	QJsonObject jsObject;
+	std::apply( [&]( const auto & ... fields )
+	{
+		( impl::serializeField( jsObject, obj, fields ), ... );
+	}, JsonSchema< Struct >::fields );
+	return jsObject;
+}
+
+/// Loads all the fields from the JsonSchema of the struct from a JSON object.
+/** Missing or invalid elements are reported and the corresponding members keep their current values. */
+template< typename Struct >
+void deserializeFields( const JsonObjectCtx & jsObject, Struct & obj )
+{
+	static_assert( impl::isSchemaSorted< Struct >(), "The fields of JsonSchema must be sorted by their keys" );
+
+	QJsonObject::const_iterator nextElem = jsObject.wrappedObject().constBegin();
+	std::apply( [&]( const auto & ... fields )
+	{
+		( impl::deserializeField( jsObject, nextElem, obj, fields ), ... );
+	}, JsonSchema< Struct >::fields );
+}
+
+
+#endif // JSON_SCHEMA_INCLUDED
@@ -523,31 +523,51 @@ bool writeJsonToFile( const QJsonDocument & jsonDoc, const QString & filePath, c
 
 JsonDocumentCtx readJsonFromFile( const QString & filePath, const QString & fileDesc, bool ignoreEmpty )
 {
-	QByteArray bytes;
-	QString readError = fs::readWholeFile( filePath, bytes );
-	if (!readError.isEmpty())
+	QJsonDocument jsonDoc = readJsonDocumentFromFile( filePath, fileDesc, ignoreEmpty );
+	if (jsonDoc.isNull())
 	{
-		reportRuntimeError( nullptr, "Error loading "+fileDesc, readError );
 		return JsonDocumentCtx();
 	}
 
+	return JsonDocumentCtx( filePath, jsonDoc );
+}
+
+QJsonDocument readJsonDocumentFromFile( const QString & filePath, const QString & fileDesc, bool ignoreEmpty )
+{
+	QString error;
+	QJsonDocument jsonDoc = parseJsonFile( filePath, fileDesc, ignoreEmpty, error );
+	if (!error.isEmpty())
+	{
+		reportRuntimeError( nullptr, "Error loading "+fileDesc, error );
+	}
+
+	return jsonDoc;
+}
+
+QJsonDocument parseJsonFile( const QString & filePath, const QString & fileDesc, bool ignoreEmpty, QString & error )
+{
+	QByteArray bytes;
+	error = fs::readWholeFile( filePath, bytes );
+	if (!error.isEmpty())
+	{
+		return QJsonDocument();
+	}
+
 	if (bytes.isEmpty())
 	{
 		if (!ignoreEmpty)
-			reportRuntimeError( nullptr, "Error loading "+fileDesc, fileDesc+" file is empty." );
-		return JsonDocumentCtx();
+			error = fileDesc+" file is empty.";
+		return QJsonDocument();
 	}
 
 	QJsonParseError parseError;
 	QJsonDocument jsonDoc = QJsonDocument::fromJson( bytes, &parseError );
 	if (jsonDoc.isNull())
 	{
-		reportRuntimeError( nullptr, "Error loading "+fileDesc,
-			"Failed to parse \""%fs::getFileNameFromPath(filePath)%"\": "%parseError.errorString()%"\n"
-			"You can either open it in notepad and try to repair it, or delete it and start from scratch."
-		);
-		return JsonDocumentCtx();
+		error = "Failed to parse \""%fs::getFileNameFromPath(filePath)%"\": "%parseError.errorString()%"\n"
+		        "You can either open it in notepad and try to repair it, or delete it and start from scratch.";
+		return QJsonDocument();
 	}
 
-	return JsonDocumentCtx( filePath, jsonDoc );
+	return jsonDoc;
 }
@@ -11,6 +11,7 @@
 
 #include "Essential.hpp"
 #include "CommonTypes.hpp"
+#include "Version.hpp"
 
 #include <QString>
 #include <QList>
@@ -60,6 +61,7 @@ struct _ParsingContext
 {
 	QString filePath;
 	bool dontShowAgain = false;  ///< whether to show "invalid element" errors to the user
+	Version dataVersion;  ///< version of the application that wrote the document, invalid if unknown
 
 	QString fileName() const;
 };
@@ -124,6 +126,9 @@ class JsonValueCtx {
 
 	bool isRoot() const    { return _parent == nullptr; }
 
+	/// Version of the application that wrote the document, invalid if unknown.
+	const Version & dataVersion() const  { return _context->dataVersion; }
+
 	/// Reconstructs a path of this element in its JSON document.
 	QString getJsonPath() const;
 
@@ -204,6 +209,10 @@ class JsonObjectCtx : public JsonObjectCtxProxy {
 
 	auto keys() const { return _wrappedObject.keys(); }
 
+	/// Direct access for parsers that process all the elements at once instead of looking them up by keys.
+	/** Such parsers should report the errors via missingKey() and invalidTypeAtKey(). */
+	const QJsonObject & wrappedObject() const { return _wrappedObject; }
+
 	/// Returns a sub-object at a specified key.
 	/** If it doesn't exist it shows an error dialog and returns invalid object. */
 	JsonObjectCtxProxy getObject( const QString & key, bool showError = true ) const;
@@ -254,10 +263,11 @@ class JsonObjectCtx : public JsonObjectCtxProxy {
 		}
 	}
 
- protected:
-
 	void missingKey( const QString & key, bool showError ) const;
 	void invalidTypeAtKey( const QString & key, const QString & expectedType, bool showError = true ) const;
+
+ protected:
+
 	QString elemPath( const QString & elemName ) const;
 
 };
@@ -365,6 +375,9 @@ class JsonDocumentCtx {
 
 	void disableWarnings() const { _context.dontShowAgain = false; }
 
+	/// Lets the parsers know which elements the document is expected to contain.
+	void setDataVersion( const Version & version ) const { _context.dataVersion = version; }
+
 };
 
 
@@ -455,5 +468,14 @@ inline constexpr bool CheckIfEmpty = false;
 bool writeJsonToFile( const QJsonDocument & jsonDoc, const QString & filePath, const QString & fileDesc );
 JsonDocumentCtx readJsonFromFile( const QString & filePath, const QString & fileDesc, bool ignoreEmpty = false );
 
+/// Same as readJsonFromFile(), but returns the plain document, so that it can be modified before it's parsed.
+/** Returns null document on failure, the errors are already reported. */
+QJsonDocument readJsonDocumentFromFile( const QString & filePath, const QString & fileDesc, bool ignoreEmpty = false );
+
+/// Same as readJsonDocumentFromFile(), but doesn't report the errors, so that it can be used in a background thread.
+/** Returns null document on failure and the error message in \p error, which stays empty if the file was empty
+  * and \p ignoreEmpty was set. The error should be reported with the title "Error loading <fileDesc>". */
+QJsonDocument parseJsonFile( const QString & filePath, const QString & fileDesc, bool ignoreEmpty, QString & error );
+
 
 #endif // JSON_UTILS_INCLUDED
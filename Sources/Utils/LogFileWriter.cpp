@@ -0,0 +1,173 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: writing log records into a file in a background thread
+//======================================================================================================================
+
+#include "LogFileWriter.hpp"
+
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QByteArray>
+#include <QtCore/qdebug.h>
+
+// This is the back-end of the logging, so it cannot report its own errors using the logging API.
+
+
+namespace impl {
+
+
+//======================================================================================================================
+
+LogFileWriter::LogFileWriter( const QString & filePath )
+:
+	_filePath( filePath ),
+	_file( filePath )
+{
+	QThread::setObjectName( "log writer" );
+	QThread::start( QThread::LowPriority );
+}
+
+LogFileWriter::~LogFileWriter()
+{
+	stop();
+}
+
+void LogFileWriter::stop()
+{
+	_stopping.store( true, std::memory_order_relaxed );
+	_queuedRecords.release();  // wake up the thread
+	QThread::wait();
+}
+
+void LogFileWriter::write( qint64 time_ms, QString line )
+{
+	// Once the stopping has started, the records might no longer be written, so don't even try.
+	if (_stopping.load( std::memory_order_relaxed ))
+		return;
+
+	if (_queue.tryPush({ time_ms, std::move(line) }))
+		_queuedRecords.release();
+	else
+		_droppedCount.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void LogFileWriter::run()
+{
+	// This will run in the background thread.
+
+	bool fileOpen = openFile();
+
+	for (;;)
+	{
+		_queuedRecords.acquire();  // wait for a record or the stop request
+		bool stopping = _stopping.load( std::memory_order_relaxed );
+
+		// The releases only wake this thread up, they don't match the records one to one. The producers can publish
+		// out of order, so the record a release belongs to may be behind one that isn't published yet,
+		// but that producer will release too when it's done. So just take all the wake-ups that have accumulated
+		// and then everything that's available, the file is flushed only once per batch.
+		_queuedRecords.tryAcquire( _queuedRecords.available() );
+
+		Record record;
+		while (_queue.tryPop( record ))
+		{
+			if (fileOpen)
+				writeRecord( record );
+		}
+
+		if (fileOpen)
+		{
+			writeDroppedCount();
+			_file.flush();
+
+			if (_file.size() > maxFileSize)
+			{
+				rotateFile();
+				fileOpen = openFile();
+			}
+		}
+
+		if (stopping)
+		{
+			// The producers stop pushing when they see the stop flag, but one of them might have pushed
+			// right before it was set.
+			while (_queue.tryPop( record ))
+				if (fileOpen)
+					writeRecord( record );
+			break;
+		}
+	}
+
+	_file.close();
+}
+
+bool LogFileWriter::openFile()
+{
+	if (!_file.open( QIODevice::Append ))
+	{
+		qWarning().nospace() << "cannot open log file " << _filePath << ": " << _file.errorString();
+		return false;
+	}
+	return true;
+}
+
+void LogFileWriter::writeRecord( const Record & record )
+{
+	QString currentTime = QDateTime::fromMSecsSinceEpoch( record.time_ms ).toString( Qt::DateFormat::ISODate );
+
+	QByteArray bytes;
+	bytes.reserve( currentTime.size() + record.line.size() + 4 );
+	bytes += '[';
+	bytes += currentTime.toUtf8();
+	bytes += "] ";
+	bytes += record.line.toUtf8();
+	bytes += '\n';
+
+	_file.write( bytes );
+}
+
+void LogFileWriter::writeDroppedCount()
+{
+	qint64 droppedCount = _droppedCount.exchange( 0, std::memory_order_relaxed );
+	if (droppedCount > 0)
+	{
+		writeRecord({ QDateTime::currentMSecsSinceEpoch(),
+			QStringLiteral("[%1] %2 log records were dropped because the log file couldn't keep up")
+				.arg( "INFO", -7 ).arg( droppedCount )
+		});
+	}
+}
+
+QString LogFileWriter::oldFilePath( int number ) const
+{
+	QFileInfo fileInfo( _filePath );
+	QString fileName = fileInfo.completeBaseName() + '.' + QString::number( number );
+	if (!fileInfo.suffix().isEmpty())
+		fileName += '.' + fileInfo.suffix();
+	return fileInfo.dir().filePath( fileName );
+}
+
+void LogFileWriter::rotateFile()
+{
+	_file.close();
+
+	QFile::remove( oldFilePath( maxOldFiles ) );
+	for (int number = maxOldFiles - 1; number >= 1; --number)
+	{
+		QString olderPath = oldFilePath( number );
+		if (QFile::exists( olderPath ))
+			QFile::rename( olderPath, oldFilePath( number + 1 ) );
+	}
+	if (!QFile::rename( _filePath, oldFilePath( 1 ) ))
+	{
+		// Better to lose the old records than to let the file grow without limits.
+		qWarning().nospace() << "cannot rename log file " << _filePath << ", starting it over";
+		QFile::remove( _filePath );
+	}
+}
+
+
+} // namespace impl
@@ -0,0 +1,158 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: writing log records into a file in a background thread
+//======================================================================================================================
+
+#ifndef LOG_FILE_WRITER_INCLUDED
+#define LOG_FILE_WRITER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <QThread>
+#include <QSemaphore>
+#include <QFile>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+
+
+namespace impl {
+
+
+//======================================================================================================================
+/// Bounded queue that any number of threads can push into and a single thread pops from, without locking.
+/** Every slot carries a sequence number telling whose turn it is, the producers first reserve a slot
+  * by incrementing the head and then publish the element by updating the slot's sequence number. */
+
+template< typename Elem, size_t Capacity >
+class RingBuffer {
+
+	static_assert( Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2" );
+
+	struct Slot
+	{
+		std::atomic< size_t > seq;
+		Elem elem;
+	};
+
+	Slot _slots [Capacity];
+	alignas(64) std::atomic< size_t > _head { 0 };  ///< next position to push to, shared by the producers
+	alignas(64) size_t _tail = 0;                    ///< next position to pop from, accessed only by the consumer
+
+ public:
+
+	RingBuffer()
+	{
+		for (size_t i = 0; i < Capacity; ++i)
+			_slots[i].seq.store( i, std::memory_order_relaxed );
+	}
+
+	/// Can be called from any thread. Returns false when the buffer is full.
+	bool tryPush( Elem && elem )
+	{
+		size_t pos = _head.load( std::memory_order_relaxed );
+		for (;;)
+		{
+			Slot & slot = _slots[ pos & (Capacity - 1) ];
+			size_t seq = slot.seq.load( std::memory_order_acquire );
+			auto diff = intptr_t( seq ) - intptr_t( pos );
+			if (diff == 0)  // the slot is free for this position, try to reserve it
+			{
+				if (_head.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ))
+				{
+					slot.elem = std::move( elem );
+					slot.seq.store( pos + 1, std::memory_order_release );  // publish it to the consumer
+					return true;
+				}
+				// pos has been updated by the failed exchange, try again
+			}
+			else if (diff < 0)  // the consumer hasn't popped the element from the previous round yet
+			{
+				return false;
+			}
+			else  // another producer has taken this position
+			{
+				pos = _head.load( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	/// Must be called only from the consumer thread. Returns false when the buffer is empty.
+	bool tryPop( Elem & elem )
+	{
+		Slot & slot = _slots[ _tail & (Capacity - 1) ];
+		size_t seq = slot.seq.load( std::memory_order_acquire );
+		if (intptr_t( seq ) - intptr_t( _tail + 1 ) < 0)  // not published yet
+			return false;
+
+		elem = std::move( slot.elem );
+		slot.seq.store( _tail + Capacity, std::memory_order_release );  // free the slot for the next round
+		++_tail;
+		return true;
+	}
+
+};
+
+
+//======================================================================================================================
+/// Keeps the log file open and writes the records into it in a background thread.
+/** The logging threads only format their message and queue it, so an error logged from the GUI thread
+  * doesn't have to wait for opening, writing and closing the file. When the file grows over the size limit,
+  * it's renamed to <name>.1.<suffix> (the older ones are shifted further) and a new one is started. */
+
+class LogFileWriter : public QThread {
+
+ public:
+
+	static constexpr size_t queueCapacity = 1024;
+	static constexpr qint64 maxFileSize = 1 * 1024 * 1024;
+	static constexpr int maxOldFiles = 3;
+
+	LogFileWriter( const QString & filePath );
+	virtual ~LogFileWriter() override;
+
+	/// Writes the records that are still in the queue and stops the thread. Records written after this are ignored.
+	void stop();
+
+	/// Queues a line to be written into the file, can be called from any thread.
+	/** If the queue is full, because the file cannot keep up, the record is dropped and the drop is noted in the file. */
+	void write( qint64 time_ms, QString line );
+
+ private:
+
+	virtual void run() override;
+
+	struct Record
+	{
+		qint64 time_ms = 0;  ///< milliseconds since epoch, formatted in the background thread
+		QString line;
+	};
+
+	bool openFile();
+	void writeRecord( const Record & record );
+	void writeDroppedCount();
+	void rotateFile();
+	QString oldFilePath( int number ) const;
+
+ private:
+
+	QString _filePath;
+	QFile _file;  ///< accessed only by the background thread
+
+	RingBuffer< Record, queueCapacity > _queue;
+	QSemaphore _queuedRecords;  ///< released after every pushed record, wakes up the background thread
+
+	std::atomic< bool > _stopping { false };
+	std::atomic< qint64 > _droppedCount { 0 };
+
+};
+
+
+} // namespace impl
+
+
+#endif // LOG_FILE_WRITER_INCLUDED
@@ -0,0 +1,135 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: registry of internal counters and measurements shown in the Diagnostics dialog
+//======================================================================================================================
+
+#include "Metrics.hpp"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+
+namespace metrics {
+
+
+//======================================================================================================================
+//  registry
+
+// Function-local statics, because the metrics are often global variables constructed in an unspecified order.
+// They are also destroyed after all the metrics constructed before them, so the unregistration is safe.
+
+static QMutex & registryMutex()
+{
+	static QMutex mutex;
+	return mutex;
+}
+static QVector< Metric * > & registeredMetrics()
+{
+	static QVector< Metric * > metrics;
+	return metrics;
+}
+
+Metric::Metric( const char * group, const char * name )
+:
+	_group( group ),
+	_name( name )
+{
+	QMutexLocker locker( &registryMutex() );
+	registeredMetrics().append( this );
+}
+
+Metric::~Metric()
+{
+	QMutexLocker locker( &registryMutex() );
+	registeredMetrics().removeOne( this );
+}
+
+QVector< MetricValue > collectAll()
+{
+	QVector< MetricValue > values;
+	{
+		QMutexLocker locker( &registryMutex() );
+		values.reserve( registeredMetrics().size() );
+		for (const Metric * metric : registeredMetrics())
+			values.append({ metric->group(), metric->name(), metric->valueStr() });
+	}
+
+	std::stable_sort( values.begin(), values.end(), []( const MetricValue & a, const MetricValue & b )
+	{
+		return a.group < b.group;
+	});
+
+	return values;
+}
+
+void resetAll()
+{
+	QMutexLocker locker( &registryMutex() );
+	for (Metric * metric : registeredMetrics())
+		metric->reset();
+}
+
+
+//======================================================================================================================
+//  metric types
+
+QString Counter::valueStr() const
+{
+	return QString::number( value() );
+}
+
+void Distribution::record( qint64 value )
+{
+	_count.fetch_add( 1, std::memory_order_relaxed );
+	_total.fetch_add( value, std::memory_order_relaxed );
+	_last.store( value, std::memory_order_relaxed );
+
+	qint64 currentMax = _max.load( std::memory_order_relaxed );
+	while (value > currentMax && !_max.compare_exchange_weak( currentMax, value, std::memory_order_relaxed )) {}
+}
+
+QString Distribution::valueStr() const
+{
+	qint64 count = _count.load( std::memory_order_relaxed );
+	if (count == 0)
+		return "not measured yet";
+
+	qint64 average = _total.load( std::memory_order_relaxed ) / count;
+	return QStringLiteral("last %1 %4, average %2 %4, max %3 %4, %5x")
+		.arg( _last.load( std::memory_order_relaxed ) )
+		.arg( average )
+		.arg( _max.load( std::memory_order_relaxed ) )
+		.arg( _unit )
+		.arg( count );
+}
+
+void Distribution::reset()
+{
+	_count.store( 0, std::memory_order_relaxed );
+	_total.store( 0, std::memory_order_relaxed );
+	_last.store( 0, std::memory_order_relaxed );
+	_max.store( 0, std::memory_order_relaxed );
+}
+
+
+//======================================================================================================================
+//  formatting
+
+QString formatSize( qint64 bytes )
+{
+	if (bytes < 0)
+		return "unknown";
+	else if (bytes < 1024)
+		return QStringLiteral("%1 B").arg( bytes );
+	else if (bytes < 1024 * 1024)
+		return QStringLiteral("%1 KiB").arg( double( bytes ) / 1024.0, 0, 'f', 1 );
+	else
+		return QStringLiteral("%1 MiB").arg( double( bytes ) / (1024.0 * 1024.0), 0, 'f', 1 );
+}
+
+
+} // namespace metrics
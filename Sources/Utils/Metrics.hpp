@@ -0,0 +1,159 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: registry of internal counters and measurements shown in the Diagnostics dialog
+//======================================================================================================================
+
+#ifndef METRICS_INCLUDED
+#define METRICS_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <QString>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <functional>
+
+
+//======================================================================================================================
+// Usage:
+//
+//   static metrics::Counter g_fooCount( "Foo", "calls" );
+//   static metrics::Distribution g_fooDuration( "Foo", "duration", "ms" );
+//
+//   void foo()
+//   {
+//       g_fooCount.increment();
+//       metrics::ScopedTimer timer( g_fooDuration );
+//       ...
+//   }
+//
+// Every metric registers itself on construction and unregisters on destruction, so they can be global variables
+// or members of long-living objects. Updating the counters and distributions is a few relaxed atomic operations
+// and can be done from any thread. The values are only formatted when somebody looks at them.
+
+namespace metrics {
+
+
+/// Common base of all metrics, allows the registry to list them.
+class Metric {
+
+ public:
+
+	Metric( const char * group, const char * name );
+	virtual ~Metric();
+
+	Metric( const Metric & ) = delete;
+	Metric & operator=( const Metric & ) = delete;
+
+	const char * group() const  { return _group; }
+	const char * name() const   { return _name; }
+
+	/// Human-readable current value.
+	virtual QString valueStr() const = 0;
+
+	virtual void reset() {}
+
+ private:
+
+	const char * _group;
+	const char * _name;
+
+};
+
+/// Number of times something happened.
+class Counter : public Metric {
+
+	std::atomic< qint64 > _value { 0 };
+
+ public:
+
+	Counter( const char * group, const char * name ) : Metric( group, name ) {}
+
+	void increment( qint64 by = 1 )  { _value.fetch_add( by, std::memory_order_relaxed ); }
+
+	qint64 value() const  { return _value.load( std::memory_order_relaxed ); }
+
+	virtual QString valueStr() const override;
+	virtual void reset() override  { _value.store( 0, std::memory_order_relaxed ); }
+
+};
+
+/// Summary of repeated measurements of some quantity, like a duration or a size.
+class Distribution : public Metric {
+
+	const char * _unit;
+	std::atomic< qint64 > _count { 0 };
+	std::atomic< qint64 > _total { 0 };
+	std::atomic< qint64 > _last { 0 };
+	std::atomic< qint64 > _max { 0 };
+
+ public:
+
+	Distribution( const char * group, const char * name, const char * unit ) : Metric( group, name ), _unit( unit ) {}
+
+	void record( qint64 value );
+
+	virtual QString valueStr() const override;
+	virtual void reset() override;
+
+};
+
+/// Records the time from its construction to the end of its scope into a Distribution in milliseconds.
+class ScopedTimer {
+
+	Distribution & _distribution;
+	QElapsedTimer _timer;
+
+ public:
+
+	ScopedTimer( Distribution & distribution ) : _distribution( distribution )  { _timer.start(); }
+	~ScopedTimer()  { _distribution.record( _timer.elapsed() ); }
+
+};
+
+/// Value that is computed only when it's displayed, like a number of rows in a model.
+/** The function is called in the thread that collects the values, which is the GUI thread,
+  * so it may access only data that belong to that thread. */
+class Gauge : public Metric {
+
+	std::function< QString () > _getValue;
+
+ public:
+
+	Gauge( const char * group, const char * name, std::function< QString () > getValue )
+		: Metric( group, name ), _getValue( std::move(getValue) ) {}
+
+	virtual QString valueStr() const override  { return _getValue(); }
+
+};
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  registry
+
+struct MetricValue
+{
+	QString group;
+	QString name;
+	QString value;
+};
+
+/// Values of all registered metrics, sorted by group, metrics within a group in the order of registration.
+QVector< MetricValue > collectAll();
+
+/// Resets all counters and distributions, gauges are not affected.
+void resetAll();
+
+/// Formats a number of bytes into a human-readable string, like "12.3 MiB".
+QString formatSize( qint64 bytes );
+
+
+} // namespace metrics
+
+
+#endif // METRICS_INCLUDED
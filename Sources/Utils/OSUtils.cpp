@@ -18,10 +18,12 @@
 #include <QRegularExpression>
 #include <QScreen>
 #include <QProcess>
+#include <QFile>
 
 #if IS_WINDOWS
 	#include <windows.h>
 	#include <shlobj.h>
+	#include <psapi.h>  // GetProcessMemoryInfo
 #endif
 
 
@@ -462,6 +464,33 @@ bool openFileLocation( const QString & filePath )
 	return true;
 }
 
+qint64 getOwnMemoryUsage()
+{
+ #if IS_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof(counters) ))
+		return -1;
+	return qint64( counters.WorkingSetSize );
+ #elif defined(Q_OS_LINUX)
+	QFile statusFile( "/proc/self/status" );
+	if (!statusFile.open( QIODevice::ReadOnly | QIODevice::Text ))
+		return -1;
+	// the file is generated by the kernel and its size is not known in advance, so it must be read line by line
+	for (QByteArray line = statusFile.readLine(); !line.isEmpty(); line = statusFile.readLine())
+	{
+		if (line.startsWith( "VmRSS:" ))
+		{
+			bool ok = false;
+			qint64 rss_kB = line.mid( 6 ).replace( "kB", "" ).trimmed().toLongLong( &ok );
+			return ok ? rss_kB * 1024 : -1;
+		}
+	}
+	return -1;
+ #else
+	return -1;
+ #endif
+}
+
 
 } // namespace os
 
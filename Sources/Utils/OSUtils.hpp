@@ -145,6 +145,9 @@ struct EnvVar
 	QString value;
 };
 
+/// Physical memory currently occupied by this process, or -1 when it cannot be determined on this system.
+qint64 getOwnMemoryUsage();
+
 
 } // namespace os
 
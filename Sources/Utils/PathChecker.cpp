@@ -0,0 +1,73 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: checking existence of many file-system entries in background threads
+//======================================================================================================================
+
+#include "PathChecker.hpp"
+
+#include <QFileInfo>
+
+
+namespace fs {
+
+
+//======================================================================================================================
+
+static constexpr int chunkSize = 16;  ///< small enough to spread a typical preset over several threads
+
+PathChecker::PathChecker()
+{
+	// without this we cannot use our own types as parameters of signals emitted from another thread
+	qRegisterMetaType< QVector< fs::PathStatus > >();
+}
+
+PathChecker::~PathChecker()
+{
+	stop();
+}
+
+int PathChecker::checkAsync( const QStringVec & paths )
+{
+	int batchID = ++lastBatchID;
+	for (int firstIdx = 0; firstIdx < paths.size(); firstIdx += chunkSize)
+	{
+		QStringVec chunk;
+		chunk.reserve( chunkSize );
+		for (int i = firstIdx; i < paths.size() && i < firstIdx + chunkSize; ++i)
+			chunk.append( paths[i] );
+		// the user is looking at the list, so this goes before the background work
+		tasks::sharedScheduler().submit( tasks::Priority::VisiblePrefetch, checkTasks,
+			[ this, batchID, firstIdx, chunk = std::move(chunk) ]( const tasks::CancellationToken & token )
+		{
+			// This will run in a worker thread of the scheduler.
+
+			QVector< PathStatus > statuses( chunk.size() );
+			for (int i = 0; i < chunk.size(); ++i)
+			{
+				if (token.isCancelled())
+					return;
+				if (chunk[i].isEmpty())  // separators and other items without a path
+					continue;
+
+				QFileInfo entry( chunk[i] );
+				statuses[i].exists = entry.exists();
+				statuses[i].isDir = statuses[i].exists && entry.isDir();
+			}
+
+			// The signal will be delivered to the thread of the checker as a queued event.
+			emit pathsChecked( batchID, firstIdx, statuses );
+		});
+	}
+	return batchID;
+}
+
+void PathChecker::stop()
+{
+	checkTasks.cancel();  // the tasks that haven't started yet will be dropped
+	checkTasks.waitForDone();
+}
+
+
+} // namespace fs
@@ -0,0 +1,75 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: checking existence of many file-system entries in background threads
+//======================================================================================================================
+
+#ifndef PATH_CHECKER_INCLUDED
+#define PATH_CHECKER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "CommonTypes.hpp"  // QStringVec
+#include "TaskScheduler.hpp"
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+
+namespace fs {
+
+
+//======================================================================================================================
+
+struct PathStatus
+{
+	bool exists = false;
+	bool isDir = false;
+};
+
+/// Checks existence of whole lists of paths in background threads, so that slow drives don't block the GUI.
+/** The list is split into chunks that are checked in parallel, because on network drives most of the time
+  * is spent waiting for the server, not by the local CPU.
+  * Results are delivered via signal to the thread that constructed this object, one signal per chunk. */
+
+class PathChecker : public QObject {
+
+	Q_OBJECT
+
+ public:
+
+	PathChecker();
+	virtual ~PathChecker() override;
+
+	/// Starts checking the paths, returns an ID that will be passed to pathsChecked() with the results of this batch.
+	/** Results of the previous batches may still arrive, the receiver should ignore those it's no longer interested in. */
+	int checkAsync( const QStringVec & paths );
+
+	/// Waits for the running checks to finish and drops the ones that haven't started yet.
+	void stop();
+
+ signals:
+
+	/// Emitted for every checked chunk of a batch.
+	/** \param firstIdx Index of the first path of the chunk in the list given to checkAsync(),
+	  *                 \p statuses contain results for the consecutive paths from there. */
+	void pathsChecked( int batchID, int firstIdx, const QVector< fs::PathStatus > & statuses );
+
+ private:
+
+	tasks::TaskGroup checkTasks;
+	int lastBatchID = 0;
+
+};
+
+
+} // namespace fs
+
+// without this we cannot use our own types as parameters of signals emitted from another thread
+Q_DECLARE_METATYPE( fs::PathStatus )  // QVector of declared types is declared automatically
+
+
+#endif // PATH_CHECKER_INCLUDED
@@ -0,0 +1,234 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: periodic sampling of resources used by a running process
+//======================================================================================================================
+
+#include "ProcessMonitor.hpp"
+
+#include <QFile>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+#if !IS_WINDOWS
+	#include <unistd.h>  // sysconf
+#endif
+
+
+namespace os {
+
+
+//======================================================================================================================
+//  Linux /proc parsing
+
+#if !IS_WINDOWS
+
+/// Raw values read from the /proc files.
+struct ProcCounters
+{
+	quint64 cpuTicks = 0;  ///< user + system time in clock ticks
+	qint64 rss_bytes = 0;
+	qint64 readBytes = 0;
+	int threadCount = 0;
+};
+
+static QByteArray readProcFile( qint64 pid, const char * fileName )
+{
+	// these files report size 0, but readAll() reads them until the end anyway
+	QFile file( QStringLiteral("/proc/%1/%2").arg( pid ).arg( fileName ) );
+	if (!file.open( QIODevice::ReadOnly ))
+		return {};
+	return file.readAll();
+}
+
+/// Finds a line like "VmRSS:   123456 kB" and returns the number, or -1 if the key is not present.
+static qint64 findValueOfKey( const QByteArray & content, const char * key )
+{
+	int keyPos = content.indexOf( key );
+	if (keyPos < 0)
+		return -1;
+
+	int pos = keyPos + int( qstrlen( key ) );
+	while (pos < content.size() && (content[ pos ] == ' ' || content[ pos ] == '\t'))
+		++pos;
+
+	qint64 value = 0;
+	bool found = false;
+	while (pos < content.size() && content[ pos ] >= '0' && content[ pos ] <= '9')
+	{
+		value = value * 10 + (content[ pos ] - '0');
+		found = true;
+		++pos;
+	}
+	return found ? value : -1;
+}
+
+/// Returns false if the process no longer exists.
+static bool readProcCounters( qint64 pid, ProcCounters & counters )
+{
+	// https://man7.org/linux/man-pages/man5/proc_pid_stat.5.html
+	QByteArray stat = readProcFile( pid, "stat" );
+	if (stat.isEmpty())
+		return false;
+
+	// the 2nd field is the executable name in parentheses and it can contain spaces
+	int nameEnd = stat.lastIndexOf( ')' );
+	if (nameEnd < 0)
+		return false;
+	const QList< QByteArray > fields = stat.mid( nameEnd + 2 ).split(' ');  // starts with the 3rd field
+	constexpr int firstField = 3, utimeField = 14, stimeField = 15;
+	if (fields.size() <= stimeField - firstField)
+		return false;
+	counters.cpuTicks = fields[ utimeField - firstField ].toULongLong() + fields[ stimeField - firstField ].toULongLong();
+
+	QByteArray status = readProcFile( pid, "status" );
+	qint64 rss_kB = findValueOfKey( status, "VmRSS:" );
+	counters.rss_bytes = rss_kB >= 0 ? rss_kB * 1024 : 0;
+	counters.threadCount = int( std::max( findValueOfKey( status, "Threads:" ), qint64(0) ) );
+
+	// might not be readable when the process runs in a sandbox
+	QByteArray io = readProcFile( pid, "io" );
+	counters.readBytes = std::max( findValueOfKey( io, "rchar:" ), qint64(0) );
+
+	return true;
+}
+
+#endif // !IS_WINDOWS
+
+
+//======================================================================================================================
+//  ProcessMonitor
+
+bool ProcessMonitor::isSupported()
+{
+	return !IS_WINDOWS;
+}
+
+ProcessMonitor::ProcessMonitor()
+:
+	LoggingComponent("ProcessMonitor"),
+	_stopRequested( false )
+{
+	qRegisterMetaType< os::ProcessResourceSample >();
+}
+
+ProcessMonitor::~ProcessMonitor()
+{
+	stop();
+}
+
+bool ProcessMonitor::start( qint64 pid, int samplingPeriod_ms )
+{
+	if (!isSupported())
+	{
+		return false;
+	}
+	if (QThread::isRunning())
+	{
+		logLogicError() << "attempting to start a monitoring thread that is already running";
+		return false;
+	}
+
+	_pid = pid;
+	_samplingPeriod_ms = std::max( samplingPeriod_ms, 10 );
+	_stopRequested = false;
+	{
+		QMutexLocker lock( &_summaryMutex );
+		_summary = ProcessResourceSummary();
+	}
+
+	LOG_DEBUG() << "starting to monitor process " << pid << " every " << _samplingPeriod_ms << " ms";
+	QThread::start( QThread::LowPriority );  // don't steal CPU from the game
+	return true;
+}
+
+void ProcessMonitor::stop()
+{
+	{
+		QMutexLocker lock( &_stopMutex );
+		_stopRequested = true;
+		_stopCondition.wakeAll();
+	}
+	QThread::wait();
+}
+
+ProcessResourceSummary ProcessMonitor::summary() const
+{
+	QMutexLocker lock( &_summaryMutex );
+	return _summary;
+}
+
+bool ProcessMonitor::waitForNextSample()
+{
+	QMutexLocker lock( &_stopMutex );
+	if (!_stopRequested)
+		_stopCondition.wait( &_stopMutex, ulong( _samplingPeriod_ms ) );
+	return !_stopRequested;
+}
+
+void ProcessMonitor::run()
+{
+	// This will run in a separate thread.
+
+ #if !IS_WINDOWS
+
+	const long ticksPerSecond = sysconf( _SC_CLK_TCK );
+
+	QElapsedTimer timer;
+	timer.start();
+
+	ProcCounters counters;
+	quint64 prevCpuTicks = 0;
+	qint64 prevElapsed_ms = 0;
+	bool hasPrevSample = false;  // the first interval would be only the time since the start, the CPU % would be nonsense
+
+	do
+	{
+		if (!readProcCounters( _pid, counters ))
+		{
+			break;  // the process has exited
+		}
+
+		ProcessResourceSample sample;
+		sample.elapsed_ms = timer.elapsed();
+		sample.rss_bytes = counters.rss_bytes;
+		sample.readBytes = counters.readBytes;
+		sample.threadCount = counters.threadCount;
+
+		qint64 interval_ms = sample.elapsed_ms - prevElapsed_ms;
+		if (hasPrevSample && interval_ms > 0 && ticksPerSecond > 0)
+		{
+			double cpuSeconds = double( counters.cpuTicks - prevCpuTicks ) / double( ticksPerSecond );
+			sample.cpuPercent = cpuSeconds * 1000.0 / double( interval_ms ) * 100.0;
+		}
+		prevCpuTicks = counters.cpuTicks;
+		prevElapsed_ms = sample.elapsed_ms;
+		hasPrevSample = true;
+
+		{
+			QMutexLocker lock( &_summaryMutex );
+			_summary.duration_ms = sample.elapsed_ms;
+			_summary.peakRss_bytes = std::max( _summary.peakRss_bytes, sample.rss_bytes );
+			_summary.peakCpuPercent = std::max( _summary.peakCpuPercent, sample.cpuPercent );
+			_summary.totalReadBytes = sample.readBytes;
+			_summary.peakThreadCount = std::max( _summary.peakThreadCount, sample.threadCount );
+			// the counters accumulate since the process start, which is just before the monitoring start
+			if (sample.elapsed_ms > 0 && ticksPerSecond > 0)
+				_summary.avgCpuPercent = double( counters.cpuTicks ) / double( ticksPerSecond ) * 1000.0 / double( sample.elapsed_ms ) * 100.0;
+			_summary.sampleCount++;
+		}
+
+		// The signal will be delivered to the thread of this object as a queued event.
+		emit sampleTaken( sample );
+	}
+	while (waitForNextSample());
+
+ #endif // !IS_WINDOWS
+}
+
+
+} // namespace os
@@ -0,0 +1,111 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: periodic sampling of resources used by a running process
+//======================================================================================================================
+
+#ifndef PROCESS_MONITOR_INCLUDED
+#define PROCESS_MONITOR_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "ErrorHandling.hpp"  // LoggingComponent
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+
+
+namespace os {
+
+
+//======================================================================================================================
+
+/// Resources used by a process at a moment.
+struct ProcessResourceSample
+{
+	qint64 elapsed_ms = 0;     ///< time since the monitoring started
+	double cpuPercent = 0.0;   ///< CPU usage since the previous sample (0 in the first one), 100% means one fully utilized core
+	qint64 rss_bytes = 0;      ///< resident memory
+	qint64 readBytes = 0;      ///< total bytes the process has read so far, including the page cache hits
+	int threadCount = 0;
+};
+
+/// Overall statistics of the whole monitoring session.
+struct ProcessResourceSummary
+{
+	qint64 duration_ms = 0;
+	qint64 peakRss_bytes = 0;
+	double avgCpuPercent = 0.0;
+	double peakCpuPercent = 0.0;
+	qint64 totalReadBytes = 0;
+	int peakThreadCount = 0;
+	int sampleCount = 0;  ///< 0 means nothing was measured
+};
+
+
+//======================================================================================================================
+/// Samples the resource usage of another process in a background thread.
+/** Currently implemented only on Linux, where the information can be read from /proc/<pid>/. */
+
+class ProcessMonitor : public QThread, protected LoggingComponent {
+
+	Q_OBJECT
+
+ public:
+
+	static constexpr int defaultSamplingPeriod_ms = 500;
+
+	/// Whether the monitoring is implemented on this system.
+	static bool isSupported();
+
+	ProcessMonitor();
+	virtual ~ProcessMonitor() override;
+
+	/// Starts sampling the process in a background thread.
+	bool start( qint64 pid, int samplingPeriod_ms = defaultSamplingPeriod_ms );
+
+	/// Signals the background thread to quit and waits for it. Returns immediately if it's not running.
+	void stop();
+
+	/// Statistics collected so far, can be called from any thread.
+	ProcessResourceSummary summary() const;
+
+ signals:
+
+	/// Emitted from the background thread after every sample, delivered to the thread that constructed this object.
+	void sampleTaken( const os::ProcessResourceSample & sample );
+
+ private:
+
+	virtual void run() override;
+
+	/// Sleeps until the next sample is due, returns false if the thread should quit.
+	bool waitForNextSample();
+
+ private:
+
+	qint64 _pid = 0;
+	int _samplingPeriod_ms = defaultSamplingPeriod_ms;
+
+	std::atomic< bool > _stopRequested;
+	QMutex _stopMutex;
+	QWaitCondition _stopCondition;
+
+	mutable QMutex _summaryMutex;
+	ProcessResourceSummary _summary;
+
+};
+
+
+} // namespace os
+
+// without this we cannot use our own types as parameters of signals emitted from another thread
+Q_DECLARE_METATYPE( os::ProcessResourceSample )
+
+
+#endif // PROCESS_MONITOR_INCLUDED
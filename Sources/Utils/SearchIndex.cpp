@@ -0,0 +1,124 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: index for fast sub-string search in a large list of strings
+//======================================================================================================================
+
+#include "SearchIndex.hpp"
+
+#include <algorithm>  // sort, unique, lower_bound, set_intersection
+#include <numeric>  // iota
+#include <iterator>  // back_inserter
+
+
+//======================================================================================================================
+//  TrigramIndex
+
+QVector< TrigramIndex::Trigram > TrigramIndex::getTrigrams( const QString & str )
+{
+	QVector< Trigram > trigrams;
+	if (str.size() < trigramLength)
+		return trigrams;
+
+	QString folded = str.toCaseFolded();
+	trigrams.reserve( folded.size() - trigramLength + 1 );
+	for (int i = 0; i + trigramLength <= folded.size(); ++i)
+	{
+		trigrams.append(
+			  (Trigram( folded[i].unicode() ) << 32)
+			| (Trigram( folded[i+1].unicode() ) << 16)
+			|  Trigram( folded[i+2].unicode() )
+		);
+	}
+
+	// a trigram repeated in a string must be added to its posting list only once
+	std::sort( trigrams.begin(), trigrams.end() );
+	trigrams.erase( std::unique( trigrams.begin(), trigrams.end() ), trigrams.end() );
+
+	return trigrams;
+}
+
+void TrigramIndex::addToIndex( int idx )
+{
+	for (Trigram trigram : getTrigrams( _strings[ idx ] ))
+	{
+		QVector< int > & positions = _postings[ trigram ];
+		// the strings are mostly indexed in order, so this is usually an append
+		auto pos = std::lower_bound( positions.begin(), positions.end(), idx );
+		if (pos == positions.end() || *pos != idx)
+			positions.insert( pos, idx );
+	}
+}
+
+void TrigramIndex::removeFromIndex( int idx )
+{
+	for (Trigram trigram : getTrigrams( _strings[ idx ] ))
+	{
+		auto postingIter = _postings.find( trigram );
+		if (postingIter == _postings.end())
+			continue;
+
+		QVector< int > & positions = postingIter.value();
+		auto pos = std::lower_bound( positions.begin(), positions.end(), idx );
+		if (pos != positions.end() && *pos == idx)
+			positions.erase( pos );
+		if (positions.isEmpty())
+			_postings.erase( postingIter );
+	}
+}
+
+void TrigramIndex::resize( int newSize )
+{
+	for (int idx = newSize; idx < _strings.size(); ++idx)
+		removeFromIndex( idx );
+
+	_strings.resize( newSize );
+}
+
+void TrigramIndex::setString( int idx, const QString & str )
+{
+	removeFromIndex( idx );
+	_strings[ idx ] = str;
+	addToIndex( idx );
+}
+
+QVector< int > TrigramIndex::findCandidates( const QString & phrase ) const
+{
+	QVector< Trigram > trigrams = getTrigrams( phrase );
+	if (trigrams.isEmpty())
+	{
+		QVector< int > allPositions( _strings.size() );
+		std::iota( allPositions.begin(), allPositions.end(), 0 );
+		return allPositions;
+	}
+
+	// start with the rarest trigram, so that the intermediate results are as small as possible
+	QVector< const QVector< int > * > postings;
+	postings.reserve( trigrams.size() );
+	for (Trigram trigram : trigrams)
+	{
+		auto postingIter = _postings.find( trigram );
+		if (postingIter == _postings.end())
+			return {};  // no string contains this part of the phrase
+		postings.append( &postingIter.value() );
+	}
+	std::sort( postings.begin(), postings.end(), []( const QVector< int > * p1, const QVector< int > * p2 )
+	{
+		return p1->size() < p2->size();
+	});
+
+	QVector< int > candidates = *postings[0];
+	QVector< int > intersection;
+	for (int i = 1; i < postings.size() && !candidates.isEmpty(); ++i)
+	{
+		intersection.clear();
+		std::set_intersection(
+			candidates.begin(), candidates.end(), postings[i]->begin(), postings[i]->end(),
+			std::back_inserter( intersection )
+		);
+		std::swap( candidates, intersection );
+	}
+
+	return candidates;
+}
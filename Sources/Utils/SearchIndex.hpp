@@ -0,0 +1,70 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: index for fast sub-string search in a large list of strings
+//======================================================================================================================
+
+#ifndef SEARCH_INDEX_INCLUDED
+#define SEARCH_INDEX_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+
+//======================================================================================================================
+/// Maps every 3-character sequence (trigram) to the strings containing it.
+/** A string can contain a phrase only if it contains all the trigrams of the phrase, so intersecting their lists
+  * gives a small set of candidates that then needs to be verified by QString::contains().
+  * The index is case-insensitive, so the candidates are valid for both the case-sensitive and insensitive search.
+  * Strings are identified by their index in the list they came from. */
+
+class TrigramIndex {
+
+ public:
+
+	/// Phrases shorter than this can't be narrowed down by the index.
+	static constexpr int trigramLength = 3;
+
+	int size() const  { return _strings.size(); }
+
+	/// Changes the number of indexed strings, new slots contain empty strings.
+	void resize( int newSize );
+
+	/// Indexes a new string at position \p idx, replacing the previous one.
+	void setString( int idx, const QString & str );
+
+	/// Whether the string at position \p idx is still the same one that was indexed.
+	/** This is only a cheap check of the shared string data, a modified string is always detected,
+	  * but an equal string allocated separately is reported as different. */
+	bool isIndexed( int idx, const QString & str ) const
+	{
+		return _strings[ idx ].constData() == str.constData() && _strings[ idx ].size() == str.size();
+	}
+
+	/// Returns sorted positions of all strings that may contain the phrase.
+	/** If the phrase is too short to be looked up, it returns all the positions. */
+	QVector< int > findCandidates( const QString & phrase ) const;
+
+ private:
+
+	using Trigram = quint64;
+
+	static QVector< Trigram > getTrigrams( const QString & str );
+
+	void addToIndex( int idx );
+	void removeFromIndex( int idx );
+
+ private:
+
+	QVector< QString > _strings;  ///< original strings, kept to detect when they change
+	QHash< Trigram, QVector< int > > _postings;  ///< sorted positions of strings containing the trigram
+
+};
+
+
+#endif // SEARCH_INDEX_INCLUDED
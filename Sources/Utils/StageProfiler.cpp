@@ -0,0 +1,36 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: measuring durations of stages of a longer process
+//======================================================================================================================
+
+#include "StageProfiler.hpp"
+
+#include <QString>
+
+
+//======================================================================================================================
+//  StageProfiler
+
+void StageProfiler::start()
+{
+	_timer.start();
+	_enabled = true;
+}
+
+void StageProfiler::logTimePoint( const char * desc )
+{
+	if (!_enabled)
+		return;
+
+	LOG_INFO().noquote() << QStringLiteral("%1 ms: %2").arg( _timer.elapsed(), 5 ).arg( desc );
+}
+
+void StageProfiler::logStage( const char * desc, qint64 start_ms, qint64 end_ms )
+{
+	if (!_enabled)
+		return;
+
+	LOG_INFO().noquote() << QStringLiteral("%1 ms: %2 took %3 ms").arg( start_ms, 5 ).arg( desc, -27 ).arg( end_ms - start_ms, 3 );
+}
@@ -0,0 +1,74 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: measuring durations of stages of a longer process
+//======================================================================================================================
+
+#ifndef STAGE_PROFILER_INCLUDED
+#define STAGE_PROFILER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "ErrorHandling.hpp"  // LoggingComponent
+
+#include <QElapsedTimer>
+
+
+//======================================================================================================================
+/// Measures how long the individual stages of a longer process take and writes it into the log.
+/** Unlike the tracing (see Tracing.hpp), this is a short human-readable summary that goes directly into the log.
+  * The stages can overlap or run in background threads. A background thread measures its own stage
+  * using elapsed_ms() and hands the times over to the thread that owns the profiler, which logs them with logStage().
+  * Until start() is called, the profiler is disabled and the measurements cost only a branch. */
+
+class StageProfiler : protected LoggingComponent {
+
+ public:
+
+	StageProfiler( const char * componentName ) : LoggingComponent( componentName ) {}
+
+	/// Enables the profiler, all the times are then relative to this moment.
+	void start();
+
+	bool isEnabled() const  { return _enabled; }
+
+	/// Time since start(), can be called from any thread.
+	qint64 elapsed_ms() const  { return _enabled ? _timer.elapsed() : 0; }
+
+	/// Logs a moment worth noting, like when the window has been shown.
+	void logTimePoint( const char * desc );
+
+	/// Logs a stage whose start and end have been measured elsewhere, like in a background thread.
+	void logStage( const char * desc, qint64 start_ms, qint64 end_ms );
+
+	/// Measures the stage from its construction to the end of its scope.
+	class Stage {
+
+		StageProfiler & _profiler;
+		const char * _desc;
+		qint64 _start_ms;
+
+	 public:
+
+		Stage( StageProfiler & profiler, const char * desc )
+			: _profiler( profiler ), _desc( desc ), _start_ms( profiler.elapsed_ms() ) {}
+
+		~Stage()
+		{
+			if (_profiler.isEnabled())
+				_profiler.logStage( _desc, _start_ms, _profiler.elapsed_ms() );
+		}
+
+	};
+
+ private:
+
+	QElapsedTimer _timer;
+	bool _enabled = false;
+
+};
+
+
+#endif // STAGE_PROFILER_INCLUDED
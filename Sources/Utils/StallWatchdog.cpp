@@ -0,0 +1,185 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: detection of moments when the GUI thread stops responding
+//======================================================================================================================
+
+#include "StallWatchdog.hpp"
+
+#include "Tracing.hpp"  // ThreadActivity
+
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QMetaObject>
+
+
+//======================================================================================================================
+//  StallStats
+
+int StallStats::bucketIndex( qint64 duration_ms )
+{
+	for (int bucketIdx = 0; bucketIdx < bucketCount - 1; ++bucketIdx)
+		if (duration_ms < bucketLimits_ms[ bucketIdx ])
+			return bucketIdx;
+	return bucketCount - 1;
+}
+
+QString StallStats::bucketLabel( int bucketIdx, qint64 threshold_ms )
+{
+	if (bucketIdx < 0 || bucketIdx >= bucketCount)
+		return {};
+
+	qint64 lower_ms = bucketIdx > 0 ? bucketLimits_ms[ bucketIdx - 1 ] : threshold_ms;
+	if (bucketIdx == bucketCount - 1)
+		return QStringLiteral("%1 ms and more").arg( lower_ms );
+	else
+		return QStringLiteral("%1 - %2 ms").arg( lower_ms ).arg( bucketLimits_ms[ bucketIdx ] );
+}
+
+
+//======================================================================================================================
+//  StallWatchdog
+
+StallWatchdog::StallWatchdog()
+:
+	LoggingComponent("StallWatchdog")
+{
+	QThread::setObjectName( "stall watchdog" );
+}
+
+StallWatchdog::~StallWatchdog()
+{
+	stop();
+}
+
+bool StallWatchdog::start( int threshold_ms )
+{
+	if (QThread::isRunning())
+	{
+		logLogicError() << "attempting to start a watchdog that is already running";
+		return false;
+	}
+
+	_threshold_ms = std::max( threshold_ms, 10 );
+	_watchedActivity = &tracing::currentThreadActivity();
+	{
+		QMutexLocker lock( &_mutex );
+		_answeredPing = 0;
+		_stopRequested = false;
+	}
+
+	LOG_DEBUG() << "starting to watch for stalls longer than " << _threshold_ms << " ms";
+	QThread::start( QThread::HighPriority );  // it needs to measure the time precisely even when the CPU is busy
+	return true;
+}
+
+void StallWatchdog::stop()
+{
+	{
+		QMutexLocker lock( &_mutex );
+		_stopRequested = true;
+		_condition.wakeAll();
+	}
+	QThread::wait();
+}
+
+StallStats StallWatchdog::stats() const
+{
+	QMutexLocker lock( &_statsMutex );
+	return _stats;
+}
+
+void StallWatchdog::resetStats()
+{
+	QMutexLocker lock( &_statsMutex );
+	_stats = StallStats();
+}
+
+void StallWatchdog::onPing( quint64 pingID )
+{
+	// This will run in the watched thread, as soon as it gets to process its events.
+
+	QMutexLocker lock( &_mutex );
+	_answeredPing = std::max( _answeredPing, pingID );
+	_condition.wakeAll();
+}
+
+void StallWatchdog::run()
+{
+	// This will run in the watchdog thread.
+
+	QElapsedTimer timer;
+	timer.start();
+
+	quint64 pingID = 0;
+
+	QMutexLocker lock( &_mutex );
+	while (!_stopRequested)
+	{
+		++pingID;
+		qint64 sent_ms = timer.elapsed();
+		// the slot will be called in the thread of this object, which is the watched thread
+		QMetaObject::invokeMethod( this, "onPing", Qt::QueuedConnection, Q_ARG( quint64, pingID ) );
+
+		// give the watched thread the threshold time to respond
+		while (_answeredPing < pingID && !_stopRequested)
+		{
+			qint64 remaining_ms = _threshold_ms - (timer.elapsed() - sent_ms);
+			if (remaining_ms <= 0)
+				break;
+			_condition.wait( &_mutex, ulong( remaining_ms ) );
+		}
+
+		if (!_stopRequested && _answeredPing < pingID)
+		{
+			// It's stalled, find out what it's doing while it's still doing it.
+			lock.unlock();
+			QString activity = _watchedActivity->describe();
+			lock.relock();
+
+			while (_answeredPing < pingID && !_stopRequested)
+			{
+				_condition.wait( &_mutex );
+			}
+			if (_stopRequested)
+				break;  // stop() is called from the watched thread, so this doesn't happen in the middle of a stall
+
+			qint64 duration_ms = timer.elapsed() - sent_ms;
+			lock.unlock();
+			recordStall( duration_ms, std::move(activity) );
+			lock.relock();
+		}
+
+		// wait until the next ping
+		qint64 nextPing_ms = sent_ms + pingPeriod_ms;
+		while (!_stopRequested)
+		{
+			qint64 remaining_ms = nextPing_ms - timer.elapsed();
+			if (remaining_ms <= 0)
+				break;
+			_condition.wait( &_mutex, ulong( remaining_ms ) );
+		}
+	}
+}
+
+void StallWatchdog::recordStall( qint64 duration_ms, QString activity )
+{
+	if (isLoggingEnabled())
+	{
+		LOG_INFO().noquote() << "GUI thread did not respond for " << duration_ms << " ms, it was in "
+		                     << (activity.isEmpty() ? "an unknown operation" : activity);
+	}
+
+	QMutexLocker lock( &_statsMutex );
+
+	_stats.histogram[ StallStats::bucketIndex( duration_ms ) ]++;
+	_stats.stallCount++;
+	_stats.totalDuration_ms += duration_ms;
+	_stats.longest_ms = std::max( _stats.longest_ms, duration_ms );
+
+	if (_stats.recentStalls.size() >= maxRecentStalls)
+		_stats.recentStalls.removeFirst();
+	_stats.recentStalls.append({ QDateTime::currentMSecsSinceEpoch(), duration_ms, std::move(activity) });
+}
@@ -0,0 +1,121 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: detection of moments when the GUI thread stops responding
+//======================================================================================================================
+
+#ifndef STALL_WATCHDOG_INCLUDED
+#define STALL_WATCHDOG_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "ErrorHandling.hpp"  // LoggingComponent
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QString>
+
+#include <atomic>
+#include <iterator>  // size
+
+namespace tracing {
+	class ThreadActivity;
+}
+
+
+//======================================================================================================================
+
+/// One period when the watched thread didn't process its events.
+struct ThreadStall
+{
+	qint64 endTime_ms = 0;    ///< milliseconds since epoch when the thread responded again
+	qint64 duration_ms = 0;
+	QString activity;         ///< what the thread was doing when the stall was detected, see tracing::ThreadActivity
+};
+
+/// Statistics of the stalls since the watching started or since the last reset.
+struct StallStats
+{
+	/// Upper limits of the histogram buckets, the last bucket contains everything longer.
+	static constexpr qint64 bucketLimits_ms [] = { 200, 500, 1000, 2000, 5000 };
+	static constexpr int bucketCount = int( std::size( bucketLimits_ms ) ) + 1;
+
+	int histogram [bucketCount] = {};
+	int stallCount = 0;
+	qint64 totalDuration_ms = 0;
+	qint64 longest_ms = 0;
+	QVector< ThreadStall > recentStalls;  ///< the newest last
+
+	static int bucketIndex( qint64 duration_ms );
+	static QString bucketLabel( int bucketIdx, qint64 threshold_ms );
+};
+
+
+//======================================================================================================================
+/// Periodically pings the event loop of a thread and measures how long it takes to respond.
+/** When the response takes longer than the threshold, the stall is recorded together with the trace zone
+  * the thread was in at that moment, which tells which synchronous operation was blocking it. */
+
+class StallWatchdog : public QThread, protected LoggingComponent {
+
+	Q_OBJECT
+
+ public:
+
+	static constexpr int defaultThreshold_ms = 100;
+	static constexpr int pingPeriod_ms = 50;
+	static constexpr int maxRecentStalls = 100;
+
+	/// Must be constructed in the thread that should be watched.
+	StallWatchdog();
+	virtual ~StallWatchdog() override;
+
+	/// Starts watching the thread of this object, must be called from that thread.
+	bool start( int threshold_ms = defaultThreshold_ms );
+
+	/// Signals the watchdog thread to quit and waits for it. Returns immediately if it's not running.
+	void stop();
+
+	int threshold_ms() const  { return _threshold_ms; }
+
+	/// Whether every stall should also be written into the log.
+	void setLoggingEnabled( bool enabled )  { _logStalls.store( enabled, std::memory_order_relaxed ); }
+	bool isLoggingEnabled() const  { return _logStalls.load( std::memory_order_relaxed ); }
+
+	/// Statistics collected so far, can be called from any thread.
+	StallStats stats() const;
+
+	void resetStats();
+
+ private slots:
+
+	void onPing( quint64 pingID );
+
+ private:
+
+	virtual void run() override;
+
+	void recordStall( qint64 duration_ms, QString activity );
+
+ private:
+
+	int _threshold_ms = defaultThreshold_ms;
+	tracing::ThreadActivity * _watchedActivity = nullptr;
+	std::atomic< bool > _logStalls { false };
+
+	QMutex _mutex;  ///< protects the 2 variables below
+	QWaitCondition _condition;  ///< wakes up the watchdog thread when the ping is answered or when it should stop
+	quint64 _answeredPing = 0;
+	bool _stopRequested = false;
+
+	mutable QMutex _statsMutex;
+	StallStats _stats;
+
+};
+
+
+#endif // STALL_WATCHDOG_INCLUDED
@@ -0,0 +1,387 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: shared worker threads that run prioritized tasks and deliver their results to the GUI thread
+//======================================================================================================================
+
+#include "TaskScheduler.hpp"
+
+#include "Tracing.hpp"
+
+#include <QThread>
+#include <QMutexLocker>
+#include <QCoreApplication>
+#include <QEvent>
+
+#include <algorithm>
+
+
+namespace tasks {
+
+
+//======================================================================================================================
+//  TaskGroup
+
+TaskGroup::TaskGroup()
+:
+	_state( std::make_shared< State >() )
+{}
+
+TaskGroup::~TaskGroup()
+{
+	cancel();
+	waitForDone();
+}
+
+void TaskGroup::cancel()
+{
+	_state->generation.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void TaskGroup::waitForDone()
+{
+	QMutexLocker lock( &_state->mutex );
+	while (_state->pending > 0)
+	{
+		_state->allDone.wait( &_state->mutex );
+	}
+}
+
+bool TaskGroup::isIdle() const
+{
+	QMutexLocker lock( &_state->mutex );
+	return _state->pending == 0;
+}
+
+CancellationToken TaskGroup::token() const
+{
+	// the token shares the ownership of the whole state, but sees only the generation
+	return CancellationToken(
+		std::shared_ptr< const std::atomic< int > >( _state, &_state->generation ),
+		_state->generation.load( std::memory_order_relaxed )
+	);
+}
+
+void TaskGroup::taskSubmitted( State & state )
+{
+	QMutexLocker lock( &state.mutex );
+	state.pending++;
+}
+
+void TaskGroup::taskFinished( State & state )
+{
+	QMutexLocker lock( &state.mutex );
+	if (--state.pending == 0)
+		state.allDone.wakeAll();
+}
+
+
+//======================================================================================================================
+//  internal types
+
+struct TaskScheduler::Task
+{
+	TaskID id;
+	Priority priority;
+	Work work;
+	CancellationToken token;
+	std::shared_ptr< TaskGroup::State > group;
+
+	QPointer< QObject > receiver;
+	std::function< void () > deliver;  ///< empty if the task has no result to deliver
+
+	int unfinishedDependencies = 0;
+	QVector< TaskID > dependents;  ///< tasks waiting for this one
+};
+
+class TaskScheduler::Worker : public QThread {
+
+	TaskScheduler * _scheduler;
+
+ public:
+
+	Worker( TaskScheduler * scheduler, int index ) : _scheduler( scheduler )
+	{
+		QThread::setObjectName( QStringLiteral("task worker %1").arg( index ) );  // shown in the traces
+	}
+
+	virtual void run() override
+	{
+		_scheduler->workerLoop();
+	}
+
+};
+
+/// Carries the result of a task to the thread of the scheduler.
+class DeliveryEvent : public QEvent {
+
+ public:
+
+	static QEvent::Type eventType()
+	{
+		static const QEvent::Type type = QEvent::Type( QEvent::registerEventType() );
+		return type;
+	}
+
+	DeliveryEvent( QPointer< QObject > receiver, CancellationToken token, std::function< void () > deliver )
+	:
+		QEvent( eventType() ),
+		receiver( std::move(receiver) ),
+		token( std::move(token) ),
+		deliver( std::move(deliver) )
+	{}
+
+	QPointer< QObject > receiver;
+	CancellationToken token;
+	std::function< void () > deliver;
+
+};
+
+
+//======================================================================================================================
+//  TaskScheduler
+
+int TaskScheduler::defaultThreadCount()
+{
+	return std::max( QThread::idealThreadCount(), 2 );
+}
+
+TaskScheduler::TaskScheduler( int threadCount )
+:
+	LoggingComponent("TaskScheduler"),
+	_threadCount( std::max( threadCount, 1 ) ),
+	_maxBackgroundThreads( std::max( _threadCount / 2, 1 ) ),
+	_tasksRun( "Task scheduler", "tasks run" ),
+	_tasksCancelled( "Task scheduler", "tasks cancelled" ),
+	_tasksQueued( "Task scheduler", "tasks waiting", [ this ]()
+	{
+		QMutexLocker lock( &_mutex );
+		return QStringLiteral("%1 interactive, %2 prefetch, %3 background, %4 total unfinished")
+			.arg( _queues[ int( Priority::Interactive ) ].size() )
+			.arg( _queues[ int( Priority::VisiblePrefetch ) ].size() )
+			.arg( _queues[ int( Priority::BackgroundIdle ) ].size() )
+			.arg( _unfinished.size() );
+	})
+{}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		QMutexLocker lock( &_mutex );
+		_stopping = true;
+		_workAvailable.wakeAll();
+	}
+
+	for (auto & worker : _workers)
+		worker->wait();
+
+	// The owners of the groups may still be waiting for the tasks that will now never run.
+	for (const auto & task : as_const( _unfinished ))
+		TaskGroup::taskFinished( *task->group );
+	_unfinished.clear();
+}
+
+void TaskScheduler::startWorkers()
+{
+	// mutex is already locked by the caller
+
+	LOG_DEBUG() << "starting " << _threadCount << " worker threads";
+
+	_workers.reserve( size_t( _threadCount ) );
+	for (int i = 0; i < _threadCount; ++i)
+	{
+		_workers.push_back( std::make_unique< Worker >( this, i + 1 ) );
+		_workers.back()->start();
+	}
+}
+
+TaskID TaskScheduler::enqueue(
+	Priority priority, TaskGroup & group, Work work, QObject * receiver, std::function< void () > deliver,
+	const QVector< TaskID > & dependencies
+){
+	auto task = std::make_shared< Task >();
+	task->priority = priority;
+	task->work = std::move(work);
+	task->token = group.token();
+	task->group = group._state;
+	task->receiver = receiver;
+	task->deliver = std::move(deliver);
+
+	TaskGroup::taskSubmitted( *task->group );
+
+	QMutexLocker lock( &_mutex );
+
+	if (_stopping)
+	{
+		logLogicError() << "attempting to submit a task during the application shutdown";
+		TaskGroup::taskFinished( *task->group );
+		return 0;
+	}
+
+	if (_workers.empty())
+		startWorkers();
+
+	task->id = ++_lastTaskID;
+
+	for (TaskID dependencyID : dependencies)
+	{
+		auto dependencyIter = _unfinished.find( dependencyID );
+		if (dependencyIter != _unfinished.end())
+		{
+			(*dependencyIter)->dependents.append( task->id );
+			task->unfinishedDependencies++;
+		}
+	}
+
+	_unfinished.insert( task->id, task );
+
+	if (task->unfinishedDependencies == 0)
+	{
+		_queues[ int( priority ) ].push_back( task );
+		_workAvailable.wakeOne();
+	}
+
+	return task->id;
+}
+
+std::shared_ptr< TaskScheduler::Task > TaskScheduler::takeNextTask()
+{
+	// mutex is already locked by the caller
+
+	for (int priorityIdx = 0; priorityIdx < priorityCount; ++priorityIdx)
+	{
+		auto & queue = _queues[ priorityIdx ];
+		if (queue.empty())
+			continue;
+		if (Priority( priorityIdx ) == Priority::BackgroundIdle && _runningBackgroundTasks >= _maxBackgroundThreads)
+			continue;
+
+		auto task = std::move( queue.front() );
+		queue.pop_front();
+		return task;
+	}
+	return nullptr;
+}
+
+void TaskScheduler::workerLoop()
+{
+	// This will run in a worker thread.
+
+	QThread::Priority currentThreadPriority = QThread::NormalPriority;
+
+	QMutexLocker lock( &_mutex );
+	while (true)
+	{
+		std::shared_ptr< Task > task;
+		while (!_stopping && !(task = takeNextTask()))
+		{
+			_workAvailable.wait( &_mutex );
+		}
+		if (_stopping)
+			return;
+
+		bool isBackground = task->priority == Priority::BackgroundIdle;
+		if (isBackground)
+			_runningBackgroundTasks++;
+
+		lock.unlock();
+
+		// Don't let the background work compete with the GUI and the tasks the user is waiting for.
+		QThread::Priority wantedThreadPriority = isBackground ? QThread::LowPriority : QThread::NormalPriority;
+		if (wantedThreadPriority != currentThreadPriority)
+		{
+			QThread::currentThread()->setPriority( wantedThreadPriority );
+			currentThreadPriority = wantedThreadPriority;
+		}
+
+		runTask( *task );
+
+		lock.relock();
+
+		if (isBackground)
+		{
+			_runningBackgroundTasks--;
+			if (!_queues[ int( Priority::BackgroundIdle ) ].empty())
+				_workAvailable.wakeOne();  // a background slot has been freed
+		}
+
+		finishTask( *task );
+	}
+}
+
+void TaskScheduler::runTask( Task & task )
+{
+	// This will run in a worker thread.
+
+	if (task.token.isCancelled())
+	{
+		_tasksCancelled.increment();
+	}
+	else
+	{
+		{
+			TRACE_ZONE( "TaskScheduler::runTask" );
+			task.work( task.token );
+		}
+		_tasksRun.increment();
+
+		if (task.deliver && !task.token.isCancelled())
+		{
+			// the event will be processed in the thread of the scheduler, which is the GUI thread
+			QCoreApplication::postEvent( this, new DeliveryEvent( task.receiver, task.token, std::move(task.deliver) ) );
+		}
+	}
+
+	// the work may hold resources of the group owner, release them before the owner learns the task has finished
+	task.work = nullptr;
+	task.deliver = nullptr;
+
+	TaskGroup::taskFinished( *task.group );
+}
+
+void TaskScheduler::finishTask( const Task & task )
+{
+	// mutex is already locked by the caller
+
+	for (TaskID dependentID : task.dependents)
+	{
+		auto dependentIter = _unfinished.find( dependentID );
+		if (dependentIter == _unfinished.end())
+			continue;
+		Task & dependent = **dependentIter;
+		if (--dependent.unfinishedDependencies == 0)
+		{
+			_queues[ int( dependent.priority ) ].push_back( *dependentIter );
+			_workAvailable.wakeOne();
+		}
+	}
+
+	_unfinished.remove( task.id );
+}
+
+bool TaskScheduler::event( QEvent * event )
+{
+	if (event->type() == DeliveryEvent::eventType())
+	{
+		auto * deliveryEvent = static_cast< DeliveryEvent * >( event );
+		if (deliveryEvent->receiver && !deliveryEvent->token.isCancelled())
+			deliveryEvent->deliver();
+		return true;
+	}
+
+	return QObject::event( event );
+}
+
+
+//======================================================================================================================
+//  shared instance
+
+TaskScheduler & sharedScheduler()
+{
+	static TaskScheduler scheduler;
+	return scheduler;
+}
+
+
+} // namespace tasks
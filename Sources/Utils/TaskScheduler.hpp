@@ -0,0 +1,241 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: shared worker threads that run prioritized tasks and deliver their results to the GUI thread
+//======================================================================================================================
+
+#ifndef TASK_SCHEDULER_INCLUDED
+#define TASK_SCHEDULER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "ErrorHandling.hpp"  // LoggingComponent
+#include "Metrics.hpp"
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <type_traits>
+
+
+//======================================================================================================================
+// Usage:
+//
+//   class Component : public QObject {
+//       tasks::TaskGroup taskGroup;   // cancels and waits for the tasks when the component is destroyed
+//       ...
+//       void doSomethingAsync( QString filePath )
+//       {
+//           tasks::sharedScheduler().submitWithResult( tasks::Priority::VisiblePrefetch, taskGroup,
+//               /*work*/[ filePath ]( const tasks::CancellationToken & ) { return readSomething( filePath ); },  // worker thread
+//               /*receiver*/this,
+//               /*onDone*/[ this ]( Something result ) { useSomething( result ); }  // GUI thread
+//           );
+//       }
+//   };
+//
+// All the background work of the application shares a bounded number of threads, instead of every component
+// spawning its own threads and oversubscribing the CPU and the disk. Interactive tasks always go first,
+// the background ones can occupy only a part of the threads and run with a lowered OS priority.
+
+namespace tasks {
+
+
+enum class Priority
+{
+	Interactive,      ///< the user is waiting for the result right now, like loading the options during the startup
+	VisiblePrefetch,  ///< the result will be displayed soon, like whether the files in the shown list exist
+	BackgroundIdle,   ///< nobody is waiting for the result, like probing the engine executables or saving the options
+};
+constexpr int priorityCount = int( Priority::BackgroundIdle ) + 1;
+
+using TaskID = quint64;
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Tells a task whether its result is still needed, long tasks should check it periodically.
+class CancellationToken {
+
+	std::shared_ptr< const std::atomic< int > > _generation;
+	int _issuedGeneration = 0;
+
+	friend class TaskGroup;
+	CancellationToken( std::shared_ptr< const std::atomic< int > > generation, int issuedGeneration )
+		: _generation( std::move(generation) ), _issuedGeneration( issuedGeneration ) {}
+
+ public:
+
+	/// Token that is never cancelled.
+	CancellationToken() = default;
+
+	bool isCancelled() const
+	{
+		return _generation && _generation->load( std::memory_order_relaxed ) != _issuedGeneration;
+	}
+
+};
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Tasks of one owner that can be cancelled and waited for together.
+/** Destroying the group cancels its tasks and waits for the ones that are running,
+  * so a group that is a member of an object guarantees that no task outlives the object. */
+class TaskGroup {
+
+ public:
+
+	TaskGroup();
+	~TaskGroup();
+
+	TaskGroup( const TaskGroup & ) = delete;
+	TaskGroup & operator=( const TaskGroup & ) = delete;
+
+	/// Tasks submitted so far that haven't started yet will not start, the running ones will see it in their token,
+	/// and their results will not be delivered. Tasks submitted after this are not affected.
+	void cancel();
+
+	/// Blocks until all the submitted tasks have finished running. Must not be called from a task.
+	/** The results that are still waiting for delivery to the GUI thread are delivered later. */
+	void waitForDone();
+
+	bool isIdle() const;
+
+	CancellationToken token() const;
+
+ private:
+
+	friend class TaskScheduler;
+
+	struct State
+	{
+		std::atomic< int > generation { 0 };
+		mutable QMutex mutex;  ///< protects the pending count
+		QWaitCondition allDone;
+		int pending = 0;
+	};
+	static void taskSubmitted( State & state );
+	static void taskFinished( State & state );
+
+	std::shared_ptr< State > _state;  ///< the tasks keep it alive, in case they finish after the group is destroyed
+
+};
+
+
+//======================================================================================================================
+/// Runs tasks in a bounded number of worker threads, in the order of their priority.
+/** The results are delivered to the thread that constructed the scheduler, which is the GUI thread.
+  * A task can depend on other tasks, then it's started only after all of them have finished
+  * (no matter whether they were cancelled). */
+
+class TaskScheduler : public QObject, protected LoggingComponent {
+
+	Q_OBJECT
+
+ public:
+
+	using Work = std::function< void ( const CancellationToken & ) >;
+
+	static int defaultThreadCount();
+
+	/// Must be constructed in the thread the results should be delivered to. The threads are started on the first task.
+	TaskScheduler( int threadCount = defaultThreadCount() );
+
+	/// Drops the tasks that haven't started yet and waits for the running ones.
+	virtual ~TaskScheduler() override;
+
+	/// Queues the work to be run in a worker thread once all its dependencies have finished.
+	/** Dependencies that have already finished are ignored. The returned ID can be used as a dependency of other tasks. */
+	TaskID submit( Priority priority, TaskGroup & group, Work work, const QVector< TaskID > & dependencies = {} )
+	{
+		return enqueue( priority, group, std::move(work), nullptr, {}, dependencies );
+	}
+
+	/// Like submit(), but then calls onDone with the result of the work in the thread of the scheduler.
+	/** The result is not delivered if the group has been cancelled or the receiver destroyed in the meantime. */
+	template< typename WorkFunc, typename OnDoneFunc >
+	TaskID submitWithResult(
+		Priority priority, TaskGroup & group, WorkFunc work, QObject * receiver, OnDoneFunc onDone,
+		const QVector< TaskID > & dependencies = {}
+	){
+		using Result = std::decay_t< decltype( work( std::declval< const CancellationToken & >() ) ) >;
+
+		if constexpr (std::is_void_v< Result >)
+		{
+			return enqueue( priority, group, std::move(work), receiver, std::move(onDone), dependencies );
+		}
+		else
+		{
+			// the work and the delivery are separate steps in different threads, the result waits between them here
+			auto result = std::make_shared< Result >();
+			return enqueue( priority, group,
+				/*work*/[ work = std::move(work), result ]( const CancellationToken & token ) { *result = work( token ); },
+				receiver,
+				/*deliver*/[ onDone = std::move(onDone), result ]() { onDone( std::move( *result ) ); },
+				dependencies
+			);
+		}
+	}
+
+ protected:
+
+	virtual bool event( QEvent * event ) override;
+
+ private:
+
+	struct Task;
+	class Worker;
+	friend class Worker;
+
+	TaskID enqueue(
+		Priority priority, TaskGroup & group, Work work, QObject * receiver, std::function< void () > deliver,
+		const QVector< TaskID > & dependencies
+	);
+
+	void startWorkers();
+	void workerLoop();
+	std::shared_ptr< Task > takeNextTask();
+	void runTask( Task & task );
+	void finishTask( const Task & task );
+
+ private:
+
+	int _threadCount;
+	int _maxBackgroundThreads;  ///< the rest of the threads is kept for the more important tasks
+
+	QMutex _mutex;  ///< protects all the members below
+	QWaitCondition _workAvailable;
+	std::vector< std::unique_ptr< Worker > > _workers;
+	std::deque< std::shared_ptr< Task > > _queues [priorityCount];  ///< tasks whose dependencies have all finished
+	QHash< TaskID, std::shared_ptr< Task > > _unfinished;  ///< waiting for dependencies, queued or running
+	TaskID _lastTaskID = 0;
+	int _runningBackgroundTasks = 0;
+	bool _stopping = false;
+
+	metrics::Counter _tasksRun;
+	metrics::Counter _tasksCancelled;
+	metrics::Gauge _tasksQueued;
+
+};
+
+/// The scheduler shared by the whole application.
+/** The first call must come from the GUI thread, so that the results are delivered there. */
+TaskScheduler & sharedScheduler();
+
+
+} // namespace tasks
+
+
+#endif // TASK_SCHEDULER_INCLUDED
@@ -0,0 +1,348 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: recording of performance traces that can be viewed in chrome://tracing or Perfetto
+//======================================================================================================================
+
+#include "Tracing.hpp"
+
+#include "FileSystemUtils.hpp"  // updateFileSafely
+
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QCoreApplication>
+
+#include <chrono>
+
+
+namespace tracing {
+
+
+//======================================================================================================================
+//  event storage
+
+enum class EventType : uint8_t
+{
+	Zone,
+	Counter,
+	Instant,
+};
+
+struct Event
+{
+	const char * name;
+	qint64 time_ns;
+	qint64 value;  ///< end time for zones, value for counters
+	EventType type;
+};
+
+/// Part of a list of events recorded by a single thread.
+/** Only the owner thread writes into it, the exporter reads only the events that have been published by \c count. */
+struct EventChunk
+{
+	static constexpr int capacity = 4096;
+
+	Event events [capacity];
+	std::atomic< int > count { 0 };
+	std::atomic< EventChunk * > next { nullptr };
+};
+
+static constexpr int maxChunksPerThread = 256;  ///< 1M events, a runaway loop must not eat all the memory
+
+struct ThreadBuffer
+{
+	int threadID = 0;
+	QString threadName;
+
+	std::atomic< EventChunk * > firstChunk { nullptr };  ///< replaced when a new recording session starts
+	std::atomic< int > session { -1 };  ///< recording session the events in the list belong to
+	std::atomic< qint64 > droppedCount { 0 };  ///< events that didn't fit into the limit
+
+	// accessed only by the owner thread
+	EventChunk * lastChunk = nullptr;
+	int chunkCount = 0;
+};
+
+static QMutex & registryMutex()  // protects only the lists below, never the recording itself
+{
+	static QMutex mutex;
+	return mutex;
+}
+static QVector< ThreadBuffer * > & threadBuffers()  // never deleted, the threads might end before the export
+{
+	static QVector< ThreadBuffer * > buffers;
+	return buffers;
+}
+static QVector< EventChunk * > & retiredLists()  // lists of the previous sessions, freed when it's safe
+{
+	static QVector< EventChunk * > lists;
+	return lists;
+}
+
+static thread_local ThreadBuffer * t_threadBuffer = nullptr;
+
+static std::atomic< int > g_session { 0 };
+
+static const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+static void freeChunkList( EventChunk * chunk )
+{
+	while (chunk)
+	{
+		EventChunk * next = chunk->next.load( std::memory_order_relaxed );
+		delete chunk;
+		chunk = next;
+	}
+}
+
+static ThreadBuffer * getThreadBuffer()
+{
+	if (!t_threadBuffer)
+	{
+		auto buffer = new ThreadBuffer;
+
+		QThread * thread = QThread::currentThread();
+		if (!thread->objectName().isEmpty())
+			buffer->threadName = thread->objectName();
+		else if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+			buffer->threadName = "GUI thread";
+
+		QMutexLocker locker( &registryMutex() );
+		buffer->threadID = threadBuffers().size() + 1;
+		if (buffer->threadName.isEmpty())
+			buffer->threadName = "thread " + QString::number( buffer->threadID );
+		threadBuffers().append( buffer );
+
+		t_threadBuffer = buffer;
+	}
+	return t_threadBuffer;
+}
+
+static void startNewList( ThreadBuffer * buffer, int session )
+{
+	EventChunk * oldList = buffer->firstChunk.load( std::memory_order_relaxed );
+
+	buffer->lastChunk = new EventChunk;
+	buffer->chunkCount = 1;
+	buffer->droppedCount.store( 0, std::memory_order_relaxed );
+	buffer->firstChunk.store( buffer->lastChunk, std::memory_order_release );
+	buffer->session.store( session, std::memory_order_release );
+
+	// the exporter might be reading it right now, it will be freed when the next session starts
+	if (oldList)
+	{
+		QMutexLocker locker( &registryMutex() );
+		retiredLists().append( oldList );
+	}
+}
+
+static void record( const char * name, EventType type, qint64 time_ns, qint64 value )
+{
+	ThreadBuffer * buffer = getThreadBuffer();
+
+	int session = g_session.load( std::memory_order_relaxed );
+	if (buffer->session.load( std::memory_order_relaxed ) != session)
+	{
+		startNewList( buffer, session );
+	}
+
+	EventChunk * chunk = buffer->lastChunk;
+	int idx = chunk->count.load( std::memory_order_relaxed );
+	if (idx == EventChunk::capacity)
+	{
+		if (buffer->chunkCount >= maxChunksPerThread)
+		{
+			buffer->droppedCount.fetch_add( 1, std::memory_order_relaxed );
+			return;
+		}
+
+		EventChunk * newChunk = new EventChunk;
+		chunk->next.store( newChunk, std::memory_order_release );
+		buffer->lastChunk = chunk = newChunk;
+		buffer->chunkCount++;
+		idx = 0;
+	}
+
+	chunk->events[ idx ] = { name, time_ns, value, type };
+	chunk->count.store( idx + 1, std::memory_order_release );  // publish the event to the exporter
+}
+
+
+//======================================================================================================================
+//  recording
+
+namespace impl {
+
+std::atomic< bool > g_enabled { false };
+
+thread_local ThreadActivity t_activity;
+
+qint64 now_ns()
+{
+	return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - g_epoch ).count();
+}
+
+void recordZone( const char * name, qint64 start_ns, qint64 end_ns )
+{
+	record( name, EventType::Zone, start_ns, end_ns );
+}
+
+void recordCounter( const char * name, qint64 value )
+{
+	record( name, EventType::Counter, now_ns(), value );
+}
+
+void recordInstant( const char * name )
+{
+	record( name, EventType::Instant, now_ns(), 0 );
+}
+
+} // namespace impl
+
+
+//======================================================================================================================
+//  thread activity
+
+ThreadActivity & currentThreadActivity()
+{
+	return impl::t_activity;
+}
+
+QString ThreadActivity::describe() const
+{
+	QMutexLocker locker( &_detailMutex );
+
+	const char * name = _zoneName.load( std::memory_order_relaxed );
+	const QString * detail = _zoneDetail.load( std::memory_order_relaxed );
+	if (!name)
+		return {};
+	else if (detail)
+		return QString( name ) + '(' + *detail + ')';
+	else
+		return QString( name );
+}
+
+
+//======================================================================================================================
+//  control
+
+void setEnabled( bool enabled )
+{
+	if (enabled == isEnabled())
+		return;
+
+	if (enabled)
+	{
+		// The threads have switched to new lists during the previous session, and nobody is exporting now,
+		// because the export runs in the same thread as this.
+		{
+			QMutexLocker locker( &registryMutex() );
+			for (EventChunk * list : retiredLists())
+				freeChunkList( list );
+			retiredLists().clear();
+		}
+
+		g_session.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	impl::g_enabled.store( enabled, std::memory_order_relaxed );
+}
+
+
+//======================================================================================================================
+//  export
+
+static void appendJsonString( QByteArray & json, const char * str )
+{
+	json += '"';
+	for (const char * c = str; *c != '\0'; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+			json += '\\';
+		if (uchar( *c ) >= 0x20)
+			json += *c;
+	}
+	json += '"';
+}
+
+static void appendTime_us( QByteArray & json, qint64 time_ns )
+{
+	json += QByteArray::number( double( time_ns ) / 1000.0, 'f', 3 );
+}
+
+static void appendEvent( QByteArray & json, int threadID, const Event & event )
+{
+	json += "{\"name\":";
+	appendJsonString( json, event.name );
+	switch (event.type)
+	{
+	 case EventType::Zone:
+		json += ",\"ph\":\"X\",\"dur\":";
+		appendTime_us( json, event.value - event.time_ns );
+		break;
+	 case EventType::Counter:
+		json += ",\"ph\":\"C\",\"args\":{\"value\":" + QByteArray::number( event.value ) + '}';
+		break;
+	 case EventType::Instant:
+		json += ",\"ph\":\"i\",\"s\":\"t\"";
+		break;
+	}
+	json += ",\"ts\":";
+	appendTime_us( json, event.time_ns );
+	json += ",\"pid\":1,\"tid\":" + QByteArray::number( threadID ) + "},\n";
+}
+
+static void appendThreadInfo( QByteArray & json, const ThreadBuffer & buffer )
+{
+	json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + QByteArray::number( buffer.threadID );
+	json += ",\"args\":{\"name\":";
+	appendJsonString( json, buffer.threadName.toUtf8().constData() );
+	json += "}},\n";
+
+	qint64 droppedCount = buffer.droppedCount.load( std::memory_order_relaxed );
+	if (droppedCount > 0)
+	{
+		json += "{\"name\":\"dropped events\",\"ph\":\"C\",\"ts\":0,\"pid\":1,\"tid\":" + QByteArray::number( buffer.threadID );
+		json += ",\"args\":{\"value\":" + QByteArray::number( droppedCount ) + "}},\n";
+	}
+}
+
+QString exportChromeTrace( const QString & filePath )
+{
+	QVector< ThreadBuffer * > buffers;
+	{
+		QMutexLocker locker( &registryMutex() );
+		buffers = threadBuffers();
+	}
+
+	int session = g_session.load( std::memory_order_relaxed );
+
+	QByteArray json;
+	json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (const ThreadBuffer * buffer : buffers)
+	{
+		if (buffer->session.load( std::memory_order_acquire ) != session)
+			continue;  // nothing recorded in this session yet
+
+		appendThreadInfo( json, *buffer );
+
+		for (EventChunk * chunk = buffer->firstChunk.load( std::memory_order_acquire ); chunk; chunk = chunk->next.load( std::memory_order_acquire ))
+		{
+			int count = chunk->count.load( std::memory_order_acquire );
+			for (int i = 0; i < count; ++i)
+				appendEvent( json, buffer->threadID, chunk->events[i] );
+		}
+	}
+	if (json.endsWith( ",\n" ))
+		json.chop( 2 );  // JSON doesn't allow a trailing comma
+	json += "\n]}\n";
+
+	return fs::updateFileSafely( filePath, json );
+}
+
+
+} // namespace tracing
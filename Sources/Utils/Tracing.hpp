@@ -0,0 +1,186 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: recording of performance traces that can be viewed in chrome://tracing or Perfetto
+//======================================================================================================================
+
+#ifndef TRACING_INCLUDED
+#define TRACING_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <QString>
+#include <QMutex>
+
+#include <atomic>
+
+
+//======================================================================================================================
+// Usage:
+//
+//   void readSomething()
+//   {
+//       TRACE_ZONE("readSomething");   // measures the duration of the enclosing scope
+//       ...
+//       tracing::counter( "items read", itemCount );
+//   }
+//
+// The events are recorded into a buffer of the thread that produced them, so the threads never wait for each other.
+// When the tracing is disabled, which is the default, every trace point costs only a single relaxed atomic load.
+// The names must be string literals (or other strings that live until the end of the program),
+// only their pointers are stored.
+//
+// Independently of the recording, every thread remembers the innermost zone it is in, so that a watchdog
+// can tell what a blocked thread is doing. That costs two pointer stores per zone.
+
+namespace tracing {
+
+
+/// What a thread is currently doing, readable from other threads.
+class ThreadActivity {
+
+	friend class Zone;
+
+	std::atomic< const char * > _zoneName { nullptr };
+	std::atomic< const QString * > _zoneDetail { nullptr };  ///< owned by the Zone that set it
+	mutable QMutex _detailMutex;  ///< keeps the detail alive while another thread is copying it
+
+ public:
+
+	/// Name of the innermost zone with its detail in parentheses, or empty string when the thread isn't in any zone.
+	/** Can be called from any thread. */
+	QString describe() const;
+
+};
+
+/// Activity of the calling thread, the reference is valid until the thread ends.
+ThreadActivity & currentThreadActivity();
+
+
+namespace impl {
+
+extern std::atomic< bool > g_enabled;
+extern thread_local ThreadActivity t_activity;
+
+qint64 now_ns();
+
+void recordZone( const char * name, qint64 start_ns, qint64 end_ns );
+void recordCounter( const char * name, qint64 value );
+void recordInstant( const char * name );
+
+} // namespace impl
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  control
+
+inline bool isEnabled()
+{
+	return impl::g_enabled.load( std::memory_order_relaxed );
+}
+
+/// Starts or stops recording. Starting it again discards the events recorded before.
+void setEnabled( bool enabled );
+
+/// Writes all the recorded events into a file in the Chrome trace event format.
+/** The file can be opened in chrome://tracing or https://ui.perfetto.dev. Returns an error message or empty string.
+  * The events are not removed, so it can be exported again later, even while the tracing is still running. */
+QString exportChromeTrace( const QString & filePath );
+
+
+//----------------------------------------------------------------------------------------------------------------------
+//  trace points
+
+/// Measures the duration of the enclosing scope, use the TRACE_ZONE macro.
+class Zone {
+
+	const char * _name;
+	const QString * _detail;
+	const char * _outerName;
+	const QString * _outerDetail;
+	qint64 _start_ns;
+
+ public:
+
+	/// The detail, for example a file path, must live until the end of the zone.
+	Zone( const char * name, const QString * detail = nullptr )
+	:
+		_name( name ), _detail( detail ),
+		_outerName( impl::t_activity._zoneName.load( std::memory_order_relaxed ) ),
+		_outerDetail( impl::t_activity._zoneDetail.load( std::memory_order_relaxed ) ),
+		_start_ns( isEnabled() ? impl::now_ns() : -1 )
+	{
+		if (_detail)
+		{
+			QMutexLocker locker( &impl::t_activity._detailMutex );
+			setActivity( _name, _detail );
+		}
+		else
+		{
+			// the outer detail, if any, lives longer than this zone, so it doesn't need to be locked
+			setActivity( _name, nullptr );
+		}
+	}
+
+	~Zone()
+	{
+		if (_start_ns >= 0 && isEnabled())
+			impl::recordZone( _name, _start_ns, impl::now_ns() );
+
+		if (_detail)
+		{
+			// another thread might be copying our detail right now
+			QMutexLocker locker( &impl::t_activity._detailMutex );
+			setActivity( _outerName, _outerDetail );
+		}
+		else
+		{
+			setActivity( _outerName, _outerDetail );
+		}
+	}
+
+	Zone( const Zone & ) = delete;
+	Zone & operator=( const Zone & ) = delete;
+
+ private:
+
+	static void setActivity( const char * name, const QString * detail )
+	{
+		impl::t_activity._zoneName.store( name, std::memory_order_relaxed );
+		impl::t_activity._zoneDetail.store( detail, std::memory_order_relaxed );
+	}
+
+};
+
+/// Records a new value of a named quantity, the viewer displays it as a graph.
+inline void counter( const char * name, qint64 value )
+{
+	if (isEnabled())
+		impl::recordCounter( name, value );
+}
+
+/// Records a moment when something happened.
+inline void instant( const char * name )
+{
+	if (isEnabled())
+		impl::recordInstant( name );
+}
+
+
+} // namespace tracing
+
+
+#define TRACE_CONCAT_IMPL( a, b ) a##b
+#define TRACE_CONCAT( a, b ) TRACE_CONCAT_IMPL( a, b )
+
+/// Measures the duration of the enclosing scope.
+#define TRACE_ZONE( name ) tracing::Zone TRACE_CONCAT( traceZone_, __LINE__ )( name )
+
+/// Measures the duration of the enclosing scope and lets a watchdog see what the zone is working on.
+/** The detail is not part of the recorded trace, it only appears in reports of a blocked thread. */
+#define TRACE_ZONE_DETAIL( name, detail ) tracing::Zone TRACE_CONCAT( traceZone_, __LINE__ )( name, &(detail) )
+
+
+#endif // TRACING_INCLUDED
@@ -9,6 +9,7 @@
 
 #include "JsonUtils.hpp"
 #include "ErrorHandling.hpp"
+#include "Tracing.hpp"
 
 #include <QHash>
 #include <QFile>
@@ -145,7 +146,7 @@ UncertainWadInfo LoggingWadReader::readWadInfo()
 	WadHeader header;
 	if (qint64( sizeof(header) ) > fileSize)
 	{
-		logDebug() << _filePath << " is smaller than WAD header";
+		LOG_DEBUG() << _filePath << " is smaller than WAD header";
 		wadInfo.status = ReadStatus::InvalidFormat;
 		return wadInfo;
 	}
@@ -165,7 +166,7 @@ UncertainWadInfo LoggingWadReader::readWadInfo()
 
 	if (wadInfo.type == WadType::Neither)  // not a WAD format
 	{
-		logDebug() << _filePath << ": invalid WAD signature";
+		LOG_DEBUG() << _filePath << ": invalid WAD signature";
 		wadInfo.status = ReadStatus::InvalidFormat;
 		return wadInfo;
 	}
@@ -174,14 +175,14 @@ UncertainWadInfo LoggingWadReader::readWadInfo()
 
 	if (header.numLumps < 1 || header.numLumps > 65536)  // some garbage -> not a WAD
 	{
-		logDebug() << _filePath << ": invalid number of lumps";
+		LOG_DEBUG() << _filePath << ": invalid number of lumps";
 		wadInfo.status = ReadStatus::InvalidFormat;
 		return wadInfo;
 	}
 	qint64 lumpDirSize = header.numLumps * sizeof(LumpEntry);
 	if (header.lumpDirOffset + lumpDirSize > fileSize)
 	{
-		logDebug() << _filePath << ": lump header points beyond the end of file";
+		LOG_DEBUG() << _filePath << ": lump header points beyond the end of file";
 		wadInfo.status = ReadStatus::InvalidFormat;
 		return wadInfo;
 	}
@@ -201,13 +202,13 @@ UncertainWadInfo LoggingWadReader::readWadInfo()
 
 		if (lump.dataOffset + lump.size > fileSize)  // some garbage -> not a WAD
 		{
-			logDebug() << _filePath << ": lump points beyond the end of file";
+			LOG_DEBUG() << _filePath << ": lump points beyond the end of file";
 			wadInfo.status = ReadStatus::InvalidFormat;
 			return wadInfo;
 		}
 		else if (!isPrintableAsciiString( lumpName ))  // some garbage -> not a WAD
 		{
-			logDebug() << _filePath << ": lump name is not a printable text";
+			LOG_DEBUG() << _filePath << ": lump name is not a printable text";
 			wadInfo.status = ReadStatus::InvalidFormat;
 			return wadInfo;
 		}
@@ -255,11 +256,13 @@ UncertainWadInfo LoggingWadReader::readWadInfo()
 
 UncertainWadInfo readWadInfo( const QString & filePath )
 {
+	TRACE_ZONE_DETAIL( "readWadInfo", filePath );
+
 	LoggingWadReader wadReader( filePath );
 	return wadReader.readWadInfo();
 }
 
-FileInfoCache< WadInfo > g_cachedWadInfo( readWadInfo );
+FileInfoCache< WadInfo > g_cachedWadInfo( "WAD info cache", readWadInfo );
 
 
 //----------------------------------------------------------------------------------------------------------------------
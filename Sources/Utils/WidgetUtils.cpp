@@ -10,6 +10,7 @@
 #include <QPalette>
 #include <QApplication>
 #include <QTableWidget>
+#include <QItemSelectionModel>
 
 
 namespace wdg {
@@ -86,6 +87,15 @@ void selectItemByIndex( QListView * view, int index )
 	view->selectionModel()->select( modelIndex, QItemSelectionModel::Select );
 }
 
+void selectItemRange( QListView * view, int firstIndex, int count )
+{
+	if (count <= 0)
+		return;
+
+	QItemSelection selection( view->model()->index( firstIndex, 0 ), view->model()->index( firstIndex + count - 1, 0 ) );
+	view->selectionModel()->select( selection, QItemSelectionModel::Select );
+}
+
 void deselectItemByIndex( QListView * view, int index )
 {
 	QModelIndex modelIndex = view->model()->index( index, 0 );
@@ -65,6 +65,7 @@ bool isSomethingSelected( QListView * view );
 int getSelectedItemIndex( QListView * view );  // assumes a single-selection mode, will throw a message box error otherwise
 QVector<int> getSelectedItemIndexes( QListView * view );
 void selectItemByIndex( QListView * view, int index );
+void selectItemRange( QListView * view, int firstIndex, int count );  // in a single selection change
 void deselectItemByIndex( QListView * view, int index );
 void deselectSelectedItems( QListView * view );
 
@@ -158,6 +159,42 @@ int appendItem( QListView * view, ListModel & model, const typename ListModel::I
 	return model.size() - 1;
 }
 
+/// Adds multiple items to the end of the list at once and selects them.
+/** Unlike calling appendItem() repeatedly, the view is notified and the selection is changed only once.
+  * Returns the index of the first appended item. */
+template< typename ListModel >
+int appendItems( QListView * view, ListModel & model, QList< typename ListModel::Item > && items )
+{
+	if (!model.canBeModified())
+	{
+		reportLogicError( view->parentWidget(), "Model cannot be modified",
+			"Cannot append items because the model is locked for changes."
+		);
+		return -1;
+	}
+
+	if (items.isEmpty())
+	{
+		return -1;
+	}
+
+	deselectAllAndUnsetCurrent( view );
+
+	int firstIdx = model.size();
+	int count = items.size();
+
+	model.startAppending( count );
+
+	model.insertMultiple( firstIdx, std::move( items ) );
+
+	model.finishAppending();
+
+	selectItemRange( view, firstIdx, count );  // select the appended items
+	setCurrentItemByIndex( view, model.size() - 1 );
+
+	return firstIdx;
+}
+
 /// Adds an item to the begining of the list and selects it.
 template< typename ListModel >
 void prependItem( QListView * view, ListModel & model, const typename ListModel::Item & item )
@@ -0,0 +1,335 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: terminal-like view of a process output that keeps only a limited number of last lines
+//======================================================================================================================
+
+#include "ConsoleView.hpp"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QContextMenuEvent>
+#include <QScrollBar>
+#include <QMenu>
+#include <QApplication>
+#include <QClipboard>
+
+#include <algorithm>
+
+
+//======================================================================================================================
+//  ConsoleBuffer
+
+ConsoleBuffer::ConsoleBuffer( int lineCapacity )
+{
+	_lines.resize( std::max( lineCapacity, 1 ) );
+}
+
+void ConsoleBuffer::clear()
+{
+	for (ConsoleLine & line : _lines)
+		line = ConsoleLine();  // release the memory
+
+	_firstLineIdx = 0;
+	_lineCount = 1;
+	_droppedLineCount = 0;
+	_maxLineLengthSeen = 0;
+	_pendingCR = false;
+}
+
+void ConsoleBuffer::append( const QString & text )
+{
+	append( text.constData(), int( text.size() ) );
+}
+
+void ConsoleBuffer::append( const QChar * text, int length, const ConsoleTextFormat & format )
+{
+	const QChar * pos = text;
+	const QChar * const end = pos + length;
+
+	while (pos < end)
+	{
+		const QChar * segmentEnd = pos;
+		while (segmentEnd < end && *segmentEnd != '\n' && *segmentEnd != '\r')
+			++segmentEnd;
+
+		if (segmentEnd > pos)
+			writeToLastLine( pos, int( segmentEnd - pos ), format );
+
+		if (segmentEnd == end)
+			break;
+
+		if (*segmentEnd == '\n')
+		{
+			// This also covers the Windows line endings, CR followed by LF just finishes the line.
+			_pendingCR = false;
+			startNewLine();
+		}
+		else
+		{
+			// The process wants to return the cursor to the start of the line to overwrite it.
+			// Don't clear the line yet, it might be just a CR of a CRLF.
+			_pendingCR = true;
+		}
+
+		pos = segmentEnd + 1;
+	}
+}
+
+void ConsoleBuffer::writeToLastLine( const QChar * chars, int length, const ConsoleTextFormat & format )
+{
+	if (_pendingCR)
+	{
+		lastLine().clear();  // the new text will most likely have similar length, so the capacity will be reused
+		_pendingCR = false;
+	}
+
+	while (length > 0)
+	{
+		ConsoleLine & line = lastLine();
+
+		int remainingSpace = maxLineLength - int( line.text.size() );
+		if (remainingSpace <= 0)
+		{
+			startNewLine();
+			continue;
+		}
+
+		int toWrite = std::min( length, remainingSpace );
+
+		if (!format.isDefault())
+		{
+			// merge with the previous range if it continues with the same format
+			if (!line.formats.isEmpty() && line.formats.last().start + line.formats.last().length == line.text.size()
+			 && line.formats.last().format == format)
+				line.formats.last().length += toWrite;
+			else
+				line.formats.append({ int( line.text.size() ), toWrite, format });
+		}
+
+		line.text.append( chars, toWrite );
+		chars += toWrite;
+		length -= toWrite;
+
+		_maxLineLengthSeen = std::max( _maxLineLengthSeen, int( line.text.size() ) );
+	}
+}
+
+void ConsoleBuffer::startNewLine()
+{
+	if (_lineCount < _lines.size())
+	{
+		_lineCount++;
+	}
+	else
+	{
+		// the buffer is full, the oldest line becomes the new last one
+		_firstLineIdx = (_firstLineIdx + 1) % _lines.size();
+		_droppedLineCount++;
+	}
+
+	lastLine().clear();
+}
+
+QString ConsoleBuffer::toPlainText() const
+{
+	int totalLength = 0;
+	for (int lineIdx = 0; lineIdx < _lineCount; ++lineIdx)
+		totalLength += int( line( lineIdx ).text.size() ) + 1;
+
+	QString text;
+	text.reserve( totalLength );
+	for (int lineIdx = 0; lineIdx < _lineCount; ++lineIdx)
+	{
+		if (lineIdx > 0)
+			text += '\n';
+		text += line( lineIdx ).text;
+	}
+	return text;
+}
+
+
+//======================================================================================================================
+//  ConsoleView
+
+static constexpr int textMargin = 4;  // pixels
+
+ConsoleView::ConsoleView( QWidget * parent ) : QAbstractScrollArea( parent )
+{
+	// we need to receive key presses, so that they can be forwarded to the process
+	setFocusPolicy( Qt::StrongFocus );
+
+	verticalScrollBar()->setSingleStep( 1 );  // the vertical scrollbar operates in lines, not pixels
+
+	_refreshTimer.setSingleShot( true );
+	_refreshTimer.setInterval( refreshPeriod_ms );
+	connect( &_refreshTimer, &QTimer::timeout, this, &thisClass::refresh );
+}
+
+ConsoleView::~ConsoleView() {}
+
+void ConsoleView::appendText( const QString & text )
+{
+	appendText( text.constData(), int( text.size() ), {} );
+}
+
+void ConsoleView::appendText( const QChar * text, int length, const ConsoleTextFormat & format )
+{
+	_buffer.append( text, length, format );
+
+	// collect all the output that arrives until the timer fires and then render it at once
+	if (!_refreshTimer.isActive())
+		_refreshTimer.start();
+}
+
+void ConsoleView::clear()
+{
+	_buffer.clear();
+	_droppedLinesAtLastRefresh = 0;
+	refresh();
+}
+
+void ConsoleView::refresh()
+{
+	QScrollBar * vScrollBar = verticalScrollBar();
+
+	// if the user is watching the newest output, keep following it, otherwise don't move the content under their hands
+	const bool followingTail = vScrollBar->value() >= vScrollBar->maximum();
+	const int oldFirstVisibleLine = vScrollBar->value();
+
+	const qint64 newlyDroppedLines = _buffer.droppedLineCount() - _droppedLinesAtLastRefresh;
+	_droppedLinesAtLastRefresh = _buffer.droppedLineCount();
+
+	updateScrollBars();
+
+	if (followingTail)
+		vScrollBar->setValue( vScrollBar->maximum() );
+	else
+		vScrollBar->setValue( int( std::max( oldFirstVisibleLine - newlyDroppedLines, qint64(0) ) ) );
+
+	viewport()->update();
+}
+
+void ConsoleView::updateScrollBars()
+{
+	const QFontMetrics metrics = fontMetrics();
+	const int lineHeight = std::max( metrics.lineSpacing(), 1 );
+	const int visibleLineCount = std::max( (viewport()->height() - 2 * textMargin) / lineHeight, 1 );
+
+	QScrollBar * vScrollBar = verticalScrollBar();
+	vScrollBar->setRange( 0, std::max( _buffer.lineCount() - visibleLineCount, 0 ) );
+	vScrollBar->setPageStep( visibleLineCount );
+
+	// Measuring every line would defeat the purpose of rendering only the visible ones,
+	// the console uses fixed-width font anyway.
+	const int charWidth = std::max( metrics.averageCharWidth(), 1 );
+	const int contentWidth = _buffer.maxLineLengthSeen() * charWidth + 2 * textMargin;
+
+	QScrollBar * hScrollBar = horizontalScrollBar();
+	hScrollBar->setRange( 0, std::max( contentWidth - viewport()->width(), 0 ) );
+	hScrollBar->setPageStep( viewport()->width() );
+	hScrollBar->setSingleStep( charWidth );
+}
+
+void ConsoleView::paintEvent( QPaintEvent * event )
+{
+	QPainter painter( viewport() );
+	painter.setPen( palette().color( QPalette::Text ) );
+
+	const QFontMetrics metrics = fontMetrics();
+	const int lineHeight = std::max( metrics.lineSpacing(), 1 );
+	const int x = textMargin - horizontalScrollBar()->value();
+
+	// paint only the lines intersecting the area to be re-drawn
+	const QRect & dirtyRect = event->rect();
+	const int firstDirtyRow = std::max( (dirtyRect.top() - textMargin) / lineHeight, 0 );
+	const int lastDirtyRow = std::max( (dirtyRect.bottom() - textMargin) / lineHeight, 0 );
+
+	const int firstVisibleLine = verticalScrollBar()->value();
+	for (int row = firstDirtyRow; row <= lastDirtyRow; ++row)
+	{
+		int lineIdx = firstVisibleLine + row;
+		if (lineIdx >= _buffer.lineCount())
+			break;
+
+		const ConsoleLine & line = _buffer.line( lineIdx );
+		const int top = textMargin + row * lineHeight;
+
+		if (line.formats.isEmpty())  // fast path for the most common case
+		{
+			painter.drawText( x, top + metrics.ascent(), line.text );
+		}
+		else
+		{
+			drawFormattedLine( painter, line, x, top );
+		}
+	}
+}
+
+void ConsoleView::drawFormattedLine( QPainter & painter, const ConsoleLine & line, int x, int top )
+{
+	const QFontMetrics metrics = fontMetrics();
+	const int lineHeight = std::max( metrics.lineSpacing(), 1 );
+	const int charWidth = std::max( metrics.averageCharWidth(), 1 );  // the console uses fixed-width font
+	const QColor defaultTextColor = palette().color( QPalette::Text );
+
+	auto drawPart = [&]( int start, int length, const ConsoleTextFormat * format )
+	{
+		if (length <= 0)
+			return;
+
+		const int partX = x + start * charWidth;
+		if (format)
+		{
+			if (format->background.isValid())
+				painter.fillRect( partX, top, length * charWidth, lineHeight, format->background );
+
+			QFont partFont = font();
+			partFont.setBold( format->bold );
+			partFont.setItalic( format->italic );
+			partFont.setUnderline( format->underline );
+			painter.setFont( partFont );
+			painter.setPen( format->foreground.isValid() ? format->foreground : defaultTextColor );
+		}
+		else
+		{
+			painter.setFont( font() );
+			painter.setPen( defaultTextColor );
+		}
+
+		painter.drawText( partX, top + metrics.ascent(), line.text.mid( start, length ) );
+	};
+
+	int pos = 0;
+	for (const ConsoleFormatRange & range : line.formats)
+	{
+		drawPart( pos, range.start - pos, nullptr );
+		drawPart( range.start, range.length, &range.format );
+		pos = range.start + range.length;
+	}
+	drawPart( pos, int( line.text.size() ) - pos, nullptr );
+
+	painter.setFont( font() );
+	painter.setPen( defaultTextColor );
+}
+
+void ConsoleView::resizeEvent( QResizeEvent * event )
+{
+	superClass::resizeEvent( event );
+
+	updateScrollBars();
+}
+
+void ConsoleView::contextMenuEvent( QContextMenuEvent * event )
+{
+	QMenu contextMenu( this );
+	contextMenu.addAction( "Copy all", this, &thisClass::copyAllToClipboard );
+	contextMenu.exec( event->globalPos() );
+}
+
+void ConsoleView::copyAllToClipboard()
+{
+	QApplication::clipboard()->setText( _buffer.toPlainText() );
+}
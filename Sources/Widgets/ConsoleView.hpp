@@ -0,0 +1,161 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: terminal-like view of a process output that keeps only a limited number of last lines
+//======================================================================================================================
+
+#ifndef CONSOLE_VIEW_INCLUDED
+#define CONSOLE_VIEW_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "Utils/ConsoleOutputDecoder.hpp"  // ConsoleTextFormat
+
+#include <QAbstractScrollArea>
+#include <QVector>
+#include <QString>
+#include <QTimer>
+
+class QPainter;
+class QPaintEvent;
+class QResizeEvent;
+class QContextMenuEvent;
+
+
+//======================================================================================================================
+
+/// Part of a console line that has a non-default format.
+struct ConsoleFormatRange
+{
+	int start;
+	int length;
+	ConsoleTextFormat format;
+};
+
+/// Single line of a console output.
+struct ConsoleLine
+{
+	QString text;
+	QVector< ConsoleFormatRange > formats;  ///< sorted and non-overlapping, parts not covered have the default format
+
+	void clear()
+	{
+		text.resize( 0 );  // keep the allocated capacity, this object will be reused for a new line
+		formats.resize( 0 );
+	}
+};
+
+
+//======================================================================================================================
+/// Fixed-capacity buffer of text lines, the oldest lines are dropped when the capacity is exceeded.
+/** Interprets line feeds and carriage returns the way a terminal does, so that a process can overwrite
+  * its last line (progress indicators) without the overwritten text ever being stored. */
+
+class ConsoleBuffer {
+
+ public:
+
+	static constexpr int defaultLineCapacity = 20000;
+	static constexpr int maxLineLength = 4096;  ///< longer lines are wrapped, so that a single line cannot eat all memory
+
+	ConsoleBuffer( int lineCapacity = defaultLineCapacity );
+
+	/// Appends a piece of output, which can contain any number of (even incomplete) lines.
+	void append( const QString & text );
+	void append( const QChar * text, int length, const ConsoleTextFormat & format = {} );
+
+	void clear();
+
+	/// Number of lines currently stored, including the last unfinished one.
+	int lineCount() const  { return _lineCount; }
+
+	/// Returns a line by index, where 0 is the oldest line still stored.
+	const ConsoleLine & line( int lineIdx ) const  { return _lines[ (_firstLineIdx + lineIdx) % _lines.size() ]; }
+
+	/// How many lines have been dropped from the beginning since the last clear().
+	/** Views can use it to keep showing the same content while the lines move towards the beginning. */
+	qint64 droppedLineCount() const  { return _droppedLineCount; }
+
+	/// Length of the longest line that was ever stored, used to estimate the horizontal scrolling range.
+	int maxLineLengthSeen() const  { return _maxLineLengthSeen; }
+
+	/// Concatenates all the stored lines into a single text.
+	QString toPlainText() const;
+
+ private:
+
+	ConsoleLine & lastLine()  { return _lines[ (_firstLineIdx + _lineCount - 1) % _lines.size() ]; }
+
+	void startNewLine();
+	void writeToLastLine( const QChar * chars, int length, const ConsoleTextFormat & format );
+
+ private:
+
+	QVector< ConsoleLine > _lines;  ///< ring buffer, allocated to full capacity at the beginning
+	int _firstLineIdx = 0;
+	int _lineCount = 1;  ///< there is always at least one (possibly empty) line being written to
+	qint64 _droppedLineCount = 0;
+	int _maxLineLengthSeen = 0;
+
+	bool _pendingCR = false;  ///< carriage return was received, the next text will overwrite the last line
+
+};
+
+
+//======================================================================================================================
+/// Read-only terminal-like view that renders only the lines currently visible.
+/** Appended text is stored into the buffer immediately, but the view is refreshed at most once per refresh period,
+  * so that a process spamming its output cannot block the GUI. */
+
+class ConsoleView : public QAbstractScrollArea {
+
+	Q_OBJECT
+
+	using thisClass = ConsoleView;
+	using superClass = QAbstractScrollArea;
+
+ public:
+
+	static constexpr int refreshPeriod_ms = 33;  ///< ~30 FPS is enough for a text output
+
+	ConsoleView( QWidget * parent );
+	virtual ~ConsoleView() override;
+
+	/// Appends a piece of process output and schedules a refresh of the view.
+	void appendText( const QString & text );
+	void appendText( const QChar * text, int length, const ConsoleTextFormat & format );
+
+	void clear();
+
+	const ConsoleBuffer & buffer() const  { return _buffer; }
+
+ protected: // overridden event callbacks
+
+	virtual void paintEvent( QPaintEvent * event ) override;
+	virtual void resizeEvent( QResizeEvent * event ) override;
+	virtual void contextMenuEvent( QContextMenuEvent * event ) override;
+
+ private slots:
+
+	void refresh();
+	void copyAllToClipboard();
+
+ private: // methods
+
+	void updateScrollBars();
+	void drawFormattedLine( QPainter & painter, const ConsoleLine & line, int x, int top );
+
+ private: // members
+
+	ConsoleBuffer _buffer;
+
+	QTimer _refreshTimer;
+
+	qint64 _droppedLinesAtLastRefresh = 0;
+
+};
+
+
+#endif // CONSOLE_VIEW_INCLUDED
@@ -247,6 +247,9 @@ void EditableListView::toggleIcons()
 	bool newIconState = !model->areIconsEnabled();
 	model->toggleIcons( newIconState );
 	toggleIconsAction->setText( newIconState ? "Hide icons" : "Show icons" );
+
+	if (this->uniformItemSizes())
+		this->scheduleDelayedItemsLayout();  // the common row height needs to be measured again with/without the icon
 }
 
 void EditableListView::toggleIcons( bool enabled )
@@ -402,8 +405,7 @@ void EditableListView::itemsDropped()
 		// otherwise the edit content gets saved into a wrong item.
 		wdg::unsetCurrentItem( this );
 		wdg::deselectSelectedItems( this );
-		for (int i = 0; i < count; i++)
-			wdg::selectItemByIndex( this, row + i );
+		wdg::selectItemRange( this, row, count );
 		wdg::setCurrentItemByIndex( this, row + count - 1 );
 
 		emit itemsDropped( row, count );
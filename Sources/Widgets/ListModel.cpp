@@ -21,3 +21,71 @@ void ListModelCommon::contentChanged( int changedRowsBegin, int changedRowsEnd )
 		Qt::ForegroundRole, Qt::BackgroundRole, Qt::TextAlignmentRole
 	});
 }
+
+void ListModelCommon::iconsChanged()
+{
+	if (this->rowCount() == 0)
+		return;
+
+	emit dataChanged( createIndex( 0, /*column*/0 ), createIndex( this->rowCount() - 1, /*column*/0 ), { Qt::DecorationRole } );
+}
+
+void ListModelCommon::appearanceChanged( int changedRowsBegin, int changedRowsEnd )
+{
+	if (changedRowsBegin >= changedRowsEnd)
+		return;
+
+	emit dataChanged( createIndex( changedRowsBegin, /*column*/0 ), createIndex( changedRowsEnd - 1, /*column*/0 ), {
+		Qt::ForegroundRole, Qt::DecorationRole
+	});
+}
+
+void ListModelCommon::toggleDisplayStringCache( bool enabled )
+{
+	if (enabled == displayStringCacheEnabled)
+		return;
+
+	displayStringCacheEnabled = enabled;
+	invalidateAllDisplayStrings();
+
+	if (!enabled)
+	{
+		for (const QMetaObject::Connection & connection : displayStringCacheConnections)
+			disconnect( connection );
+		displayStringCacheConnections.clear();
+		return;
+	}
+
+	// keep the cache aligned with the rows, so that the strings of the rows that didn't change can stay valid
+	displayStringCacheConnections = {
+		connect( this, &QAbstractItemModel::dataChanged, [ this ]( const QModelIndex & topLeft, const QModelIndex & bottomRight, const QVector<int> & roles )
+		{
+			if (roles.isEmpty() || roles.contains( Qt::DisplayRole ) || roles.contains( Qt::EditRole ))
+				invalidateDisplayStrings( topLeft.row(), bottomRight.row() );
+		}),
+		connect( this, &QAbstractItemModel::rowsInserted, [ this ]( const QModelIndex &, int first, int last )
+		{
+			if (first <= displayStringCache.size())
+				displayStringCache.insert( first, last - first + 1, std::nullopt );
+		}),
+		connect( this, &QAbstractItemModel::rowsRemoved, [ this ]( const QModelIndex &, int first, int last )
+		{
+			if (last < displayStringCache.size())
+				displayStringCache.remove( first, last - first + 1 );
+		}),
+		connect( this, &QAbstractItemModel::rowsMoved, [ this ]() { invalidateAllDisplayStrings(); } ),
+		connect( this, &QAbstractItemModel::layoutChanged, [ this ]() { invalidateAllDisplayStrings(); } ),
+		connect( this, &QAbstractItemModel::modelReset, [ this ]() { invalidateAllDisplayStrings(); } ),
+	};
+}
+
+void ListModelCommon::invalidateDisplayStrings( int firstRow, int lastRow )
+{
+	for (int row = firstRow; row <= lastRow && row < displayStringCache.size(); ++row)
+		displayStringCache[ row ].reset();
+}
+
+void ListModelCommon::invalidateAllDisplayStrings()
+{
+	displayStringCache.clear();
+}
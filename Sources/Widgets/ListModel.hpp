@@ -14,6 +14,7 @@
 #include "Utils/ContainerUtils.hpp"  // PointerIterator
 #include "Utils/FileSystemUtils.hpp"  // PathConvertor
 #include "Utils/ErrorHandling.hpp"
+#include "Utils/SearchIndex.hpp"  // TrigramIndex
 #include "Themes.hpp"  // separator colors
 
 #include <QAbstractListModel>
@@ -30,6 +31,7 @@
 #include <optional>
 #include <functional>
 #include <stdexcept>
+#include <algorithm>  // copy, rotate
 
 
 //======================================================================================================================
@@ -166,6 +168,22 @@ struct EditableListModelItem : public ReadOnlyListModelItem
 };
 
 
+//======================================================================================================================
+//  helpers for the list implementations
+
+/// Inserts many items into a list in linear time, instead of shifting the following items for every one of them.
+template< typename Item >
+void insertIntoList( QList< Item > & list, int idx, QList< Item > && items )
+{
+	int origSize = list.size();
+	list.reserve( origSize + items.size() );
+	for (Item & item : items)
+		list.append( std::move(item) );
+	// move the new items from the end to the insert position
+	std::rotate( list.begin() + idx, list.begin() + origSize, list.end() );
+}
+
+
 //======================================================================================================================
 /// A trivial wrapper around QList.
 /** One of possible list implementations for ListModel variants. */
@@ -215,6 +233,7 @@ class DirectList {
 	void append( const Item & item )              { _list.append( item ); }
 	void prepend( const Item & item )             { _list.prepend( item ); }
 	void insert( int idx, const Item & item )     { _list.insert( idx, item ); }
+	void insertMultiple( int idx, QList< Item > && items )  { insertIntoList( _list, idx, std::move(items) ); }
 	void removeAt( int idx )                      { _list.removeAt( idx ); }
 	void move( int from, int to )                 { _list.move( from, to ); }
 
@@ -302,6 +321,13 @@ class FilteredList {
 		_filteredList.insert( idx, &_fullList[ idx ] );
 	}
 
+	void insertMultiple( int idx, QList< Item > && items )
+	{
+		ensureCanBeModified();
+		insertIntoList( _fullList, idx, std::move(items) );
+		restore();  // the items were moved around, the pointers no longer point to the right ones
+	}
+
 	void removeAt( int idx )
 	{
 		if (!isFiltered())
@@ -329,32 +355,33 @@ class FilteredList {
 	//-- searching/filtering -------------------------------------------------------------------------------------------
 
 	/// Filters the list model entries to display only those that match a given criteria.
+	/** The caller is responsible for notifying the view about the change. */
 	void search( const QString & phrase, bool caseSensitive, bool useRegex )
 	{
-		_filteredList.clear();
+		_filteredList = findMatches( phrase, caseSensitive, useRegex );
+	}
 
-		if (useRegex)
-		{
-			QRegularExpression regex( phrase );
-			for (auto & item : _fullList)
-				if (!item.isSeparator && regex.isValid() && regex.match( item.getEditString() ).hasMatch())
-					_filteredList.append( &item );
-		}
-		else
-		{
-			Qt::CaseSensitivity caseSensitivity = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
-			for (auto & item : _fullList)
-				if (!item.isSeparator && item.getEditString().contains( phrase, caseSensitivity ))
-					_filteredList.append( &item );
-		}
+	/// Filters the list model entries and notifies the \p listener only about the rows that disappeared or appeared.
+	/** Listener must provide the row notifications of ListModelCommon. */
+	template< typename Listener >
+	void search( const QString & phrase, bool caseSensitive, bool useRegex, Listener & listener )
+	{
+		applyFilterChanges( findMatches( phrase, caseSensitive, useRegex ), listener );
 	}
 
 	/// Restores the list model to display the full unfiltered content.
 	void restore()
 	{
-		_filteredList.clear();
-		for (auto & item : _fullList)
-			_filteredList.append( &item );
+		_filteredList = allItems();
+		_lastPhrase.clear();
+	}
+
+	/// Restores the full unfiltered content and notifies the \p listener only about the rows that appeared.
+	template< typename Listener >
+	void restore( Listener & listener )
+	{
+		applyFilterChanges( allItems(), listener );
+		_lastPhrase.clear();
 	}
 
 	/// Whether the list is currently filtered or showing the full content.
@@ -383,6 +410,143 @@ class FilteredList {
 		}
 	}
 
+ private:
+
+	QVector< Item * > allItems()
+	{
+		QVector< Item * > items;
+		items.reserve( _fullList.size() );
+		for (auto & item : _fullList)
+			items.append( &item );
+		return items;
+	}
+
+	QVector< Item * > findMatches( const QString & phrase, bool caseSensitive, bool useRegex )
+	{
+		QVector< Item * > matches;
+
+		if (useRegex)
+		{
+			// compile the regex only when the phrase changes, not on every toggle of the other options
+			if (_regex.pattern() != phrase)
+				_regex.setPattern( phrase );
+
+			if (_regex.isValid())
+				for (auto & item : _fullList)
+					if (!item.isSeparator && _regex.match( item.getEditString() ).hasMatch())
+						matches.append( &item );
+
+			_lastPhrase.clear();  // regex results can't be narrowed
+			return matches;
+		}
+
+		Qt::CaseSensitivity caseSensitivity = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+		// When the user types more characters, every item matching the new phrase also matched the previous one,
+		// so it's enough to check only the currently displayed items.
+		Qt::CaseSensitivity lastCaseSensitivity = _lastCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+		bool canNarrow = !_lastPhrase.isEmpty() && (caseSensitive || !_lastCaseSensitive)
+		                 && phrase.contains( _lastPhrase, lastCaseSensitivity );
+		if (canNarrow)
+		{
+			for (Item * item : _filteredList)
+				if (!item->isSeparator && item->getEditString().contains( phrase, caseSensitivity ))
+					matches.append( item );
+		}
+		else
+		{
+			updateSearchIndex();
+			for (int idx : _searchIndex.findCandidates( phrase ))
+			{
+				Item & item = _fullList[ idx ];
+				if (!item.isSeparator && item.getEditString().contains( phrase, caseSensitivity ))
+					matches.append( &item );
+			}
+		}
+
+		_lastPhrase = phrase;
+		_lastCaseSensitive = caseSensitive;
+		return matches;
+	}
+
+	/// Re-indexes the items that were added, moved or renamed since the last search.
+	void updateSearchIndex()
+	{
+		static const QString noString;
+
+		_searchIndex.resize( _fullList.size() );
+		for (int idx = 0; idx < _fullList.size(); ++idx)
+		{
+			const Item & item = _fullList[ idx ];
+			const QString & str = item.isSeparator ? noString : item.getEditString();
+			if (!_searchIndex.isIndexed( idx, str ))
+				_searchIndex.setString( idx, str );
+		}
+	}
+
+	/// Changes the filtered list to \p newList and notifies the listener about each continuous block of changed rows.
+	template< typename Listener >
+	void applyFilterChanges( const QVector< Item * > & newList, Listener & listener )
+	{
+		// Both lists are sub-sequences of the full list, so walking the full list while advancing a position in each of
+		// them tells which items are only in the old one (to be removed) and which only in the new one (to be inserted).
+		int row = 0;     // position in _filteredList, which is being transformed into newList
+		int newIdx = 0;  // position in newList
+		int fullIdx = 0;
+
+		auto isAtRow = [&]( int atRow, const Item * item ) { return atRow < _filteredList.size() && _filteredList[ atRow ] == item; };
+		auto isAtNewIdx = [&]( const Item * item ) { return newIdx < newList.size() && newList[ newIdx ] == item; };
+
+		while (fullIdx < _fullList.size())
+		{
+			const Item * item = &_fullList[ fullIdx ];
+			bool inOld = isAtRow( row, item );
+			bool inNew = isAtNewIdx( item );
+
+			if (inOld && !inNew)
+			{
+				int count = 0;
+				for (; fullIdx < _fullList.size() && !isAtNewIdx( &_fullList[ fullIdx ] ); ++fullIdx)
+					if (isAtRow( row + count, &_fullList[ fullIdx ] ))
+						++count;
+
+				listener.startDeleting( row, count );
+				_filteredList.remove( row, count );
+				listener.finishDeleting();
+			}
+			else if (inNew && !inOld)
+			{
+				int firstNewIdx = newIdx;
+				for (; fullIdx < _fullList.size() && !isAtRow( row, &_fullList[ fullIdx ] ); ++fullIdx)
+					if (isAtNewIdx( &_fullList[ fullIdx ] ))
+						++newIdx;
+
+				int count = newIdx - firstNewIdx;
+				listener.startInserting( row, count );
+				_filteredList.insert( row, count, nullptr );
+				std::copy( newList.begin() + firstNewIdx, newList.begin() + newIdx, _filteredList.begin() + row );
+				listener.finishInserting();
+				row += count;
+			}
+			else
+			{
+				if (inOld)  // and in new
+				{
+					++row;
+					++newIdx;
+				}
+				++fullIdx;
+			}
+		}
+	}
+
+ private:
+
+	TrigramIndex _searchIndex;  ///< built on the first search, then updated only for the items that changed
+	QRegularExpression _regex;  ///< the last used regex, compiling it is expensive
+	QString _lastPhrase;        ///< phrase of the last search that can be narrowed by a longer one, empty if there is none
+	bool _lastCaseSensitive = false;
+
 };
 
 
@@ -400,11 +564,23 @@ class ListModelCommon : public QAbstractListModel, protected LoggingComponent {
 	void toggleIcons( bool enabled )  { iconsEnabled = enabled; }
 	bool areIconsEnabled() const      { return iconsEnabled; }
 
+	/// Remembers the display strings of the items, so that painting and layouting doesn't call makeDisplayString
+	/// again for the rows that didn't change, default is disabled.
+	/** The cache is invalidated by the change notifications below, so it can only be enabled for models
+	  * where every modification of the items is followed by one of them. */
+	void toggleDisplayStringCache( bool enabled );
+
 	//-- data change notifications -------------------------------------------------------------------------------------
 
 	/// Notifies the view that the content of some items has been changed.
 	void contentChanged( int changedRowsBegin, int changedRowsEnd = -1 );
 
+	/// Notifies the view that the icons of all items need to be repainted.
+	void iconsChanged();
+
+	/// Notifies the view that only the colors and icons of some items have been changed, not their data.
+	void appearanceChanged( int changedRowsBegin, int changedRowsEnd );
+
 	// One of the following functions must always be called before and after doing any modifications to the list,
 	// otherwise the list might not update correctly or it might even crash trying to access items that no longer exist.
 
@@ -426,18 +602,18 @@ class ListModelCommon : public QAbstractListModel, protected LoggingComponent {
 		endInsertRows();
 	}
 
-	void startInserting( int row )
+	void startInserting( int row, int count = 1 )
 	{
-		beginInsertRows( QModelIndex(), row, row );
+		beginInsertRows( QModelIndex(), row, row + count - 1 );
 	}
 	void finishInserting()
 	{
 		endInsertRows();
 	}
 
-	void startDeleting( int row )
+	void startDeleting( int row, int count = 1 )
 	{
-		beginRemoveRows( QModelIndex(), row, row );
+		beginRemoveRows( QModelIndex(), row, row + count - 1 );
 	}
 	void finishDeleting()
 	{
@@ -460,10 +636,40 @@ class ListModelCommon : public QAbstractListModel, protected LoggingComponent {
 		return index( row, /*column*/0, /*parent*/QModelIndex() );
 	}
 
+ protected:
+
+	/// Returns the display string of a row from the cache, if it's not there, it calls \p makeDisplayString.
+	template< typename MakeDisplayString >
+	QString getDisplayString( int row, const MakeDisplayString & makeDisplayString ) const
+	{
+		if (!displayStringCacheEnabled)
+			return makeDisplayString();
+
+		if (displayStringCache.size() != this->rowCount())  // shouldn't happen, but better be safe than show wrong names
+		{
+			displayStringCache.clear();
+			displayStringCache.resize( this->rowCount() );
+		}
+
+		std::optional< QString > & cachedString = displayStringCache[ row ];
+		if (!cachedString)
+			cachedString = makeDisplayString();
+		return *cachedString;
+	}
+
  protected:
 
 	bool iconsEnabled = false;
 
+ private:
+
+	void invalidateDisplayStrings( int firstRow, int lastRow );
+	void invalidateAllDisplayStrings();
+
+	bool displayStringCacheEnabled = false;
+	mutable QVector< std::optional< QString > > displayStringCache;  ///< index is the row, empty means not known yet
+	QVector< QMetaObject::Connection > displayStringCacheConnections;
+
 };
 
 
@@ -508,7 +714,7 @@ class ReadOnlyListModel : public ListModelCommon, public ListImpl {
 			{
 				// Some UI elements may want to display only the Item name, some others a string constructed from multiple
 				// Item elements. This way we generalize from the way the display string is constructed from the Item.
-				return makeDisplayString( item );
+				return getDisplayString( index.row(), [&]() { return makeDisplayString( item ); } );
 			}
 			else if (role == Qt::ForegroundRole)
 			{
@@ -654,7 +860,7 @@ class EditableListModel : public ListModelCommon, public ListImpl, public DropTa
 			{
 				// Each list view might want to display the same data differently, so we allow the user of the list model
 				// to specify it by a function for each view separately.
-				return makeDisplayString( item );
+				return getDisplayString( index.row(), [&]() { return makeDisplayString( item ); } );
 			}
 			else if (role == Qt::EditRole && canBeEdited( item ))
 			{
@@ -753,12 +959,15 @@ class EditableListModel : public ListModelCommon, public ListImpl, public DropTa
 			return false;
 		}
 
+		QList< Item > newItems;
+		newItems.reserve( count );
+		for (int i = 0; i < count; i++)
+			newItems.append( Item() );
+
 		QAbstractListModel::beginInsertRows( parent, row, row + count - 1 );
 
-		// n times moving all the elements forward to insert one is not nice
-		// but it happens only once in awhile and the number of elements is almost always very low
-		for (int i = 0; i < count; i++)
-			this->insert( row + i, Item() );
+		// all at once, there can be thousands of files dropped
+		this->insertMultiple( row, std::move(newItems) );
 
 		QAbstractListModel::endInsertRows();
 
@@ -906,6 +1115,8 @@ class EditableListModel : public ListModelCommon, public ListImpl, public DropTa
 		{
 			(*this)[ row + i ] = std::move( *origItemRefs[i] );
 		}
+		// the view might have asked for the new empty rows in the meantime, it must not keep their display strings
+		this->contentChanged( row, row + count );
 
 		// idiotic workaround because Qt is fucking retarded   (read the comment at the top of EditableListView.cpp)
 		//
@@ -948,6 +1159,8 @@ class EditableListModel : public ListModelCommon, public ListImpl, public DropTa
 			// Therefore only author of Item knows how to assign a dropped file into it, so he must define it by a constructor.
 			(*this)[ row + i ] = Item( filesToBeInserted[ i ] );
 		}
+		// the view might have asked for the new empty rows in the meantime, it must not keep their display strings
+		this->contentChanged( row, row + int( filesToBeInserted.count() ) );
 
 		// idiotic workaround because Qt is fucking retarded   (read the comment at the top of EditableListView.cpp)
 		//
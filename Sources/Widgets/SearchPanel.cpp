@@ -15,6 +15,10 @@ SearchPanel::SearchPanel(
 	connect( searchLine, &QLineEdit::textChanged, this, &thisClass::changeSearchPhrase );
 	connect( caseChkBox, &QCheckBox::toggled, this, &thisClass::toggleCaseSensitive );
 	connect( regexChkBox, &QCheckBox::toggled, this, &thisClass::toggleUseRegex );
+
+	_searchTimer.setSingleShot( true );
+	_searchTimer.setInterval( searchDelay_ms );
+	connect( &_searchTimer, &QTimer::timeout, this, &thisClass::emitSearchParams );
 }
 
 void SearchPanel::setExpanded( bool expanded )
@@ -49,15 +53,29 @@ void SearchPanel::toggleExpanded()
 
 void SearchPanel::changeSearchPhrase( const QString & phrase )
 {
-	emit searchParamsChanged( phrase, caseChkBox->isChecked(), regexChkBox->isChecked() );
+	if (phrase.isEmpty())
+	{
+		// clearing the search must be immediate, the callers expect the full list right after collapse()
+		emitSearchParams();
+	}
+	else
+	{
+		_searchTimer.start();  // restarts the delay if it's already running
+	}
+}
+
+void SearchPanel::toggleCaseSensitive( bool /*enable*/ )
+{
+	emitSearchParams();
 }
 
-void SearchPanel::toggleCaseSensitive( bool enable )
+void SearchPanel::toggleUseRegex( bool /*enable*/ )
 {
-	emit searchParamsChanged( searchLine->text(), enable, regexChkBox->isChecked() );
+	emitSearchParams();
 }
 
-void SearchPanel::toggleUseRegex( bool enable )
+void SearchPanel::emitSearchParams()
 {
-	emit searchParamsChanged( searchLine->text(), caseChkBox->isChecked(), enable );
+	_searchTimer.stop();
+	emit searchParamsChanged( searchLine->text(), caseChkBox->isChecked(), regexChkBox->isChecked() );
 }
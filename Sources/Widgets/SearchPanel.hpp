@@ -1,4 +1,5 @@
 #include <QObject>
+#include <QTimer>
 
 class QString;
 class QToolButton;
@@ -27,6 +28,10 @@ class SearchPanel : public QObject {
 	void toggleCaseSensitive( bool enable );
 	void toggleUseRegex( bool enable );
 
+ private slots:
+
+	void emitSearchParams();
+
  signals:
 
 	void searchParamsChanged( const QString & phrase, bool caseSensitive, bool useRegex );
@@ -38,4 +43,10 @@ class SearchPanel : public QObject {
 	QCheckBox * caseChkBox;
 	QCheckBox * regexChkBox;
 
+ private:
+
+	/// The search is started only after the user stops typing for a moment, not after each character.
+	static constexpr int searchDelay_ms = 150;
+	QTimer _searchTimer;
+
 };
@@ -0,0 +1,287 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: waterfall chart of the engine start-up steps
+//======================================================================================================================
+
+#include "StartupWaterfallView.hpp"
+
+#include "Utils/FileSystemUtils.hpp"  // getFileNameFromPath
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <QHash>
+#include <QStringBuilder>
+
+#include <algorithm>
+#include <iterator>  // size
+
+
+//======================================================================================================================
+
+static constexpr int margin = 4;
+static constexpr int columnSpacing = 8;
+static constexpr int fileIndent = 16;  ///< files are indented under the phase they are loaded in
+static constexpr int minGridSpacing = 60;  ///< minimum distance between the vertical lines of the time axis in pixels
+
+static const QColor slowerColor = QColor::fromHsv( 4, 200, 220 );    // red
+static const QColor fasterColor = QColor::fromHsv( 120, 200, 170 );  // green
+
+static QString stepKey( const StartupStep & step )
+{
+	return step.phase % '\n' % step.file;
+}
+
+static QString formatTime( qint64 time_ms )
+{
+	return QString::number( time_ms ) % " ms";
+}
+
+
+//======================================================================================================================
+
+StartupWaterfallView::StartupWaterfallView( QWidget * parent )
+:
+	QWidget( parent )
+{}
+
+StartupWaterfallView::~StartupWaterfallView() = default;
+
+void StartupWaterfallView::setProfiles( const StartupProfile & profile, const StartupProfile & baseline )
+{
+	_profile = profile;
+	_baseline = baseline;
+
+	// The same file can be loaded in several phases or the steps can repeat within a phase,
+	// so pair the steps with the same name in the order they appear.
+	QHash< QString, QVector< int > > baselineIdxsByKey;
+	for (int stepIdx = 0; stepIdx < _baseline.steps.size(); ++stepIdx)
+	{
+		baselineIdxsByKey[ stepKey( _baseline.steps[ stepIdx ] ) ].append( stepIdx );
+	}
+	QHash< QString, int > pairedCounts;
+
+	_baselineStepIdxs.fill( -1, _profile.steps.size() );
+	for (int stepIdx = 0; stepIdx < _profile.steps.size(); ++stepIdx)
+	{
+		QString key = stepKey( _profile.steps[ stepIdx ] );
+		auto baselineIdxsIter = baselineIdxsByKey.find( key );
+		if (baselineIdxsIter != baselineIdxsByKey.end())
+		{
+			int & pairedCount = pairedCounts[ key ];
+			if (pairedCount < baselineIdxsIter->size())
+				_baselineStepIdxs[ stepIdx ] = (*baselineIdxsIter)[ pairedCount++ ];
+		}
+	}
+
+	updateGeometry();  // the number of rows has changed
+	update();
+}
+
+int StartupWaterfallView::rowHeight() const
+{
+	return fontMetrics().height() + 6;
+}
+
+QSize StartupWaterfallView::sizeHint() const
+{
+	return QSize( 640, 2 * margin + rowCount() * rowHeight() );
+}
+
+QSize StartupWaterfallView::minimumSizeHint() const
+{
+	// all the rows must fit, the scroll area around this widget takes care of the rest
+	return QSize( 320, 2 * margin + rowCount() * rowHeight() );
+}
+
+QString StartupWaterfallView::stepLabel( const StartupStep & step ) const
+{
+	return step.file.isEmpty() ? step.phase : fs::getFileNameFromPath( step.file );
+}
+
+bool StartupWaterfallView::event( QEvent * event )
+{
+	if (event->type() != QEvent::ToolTip)
+	{
+		return superClass::event( event );
+	}
+
+	// show the full file path and exact times of the step under the cursor
+	auto * helpEvent = static_cast< QHelpEvent * >( event );
+	int stepIdx = (helpEvent->pos().y() - margin) / rowHeight() - 1;  // the first row is the header
+	if (helpEvent->pos().y() < margin || stepIdx < 0 || stepIdx >= _profile.steps.size())
+	{
+		QToolTip::hideText();
+		event->ignore();
+		return true;
+	}
+
+	const StartupStep & step = _profile.steps[ stepIdx ];
+	QString toolTip = step.file.isEmpty() ? step.phase : QString( step.file % " (" % step.phase % ")" );
+	toolTip += "\nstarted at " % formatTime( step.start_ms ) % ", took " % formatTime( step.duration_ms );
+	if (_baselineStepIdxs[ stepIdx ] >= 0)
+	{
+		const StartupStep & baselineStep = _baseline.steps[ _baselineStepIdxs[ stepIdx ] ];
+		toolTip += "\ncompared run: started at " % formatTime( baselineStep.start_ms ) % ", took " % formatTime( baselineStep.duration_ms );
+	}
+	QToolTip::showText( helpEvent->globalPos(), toolTip, this );
+	return true;
+}
+
+void StartupWaterfallView::drawDuration( QPainter & painter, const QRect & rect, qint64 duration_ms )
+{
+	painter.setPen( palette().color( QPalette::Text ) );
+	painter.drawText( rect, Qt::AlignRight | Qt::AlignVCenter, formatTime( duration_ms ) );
+}
+
+void StartupWaterfallView::drawDelta( QPainter & painter, const QRect & rect, qint64 duration_ms, qint64 baseline_ms )
+{
+	const qint64 delta_ms = duration_ms - baseline_ms;
+
+	// highlight only differences that are unlikely to be a measurement noise
+	const qint64 threshold_ms = std::max( baseline_ms / 20, qint64(5) );
+	if (delta_ms > threshold_ms)
+		painter.setPen( slowerColor );
+	else if (delta_ms < -threshold_ms)
+		painter.setPen( fasterColor );
+	else
+		painter.setPen( palette().color( QPalette::Text ) );
+
+	painter.drawText( rect, Qt::AlignRight | Qt::AlignVCenter, (delta_ms > 0 ? QString("+") : QString()) % formatTime( delta_ms ) );
+}
+
+void StartupWaterfallView::paintEvent( QPaintEvent * )
+{
+	QPainter painter( this );
+
+	if (_profile.isEmpty())
+	{
+		painter.setPen( palette().color( QPalette::Text ) );
+		painter.drawText( rect(), Qt::AlignCenter, "No start-up profile to show." );
+		return;
+	}
+
+	const QFont normalFont = font();
+	QFont boldFont = font();
+	boldFont.setBold( true );
+	const QFontMetrics boldMetrics( boldFont );
+
+	const int rowH = rowHeight();
+	const bool hasBaseline = !_baseline.isEmpty();
+
+	// columns: label | bars | duration | difference against the baseline
+
+	int labelWidth = boldMetrics.boundingRect( "Phase / file" ).width();
+	for (const StartupStep & step : _profile.steps)
+	{
+		int indent = step.file.isEmpty() ? 0 : fileIndent;
+		labelWidth = std::max( labelWidth, indent + boldMetrics.boundingRect( stepLabel( step ) ).width() );
+	}
+	labelWidth = std::min( labelWidth, width() / 3 );
+
+	const int durationWidth = boldMetrics.boundingRect( "999999 ms" ).width();
+	const int deltaWidth = hasBaseline ? boldMetrics.boundingRect( "+999999 ms" ).width() : 0;
+
+	const int labelLeft = margin;
+	const int barLeft = labelLeft + labelWidth + columnSpacing;
+	const int durationLeft = width() - margin - durationWidth - (hasBaseline ? deltaWidth + columnSpacing : 0);
+	const int deltaLeft = durationLeft + durationWidth + columnSpacing;
+	const int barWidth = std::max( durationLeft - columnSpacing - barLeft, 1 );
+
+	const qint64 timeRange_ms = std::max( { _profile.duration_ms, _baseline.duration_ms, qint64(1) } );
+	auto timeToX = [&]( qint64 time_ms ) { return barLeft + int( time_ms * barWidth / timeRange_ms ); };
+
+	auto rowTop = [&]( int row ) { return margin + row * rowH; };
+	const int totalRow = rowCount() - 1;
+
+	// time axis
+
+	static const qint64 gridSteps_ms [] = { 10, 25, 50, 100, 250, 500, 1000, 2000, 5000, 10000, 30000, 60000 };
+	qint64 gridStep_ms = gridSteps_ms[ std::size(gridSteps_ms) - 1 ];
+	for (qint64 step_ms : gridSteps_ms)
+	{
+		if (step_ms * barWidth / timeRange_ms >= minGridSpacing)
+		{
+			gridStep_ms = step_ms;
+			break;
+		}
+	}
+
+	painter.setFont( normalFont );
+	for (qint64 time_ms = 0; time_ms <= timeRange_ms; time_ms += gridStep_ms)
+	{
+		const int x = timeToX( time_ms );
+		painter.setPen( palette().color( QPalette::Mid ) );
+		painter.drawLine( x, rowTop( 1 ), x, rowTop( totalRow + 1 ) );
+		painter.setPen( palette().color( QPalette::Text ) );
+		QString tickLabel = gridStep_ms < 1000 ? QString::number( double( time_ms ) / 1000.0, 'f', 2 ) : QString::number( time_ms / 1000 );
+		painter.drawText( x + 2, rowTop( 0 ), minGridSpacing, rowH, Qt::AlignLeft | Qt::AlignVCenter, tickLabel % " s" );
+	}
+
+	// header
+
+	painter.setFont( boldFont );
+	painter.setPen( palette().color( QPalette::Text ) );
+	painter.drawText( labelLeft, rowTop( 0 ), labelWidth, rowH, Qt::AlignLeft | Qt::AlignVCenter, "Phase / file" );
+	painter.drawText( durationLeft, rowTop( 0 ), durationWidth, rowH, Qt::AlignRight | Qt::AlignVCenter, "Duration" );
+	if (hasBaseline)
+		painter.drawText( deltaLeft, rowTop( 0 ), deltaWidth, rowH, Qt::AlignRight | Qt::AlignVCenter, "Change" );
+
+	// steps
+
+	const QColor phaseColor = palette().color( QPalette::Highlight );
+	QColor fileColor = phaseColor;
+	fileColor.setAlpha( 140 );
+	QColor baselineColor = palette().color( QPalette::Text );
+	baselineColor.setAlpha( 110 );
+
+	for (int stepIdx = 0; stepIdx < _profile.steps.size(); ++stepIdx)
+	{
+		const StartupStep & step = _profile.steps[ stepIdx ];
+		const bool isPhase = step.file.isEmpty();
+		const int top = rowTop( stepIdx + 1 );
+
+		if (stepIdx % 2 == 1)
+			painter.fillRect( margin, top, width() - 2 * margin, rowH, palette().color( QPalette::AlternateBase ) );
+
+		painter.setFont( isPhase ? boldFont : normalFont );
+		painter.setPen( palette().color( QPalette::Text ) );
+		const int indent = isPhase ? 0 : fileIndent;
+		const QString label = painter.fontMetrics().elidedText( stepLabel( step ), Qt::ElideMiddle, labelWidth - indent );
+		painter.drawText( labelLeft + indent, top, labelWidth - indent, rowH, Qt::AlignLeft | Qt::AlignVCenter, label );
+
+		const int barStart = timeToX( step.start_ms );
+		const int barEnd = timeToX( step.start_ms + step.duration_ms );
+		painter.fillRect( barStart, top + 3, std::max( barEnd - barStart, 1 ), rowH - 8, isPhase ? phaseColor : fileColor );
+
+		painter.setFont( normalFont );
+		drawDuration( painter, QRect( durationLeft, top, durationWidth, rowH ), step.duration_ms );
+
+		if (_baselineStepIdxs[ stepIdx ] >= 0)
+		{
+			// thin line under the bar shows where the step was in the compared run
+			const StartupStep & baselineStep = _baseline.steps[ _baselineStepIdxs[ stepIdx ] ];
+			const int baselineStart = timeToX( baselineStep.start_ms );
+			const int baselineEnd = timeToX( baselineStep.start_ms + baselineStep.duration_ms );
+			painter.fillRect( baselineStart, top + rowH - 4, std::max( baselineEnd - baselineStart, 1 ), 2, baselineColor );
+
+			drawDelta( painter, QRect( deltaLeft, top, deltaWidth, rowH ), step.duration_ms, baselineStep.duration_ms );
+		}
+	}
+
+	// total
+
+	const int totalTop = rowTop( totalRow );
+	painter.setPen( palette().color( QPalette::Mid ) );
+	painter.drawLine( margin, totalTop, width() - margin, totalTop );
+
+	painter.setFont( boldFont );
+	painter.setPen( palette().color( QPalette::Text ) );
+	painter.drawText( labelLeft, totalTop, labelWidth, rowH, Qt::AlignLeft | Qt::AlignVCenter, "Total" );
+	drawDuration( painter, QRect( durationLeft, totalTop, durationWidth, rowH ), _profile.duration_ms );
+	if (hasBaseline)
+		drawDelta( painter, QRect( deltaLeft, totalTop, deltaWidth, rowH ), _profile.duration_ms, _baseline.duration_ms );
+}
@@ -0,0 +1,68 @@
+//======================================================================================================================
+// Project: DoomRunner
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: waterfall chart of the engine start-up steps
+//======================================================================================================================
+
+#ifndef STARTUP_WATERFALL_VIEW_INCLUDED
+#define STARTUP_WATERFALL_VIEW_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "UserData.hpp"  // StartupProfile
+
+#include <QWidget>
+#include <QVector>
+
+class QPaintEvent;
+class QPainter;
+
+
+//======================================================================================================================
+/// Shows every step of the engine start-up as a horizontal bar placed on a common time axis.
+/** Optionally compares the steps with another run, the steps are paired by their phase and file names. */
+
+class StartupWaterfallView : public QWidget {
+
+	Q_OBJECT
+
+	using thisClass = StartupWaterfallView;
+	using superClass = QWidget;
+
+ public:
+
+	StartupWaterfallView( QWidget * parent );
+	virtual ~StartupWaterfallView() override;
+
+	/// Sets the profile to display and an optional profile to compare it with, empty profiles clear the view.
+	void setProfiles( const StartupProfile & profile, const StartupProfile & baseline = {} );
+
+	virtual QSize sizeHint() const override;
+	virtual QSize minimumSizeHint() const override;
+
+ protected: // overridden event callbacks
+
+	virtual bool event( QEvent * event ) override;
+	virtual void paintEvent( QPaintEvent * event ) override;
+
+ private: // methods
+
+	int rowHeight() const;
+	int rowCount() const  { return int( _profile.steps.size() ) + 2; }  ///< header + steps + total
+	QString stepLabel( const StartupStep & step ) const;
+
+	void drawDuration( QPainter & painter, const QRect & rect, qint64 duration_ms );
+	void drawDelta( QPainter & painter, const QRect & rect, qint64 duration_ms, qint64 baseline_ms );
+
+ private: // members
+
+	StartupProfile _profile;
+	StartupProfile _baseline;
+	QVector< int > _baselineStepIdxs;  ///< index of the matching baseline step for each step, -1 if there is none
+
+};
+
+
+#endif // STARTUP_WATERFALL_VIEW_INCLUDED
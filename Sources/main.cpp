@@ -7,7 +7,10 @@
 
 #include "MainWindow.hpp"
 #include "Themes.hpp"
+#include "SingleInstance.hpp"
 #include "Utils/StandardOutput.hpp"
+#include "Utils/Tracing.hpp"
+#include "Utils/ErrorHandling.hpp"
 
 #include <QApplication>
 #include <QDir>
@@ -19,17 +22,51 @@ int main( int argc, char * argv [] )
 {
 	QApplication a( argc, argv );
 
+	// This must be done before the working dir is changed, so that relative file paths are resolved correctly.
+	StartupArgs startupArgs = parseStartupArgs( QApplication::arguments() );
+
+	if (!startupArgs.logLevels.isEmpty())
+	{
+		QString error = setLogLevels( startupArgs.logLevels );
+		if (!error.isEmpty())
+			logRuntimeError("StartupArgs") << error;
+	}
+
 	// All stored relative paths are relative to the directory of this application,
 	// launching it from a different current working directory would break it.
 	QDir::setCurrent( QApplication::applicationDirPath() );
 
 	initStdStreams();
 
+	// If the application is already running, let it handle our arguments and exit,
+	// otherwise the two instances would overwrite each other's options.
+	SingleInstanceGuard instanceGuard;
+	if (!startupArgs.newInstance && instanceGuard.forwardToRunningInstance( startupArgs ))
+	{
+		closeLogFile();
+		return 0;
+	}
+
+	if (!startupArgs.traceFile.isEmpty())
+		tracing::setEnabled( true );
+
 	themes::init();
 
-	MainWindow w;
+	MainWindow w( startupArgs.profileStartup );
+	QObject::connect( &instanceGuard, &SingleInstanceGuard::argsReceived, &w, &MainWindow::executeStartupArgs );
+	instanceGuard.startListening();
+	w.executeStartupArgs( startupArgs );  // postponed until the options are loaded
 	w.show();
 	int exitCode = a.exec();
 
+	if (!startupArgs.traceFile.isEmpty())
+	{
+		QString error = tracing::exportChromeTrace( startupArgs.traceFile );
+		if (!error.isEmpty())
+			logRuntimeError("Tracing") << error;
+	}
+
+	closeLogFile();
+
 	return exitCode;
 }